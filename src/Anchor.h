@@ -0,0 +1,256 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "VectorMath.h"
+
+class AnchorTree;
+
+// A local frame that positions are stored relative to, so that they stay small no matter how far the world extends.
+// Anchors form a tree, where each anchor is placed relative to its parent by a fixed transform. The tree is kept
+// rooted at the origin, so an anchor's parent is always the next anchor on the way to it.
+class Anchor {
+public:
+	Anchor(const AnchorTree& tree, Anchor* parent, const Matrix4d& fromParent, const Matrix4d& toParent,
+			std::size_t index, std::uint64_t updatedAt):
+		tree(&tree), parent(parent), fromParent(fromParent), toParent(toParent), index(index),
+		relativeTransform(Matrix4d::Identity()), updatedAt(updatedAt) {}
+
+	Anchor* getParent() const {
+		return parent;
+	}
+
+	const std::vector<Anchor*>& getChildren() const {
+		return children;
+	}
+
+	// The anchors close enough that something near this one may be nearer to them, as linked by AnchorTree::link
+	const std::vector<Anchor*>& getNeighbors() const {
+		return neighbors;
+	}
+
+	// Where the anchor is relative to the origin anchor of its tree. It is composed along the tree from the origin,
+	// rather than through a distant common ancestor, so nearby anchors are precise. Only anchors that are used are
+	// brought up to date after the origin changes, when they are next used.
+	const Matrix4d& getRelativeTransform() const;
+
+	// Anything that stores positions relative to the anchor holds it for as long as it does, so that the tree does not
+	// prune the anchor
+	void hold() const {
+		++holders;
+	}
+
+	void release() const {
+		--holders;
+	}
+
+private:
+	friend class AnchorTree;
+
+	const AnchorTree* tree;
+	Anchor* parent;
+	Matrix4d fromParent; // Maps from this anchor's frame to its parent's
+	Matrix4d toParent; // The inverse of fromParent
+	std::vector<Anchor*> children;
+	std::vector<Anchor*> neighbors;
+	std::size_t index; // In the tree's anchors
+	bool pruned = false;
+	mutable Matrix4d relativeTransform;
+	mutable std::uint64_t updatedAt; // The tree's origin change count when the relative transform was computed
+	mutable std::size_t holders = 0;
+};
+
+// Owns every anchor and keeps their relative transforms up to date with the origin, which follows the camera.
+// Rendering composes each node with its anchor's relative transform and the camera's anchor-relative position, both of
+// which stay small near the camera. Changing the origin only re-roots the tree along the path between the two origins,
+// which is one edge when the new origin was just created next to the old one, so it costs the same however many anchors
+// there are. Anchors that nothing holds are pruned or merged away once the origin has left them behind.
+class AnchorTree {
+public:
+	AnchorTree() {
+		anchors.push_back(std::make_unique<Anchor>(*this, nullptr, Matrix4d::Identity(), Matrix4d::Identity(), 0, 0));
+		origin = anchors.back().get();
+	}
+
+	AnchorTree(const AnchorTree&) = delete;
+	AnchorTree& operator=(const AnchorTree&) = delete;
+
+	// The first anchor, which is never pruned
+	Anchor& getRoot() {
+		return *anchors.front();
+	}
+
+	Anchor& getOrigin() {
+		return *origin;
+	}
+
+	const std::vector<std::unique_ptr<Anchor>>& getAnchors() const {
+		return anchors;
+	}
+
+	// Adds an anchor placed relative to the parent. toParent must be the inverse of fromParent, which the caller
+	// computes since only it knows the geometry.
+	Anchor& createAnchor(Anchor& parent, const Matrix4d& fromParent, const Matrix4d& toParent) {
+		anchors.push_back(std::make_unique<Anchor>(*this, &parent, fromParent, toParent, anchors.size(), originChanges));
+		Anchor& anchor = *anchors.back();
+		parent.children.push_back(&anchor);
+		anchor.relativeTransform = parent.getRelativeTransform() * fromParent;
+		return anchor;
+	}
+
+	// Records that the anchors are close enough for their getNeighbors to list each other. Only the caller knows the
+	// geometry, so it decides which anchors are close enough.
+	void link(Anchor& anchor0, Anchor& anchor1) {
+		anchor0.neighbors.push_back(&anchor1);
+		anchor1.neighbors.push_back(&anchor0);
+	}
+
+	// Re-roots the tree at the new origin by reversing the parent links along the path from the previous origin, then
+	// prunes the anchors around the previous origin that nothing holds, once the new origin no longer neighbors them
+	void setOrigin(Anchor& newOrigin) {
+		if (&newOrigin == origin) {
+			return;
+		}
+
+		Anchor* previousOrigin = origin;
+		toPreviousOrigin = newOrigin.getRelativeTransform();
+
+		Anchor* child = &newOrigin;
+		Anchor* parent = child->parent;
+		Matrix4d childFromParent = child->fromParent;
+		Matrix4d childToParent = child->toParent;
+		child->parent = nullptr;
+		child->fromParent = Matrix4d::Identity();
+		child->toParent = Matrix4d::Identity();
+		while (parent != nullptr) {
+			Anchor* nextParent = parent->parent;
+			Matrix4d nextFromParent = parent->fromParent;
+			Matrix4d nextToParent = parent->toParent;
+
+			parent->parent = child;
+			parent->fromParent = childToParent;
+			parent->toParent = childFromParent;
+			parent->children.erase(std::find(parent->children.begin(), parent->children.end(), child));
+			child->children.push_back(parent);
+
+			child = parent;
+			parent = nextParent;
+			childFromParent = nextFromParent;
+			childToParent = nextToParent;
+		}
+
+		origin = &newOrigin;
+		++originChanges;
+		origin->relativeTransform = Matrix4d::Identity();
+		origin->updatedAt = originChanges;
+		fromPreviousOrigin = previousOrigin->getRelativeTransform();
+
+		pruneCandidates.assign(previousOrigin->neighbors.begin(), previousOrigin->neighbors.end());
+		pruneCandidates.push_back(previousOrigin);
+		// Anchors released after the origin left them are found by sweeping through the rest, one per change
+		pruneCandidates.push_back(anchors[originChanges % anchors.size()].get());
+		for (Anchor* candidate : pruneCandidates) {
+			prune(candidate);
+		}
+		prunedAnchors.clear();
+	}
+
+	// How many times the origin has changed. Every relative transform is in a new frame after each change.
+	std::uint64_t getOriginChanges() const {
+		return originChanges;
+	}
+
+	// Maps from the frame of the origin before the last change to the frame of the current one
+	const Matrix4d& getFromPreviousOrigin() const {
+		return fromPreviousOrigin;
+	}
+
+	// The inverse of getFromPreviousOrigin
+	const Matrix4d& getToPreviousOrigin() const {
+		return toPreviousOrigin;
+	}
+
+private:
+	friend class Anchor;
+
+	std::vector<std::unique_ptr<Anchor>> anchors;
+	Anchor* origin;
+	std::uint64_t originChanges = 0;
+	Matrix4d fromPreviousOrigin = Matrix4d::Identity();
+	Matrix4d toPreviousOrigin = Matrix4d::Identity();
+	std::vector<Anchor*> pruneCandidates; // Reused by setOrigin
+	std::vector<std::unique_ptr<Anchor>> prunedAnchors; // Kept until setOrigin is done with its candidates
+	mutable std::vector<const Anchor*> staleAnchors; // Reused by update
+
+	// Brings the anchor's relative transform up to date, along with those of its out-of-date ancestors. The origin is
+	// always up to date, so the walk ends there at the latest.
+	void update(const Anchor& anchor) const {
+		staleAnchors.clear();
+		for (const Anchor* stale = &anchor; stale->updatedAt != originChanges; stale = stale->parent) {
+			staleAnchors.push_back(stale);
+		}
+		for (auto it = staleAnchors.rbegin(); it != staleAnchors.rend(); ++it) {
+			const Anchor* stale = *it;
+			stale->relativeTransform = stale->parent->relativeTransform * stale->fromParent;
+			stale->updatedAt = originChanges;
+		}
+	}
+
+	// Removes the anchor if nothing holds it and it is not the root or next to the origin. If it has one child, the child
+	// is placed relative to the anchor's parent instead, which merges the chains of anchors the camera leaves behind
+	// into single edges. A removed leaf's parent may have been kept only for it, so it is tried next.
+	void prune(Anchor* anchor) {
+		while (anchor != nullptr && !anchor->pruned && anchor != anchors.front().get() && anchor != origin &&
+				anchor->holders == 0 && anchor->children.size() <= 1 &&
+				std::find(origin->neighbors.begin(), origin->neighbors.end(), anchor) == origin->neighbors.end()) {
+			Anchor* parent = anchor->parent;
+			auto position = std::find(parent->children.begin(), parent->children.end(), anchor);
+			if (anchor->children.empty()) {
+				parent->children.erase(position);
+			} else {
+				Anchor* child = anchor->children.front();
+				child->parent = parent;
+				child->fromParent = anchor->fromParent * child->fromParent;
+				child->toParent = child->toParent * anchor->toParent;
+				*position = child;
+			}
+			for (Anchor* neighbor : anchor->neighbors) {
+				neighbor->neighbors.erase(std::find(neighbor->neighbors.begin(), neighbor->neighbors.end(), anchor));
+			}
+
+			std::size_t index = anchor->index;
+			prunedAnchors.push_back(std::move(anchors[index]));
+			if (index != anchors.size() - 1) {
+				anchors[index] = std::move(anchors.back());
+				anchors[index]->index = index;
+			}
+			anchors.pop_back();
+			anchor->pruned = true;
+			anchor = parent->children.empty() ? parent : nullptr;
+		}
+	}
+};
+
+inline const Matrix4d& Anchor::getRelativeTransform() const {
+	if (updatedAt != tree->originChanges) {
+		tree->update(*this);
+	}
+	return relativeTransform;
+}
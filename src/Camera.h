@@ -13,12 +13,16 @@
 	See the License for the specific language governing permissions and
 	limitations under the License.
  */
-
 #pragma once
+#include "VectorMath.h"
 
-class RenderContext;
+class Anchor;
 
-class RenderNode {
+class Camera {
 public:
-	virtual void render(RenderContext& context) = 0;
+	// The camera's position and its view transform are both relative to its anchor
+	virtual Anchor& getAnchor() = 0;
+	virtual Matrix4d getPos() = 0;
+	virtual Matrix4d getCameraTransform() = 0;
+	virtual double getCameraZoom() = 0;
 };
@@ -0,0 +1,173 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "VectorMath.h"
+#include "SpinIsometry.h"
+#include "Entity.h"
+#include "Camera.h"
+
+// A smooth path through keyframe isometries spaced evenly in time. Each segment between keyframes is a cubic Bezier curve
+// evaluated with De Casteljau's algorithm, with geodesics in the isometry group in place of straight lines, so every
+// point on the path is exactly an isometry. The control points are placed as in a Catmull-Rom spline, so the camera's
+// velocity is continuous at keyframes. Evaluation takes constant time.
+class CameraPath {
+public:
+	// Requires at least two keyframes
+	CameraPath(const std::vector<SpinIsometry>& keyframes, double keyframeInterval): keyframeInterval(keyframeInterval) {
+		if (keyframes.size() < 2) {
+			throw std::runtime_error("A camera path needs at least two keyframes");
+		}
+
+		// Velocity in each keyframe's own frame: the average of the geodesics to its neighbors, with the end keyframes
+		// treated as repeated
+		std::size_t n = keyframes.size();
+		std::vector<SpinIsometry::Matrix2cd> steps, tangents;
+		for (std::size_t i = 0; i + 1 < n; ++i) {
+			steps.push_back((keyframes[i].inverse() * keyframes[i + 1]).log());
+		}
+		for (std::size_t i = 0; i < n; ++i) {
+			SpinIsometry::Matrix2cd incoming = i == 0 ? SpinIsometry::Matrix2cd::Zero() : steps[i - 1];
+			SpinIsometry::Matrix2cd outgoing = i == n - 1 ? SpinIsometry::Matrix2cd::Zero() : steps[i];
+			tangents.push_back(0.5 * (incoming + outgoing));
+		}
+
+		for (std::size_t i = 0; i + 1 < n; ++i) {
+			Segment segment;
+			segment.controlPoints[0] = keyframes[i];
+			segment.controlPoints[1] = keyframes[i] * SpinIsometry::exp(tangents[i] / 3.0);
+			segment.controlPoints[2] = keyframes[i + 1] * SpinIsometry::exp(tangents[i + 1] / -3.0);
+			segment.controlPoints[3] = keyframes[i + 1];
+
+			// The first level of De Casteljau's algorithm always interpolates between the same points
+			for (int j = 0; j < 3; ++j) {
+				segment.firstLevelSteps[j] = (segment.controlPoints[j].inverse() * segment.controlPoints[j + 1]).log();
+			}
+			segments.push_back(segment);
+		}
+	}
+
+	double getDuration() const {
+		return keyframeInterval * segments.size();
+	}
+
+	// Times outside of the path are clamped to its ends
+	SpinIsometry evaluate(double time) const {
+		double position = std::max(0.0, std::min(time / keyframeInterval, static_cast<double>(segments.size())));
+		std::size_t index = std::min(static_cast<std::size_t>(position), segments.size() - 1);
+		double t = position - index;
+		const Segment& segment = segments[index];
+
+		std::array<SpinIsometry, 3> level;
+		for (int j = 0; j < 3; ++j) {
+			level[j] = segment.controlPoints[j] * SpinIsometry::exp(t * segment.firstLevelSteps[j]);
+		}
+		for (int size = 2; size >= 1; --size) {
+			for (int j = 0; j < size; ++j) {
+				level[j] = SpinIsometry::interpolate(level[j], level[j + 1], t);
+			}
+		}
+		return level[0];
+	}
+
+	Matrix4d getTransform(double time) const {
+		return evaluate(time).toMatrix4d();
+	}
+
+private:
+	class Segment {
+	public:
+		std::array<SpinIsometry, 4> controlPoints;
+		std::array<SpinIsometry::Matrix2cd, 3> firstLevelSteps;
+	};
+
+	double keyframeInterval;
+	std::vector<Segment> segments;
+};
+
+// A camera path evaluated ahead of time at a fixed interval, so that playing it back is only a table lookup. Meant for
+// timing runs, where evaluating the path would add to the measured time.
+class SampledCameraPath {
+public:
+	SampledCameraPath(const CameraPath& path, double sampleInterval): sampleInterval(sampleInterval) {
+		std::size_t count = static_cast<std::size_t>(std::ceil(path.getDuration() / sampleInterval)) + 1;
+		for (std::size_t i = 0; i < count; ++i) {
+			samples.push_back(path.getTransform(std::min(i * sampleInterval, path.getDuration())));
+		}
+	}
+
+	double getDuration() const {
+		return sampleInterval * (samples.size() - 1);
+	}
+
+	// The latest sample at or before the given time, clamped to the ends of the path
+	Matrix4d getTransform(double time) const {
+		double position = std::max(0.0, time / sampleInterval + 1e-9);
+		return samples[std::min(static_cast<std::size_t>(position), samples.size() - 1)];
+	}
+
+private:
+	double sampleInterval;
+	std::vector<Matrix4d> samples;
+};
+
+// A camera that follows a CameraPath or SampledCameraPath as the scene steps. The path is relative to the anchor.
+template<typename Path>
+class PathCamera : public Entity, public Camera {
+public:
+	PathCamera(Anchor& anchor, const Path& path): anchor(&anchor), path(&path), pos(path.getTransform(0)) {}
+
+	void step(double dt, const UserInput& userInput) override {
+		setTime(time + dt);
+	}
+
+	void setTime(double time) {
+		this->time = time;
+		pos = path->getTransform(time);
+	}
+
+	bool isFinished() const {
+		return time >= path->getDuration();
+	}
+
+	Anchor& getAnchor() override {
+		return *anchor;
+	}
+
+	Matrix4d getPos() override {
+		return pos;
+	}
+
+	Matrix4d getCameraTransform() override {
+		return VectorMath::hyperbolicTranspose(pos);
+	}
+
+	double getCameraZoom() override {
+		return 1;
+	}
+
+private:
+	Anchor* anchor;
+	const Path* path;
+	double time = 0;
+	Matrix4d pos;
+};
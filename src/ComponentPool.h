@@ -0,0 +1,100 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "SlotMap.h"
+
+// Components that only some elements of a SlotMap have, such as the motion of the render nodes that move. They are
+// packed densely, so a system iterates them without skipping over the elements that lack one, and looked up by their
+// owner's handle in constant time.
+template<typename T>
+class ComponentPool {
+public:
+	// Replaces the component if the owner already has one
+	T& set(SlotHandle owner, const T& component) {
+		if (contains(owner)) {
+			return components[denseIndices[owner.index]] = component;
+		}
+
+		if (owner.index >= denseIndices.size()) {
+			// Copied first, since resize takes it by reference and nullIndex has no definition outside of the class
+			std::uint32_t none = SlotHandle::nullIndex;
+			denseIndices.resize(owner.index + 1, none);
+		}
+		denseIndices[owner.index] = static_cast<std::uint32_t>(components.size());
+		components.push_back(component);
+		owners.push_back(owner);
+		return components.back();
+	}
+
+	bool contains(SlotHandle owner) const {
+		return owner.index < denseIndices.size() && denseIndices[owner.index] != SlotHandle::nullIndex
+			&& owners[denseIndices[owner.index]] == owner;
+	}
+
+	// Throws std::runtime_error if the owner has no component
+	T& get(SlotHandle owner) {
+		if (!contains(owner)) {
+			throw std::runtime_error("Tried to get a component that was never set");
+		}
+		return components[denseIndices[owner.index]];
+	}
+
+	// Does nothing if the owner has no component. Like SlotMap, this moves the last component into the gap.
+	void remove(SlotHandle owner) {
+		if (!contains(owner)) {
+			return;
+		}
+
+		std::uint32_t denseIndex = denseIndices[owner.index];
+		denseIndices[owners.back().index] = denseIndex;
+		components[denseIndex] = components.back();
+		owners[denseIndex] = owners.back();
+		components.pop_back();
+		owners.pop_back();
+		denseIndices[owner.index] = SlotHandle::nullIndex;
+	}
+
+	std::size_t getSize() const {
+		return components.size();
+	}
+
+	SlotHandle getOwner(std::size_t denseIndex) const {
+		return owners[denseIndex];
+	}
+
+	T& operator[](std::size_t denseIndex) {
+		return components[denseIndex];
+	}
+
+	const T& operator[](std::size_t denseIndex) const {
+		return components[denseIndex];
+	}
+
+	void reserve(std::size_t size) {
+		components.reserve(size);
+		owners.reserve(size);
+	}
+
+private:
+	std::vector<T> components;
+	std::vector<SlotHandle> owners; // In the same order as the components
+	std::vector<std::uint32_t> denseIndices; // By the owner's slot index, or nullIndex for none
+};
@@ -0,0 +1,84 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "VectorMath.h"
+#include "RenderSnapshot.h"
+
+// The draws of a snapshot that can be in view, in the order to submit them. Nodes are culled by their bounding balls
+// against the sides of the view frustum, and the rest are sorted by model and texture so that each is bound as few
+// times as possible.
+class DrawList {
+public:
+	// Space is a GeometryPolicy, such as HyperbolicGeometry. The width and height are those of the frustum one unit in
+	// front of the camera, as passed to VectorMath::perspective.
+	template<typename Space>
+	void build(const RenderSnapshot& snapshot, double width, double height) {
+		indices.clear();
+
+		// The outward normals of the frustum's four sides, which all pass through the camera. A ball is outside a side
+		// when its center is further than its radius beyond it, and the sine of that distance is the center's dot
+		// product with the normal.
+		std::array<Vector3d, 4> normals {
+			Vector3d(2 / width, 0, 1).normalized(),
+			Vector3d(-2 / width, 0, 1).normalized(),
+			Vector3d(0, 2 / height, 1).normalized(),
+			Vector3d(0, -2 / height, 1).normalized(),
+		};
+
+		for (std::size_t i = 0; i < snapshot.nodes.size(); ++i) {
+			const RenderSnapshotNode& node = snapshot.nodes[i];
+			Vector3d center = (snapshot.view * node.transform.col(3)).head<3>();
+			double sineRadius = Space::sine(std::min(node.boundingRadius, maxRadius<Space>()));
+			if (center.dot(normals[0]) <= sineRadius && center.dot(normals[1]) <= sineRadius
+					&& center.dot(normals[2]) <= sineRadius && center.dot(normals[3]) <= sineRadius) {
+				indices.push_back(static_cast<std::uint32_t>(i));
+			}
+		}
+		culledCount = snapshot.nodes.size() - indices.size();
+
+		// Stable, so nodes with the same model and texture keep the snapshot's order
+		std::stable_sort(indices.begin(), indices.end(), [&snapshot](std::uint32_t a, std::uint32_t b) {
+			const RenderSnapshotNode& nodeA = snapshot.nodes[a];
+			const RenderSnapshotNode& nodeB = snapshot.nodes[b];
+			return nodeA.model != nodeB.model ? nodeA.model < nodeB.model : nodeA.texture < nodeB.texture;
+		});
+	}
+
+	// Indices into the snapshot's nodes
+	const std::vector<std::uint32_t>& getIndices() const {
+		return indices;
+	}
+
+	std::size_t getCulledCount() const {
+		return culledCount;
+	}
+
+private:
+	std::vector<std::uint32_t> indices;
+	std::size_t culledCount = 0;
+
+	// In spherical geometry, a ball with a radius of a quarter turn or more is a whole hemisphere, which no side can cull
+	template<typename Space>
+	static double maxRadius() {
+		return Space::curvature < 0 ? INFINITY : M_TAU / 4;
+	}
+};
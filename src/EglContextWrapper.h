@@ -0,0 +1,103 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+
+#include "glad.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <stdexcept>
+
+// An offscreen GL context made through EGL, in place of ContextWrapper and WindowWrapper's window. It has no default
+// framebuffer, so everything is drawn into an OffscreenFramebuffer.
+class EglContextWrapper {
+public:
+	EglContextWrapper() {
+		display = getDisplay();
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+			throw std::runtime_error("Failed to initialize EGL");
+		}
+
+		if (!eglBindAPI(EGL_OPENGL_API)) {
+			eglTerminate(display);
+			throw std::runtime_error("EGL does not support desktop OpenGL");
+		}
+
+		// A pbuffer is only a fallback for drivers that cannot make a context current without a surface
+		EGLint configAttributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_NONE};
+		EGLConfig config = nullptr;
+		EGLint numConfigs = 0;
+		eglChooseConfig(display, configAttributes, &config, 1, &numConfigs);
+
+		EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 3,
+			EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		context = eglCreateContext(display, numConfigs > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+		if (context == EGL_NO_CONTEXT) {
+			eglTerminate(display);
+			throw std::runtime_error("Failed to create an EGL context");
+		}
+
+		if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) && numConfigs > 0) {
+			EGLint surfaceAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+			surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+			eglMakeCurrent(display, surface, surface, context);
+		}
+
+		if (eglGetCurrentContext() != context || !gladLoadGLLoader((GLADloadproc) eglGetProcAddress)) {
+			destroy();
+			throw std::runtime_error("Failed to make the EGL context current");
+		}
+	}
+
+	~EglContextWrapper() {
+		destroy();
+	}
+
+	EglContextWrapper(const EglContextWrapper&) = delete;
+	EglContextWrapper& operator=(const EglContextWrapper&) = delete;
+
+private:
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+	EGLSurface surface = EGL_NO_SURFACE;
+
+	// Mesa's surfaceless platform needs neither a display server nor a GPU. Other drivers use their default display.
+	static EGLDisplay getDisplay() {
+		const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+		auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+		if (clientExtensions && getPlatformDisplay && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+			EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+			if (display != EGL_NO_DISPLAY) {
+				return display;
+			}
+		}
+		return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	void destroy() {
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (surface != EGL_NO_SURFACE) {
+			eglDestroySurface(display, surface);
+		}
+		eglDestroyContext(display, context);
+		eglTerminate(display);
+	}
+};
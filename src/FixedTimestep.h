@@ -0,0 +1,77 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// How a FixedTimestep has kept up with real time
+class TimestepStatistics {
+public:
+	std::uint64_t updates = 0;
+	std::uint64_t ticks = 0;
+	int maxTicksPerUpdate = 0;
+	std::uint64_t cappedUpdates = 0; // Updates that hit the cap and dropped time
+	double droppedSeconds = 0; // Real time the simulation gave up on, so simulated time is behind by this much
+	double lag = 0; // Real time accumulated toward the next tick after the last update
+};
+
+// Turns elapsed real time into a whole number of ticks of a fixed length, carrying the remainder over to the next update,
+// so that the simulation's results do not depend on how often it is updated. If the simulation falls behind by more
+// than maxTicksPerUpdate ticks, the excess is dropped rather than caught up, so that a slow tick cannot snowball into
+// ever longer updates.
+class FixedTimestep {
+public:
+	FixedTimestep(double tickInterval, int maxTicksPerUpdate): tickInterval(tickInterval), maxTicksPerUpdate(maxTicksPerUpdate) {}
+
+	// Adds the real time elapsed since the last update and returns how many ticks to run now
+	int advance(double elapsedSeconds) {
+		statistics.lag += elapsedSeconds;
+		int ticks = static_cast<int>(std::floor(statistics.lag / tickInterval));
+		if (ticks > maxTicksPerUpdate) {
+			double kept = (maxTicksPerUpdate + std::fmod(statistics.lag, tickInterval) / tickInterval) * tickInterval;
+			statistics.droppedSeconds += statistics.lag - kept;
+			statistics.lag = kept;
+			++statistics.cappedUpdates;
+			ticks = maxTicksPerUpdate;
+		}
+		statistics.lag = std::max(statistics.lag - ticks * tickInterval, 0.0);
+
+		++statistics.updates;
+		statistics.ticks += ticks;
+		statistics.maxTicksPerUpdate = std::max(statistics.maxTicksPerUpdate, ticks);
+		return ticks;
+	}
+
+	// Real time until the next tick is due
+	double getTimeToNextTick() const {
+		return std::max(tickInterval - statistics.lag, 0.0);
+	}
+
+	double getTickInterval() const {
+		return tickInterval;
+	}
+
+	const TimestepStatistics& getStatistics() const {
+		return statistics;
+	}
+
+private:
+	double tickInterval;
+	int maxTicksPerUpdate;
+	TimestepStatistics statistics;
+};
@@ -18,14 +18,15 @@
 #include "VectorMath.h"
 #include "UserInput.h"
 #include "Entity.h"
+#include "Camera.h"
+#include "Anchor.h"
 
-class GhostCamera : public Entity {
+// Space is a GeometryPolicy, such as HyperbolicGeometry
+template<typename Space>
+class GhostCamera : public Entity, public Camera {
 public:
-	GhostCamera(): pos(Matrix4d::Identity()), vel(0, 0, 0, 0), zoom(1), rotationLock(false), slow(false), spherical(false) {
-	}
-
-	void setSpherical(bool spherical) {
-		this->spherical = spherical;
+	GhostCamera(AnchorTree& anchors):
+		anchors(&anchors), anchor(&anchors.getOrigin()), pos(Matrix4d::Identity()), vel(0, 0, 0, 0), zoom(1), rotationLock(false), slow(false) {
 	}
 
 	void step(double dt, const UserInput& userInput) override {
@@ -35,61 +36,55 @@ public:
 		setPositionFromVelocity(dt);
 		setPositionFromInput(dt, userInput);
 		renormalize();
+		reanchor();
 	}
 
-	Matrix4d getPos() {
+	Anchor& getAnchor() override {
+		return *anchor;
+	}
+
+	Matrix4d getPos() override {
 		return pos;
 	}
 
-	Matrix4d getCameraTransform() {
-		return spherical ? pos.adjoint() : VectorMath::hyperbolicTranspose(pos);
+	Matrix4d getCameraTransform() override {
+		return Space::transpose(pos);
 	}
 
-	double getCameraZoom() {
+	double getCameraZoom() override {
 		return zoom;
 	}
 
 private:
-	Matrix4d pos;
+	// Past this distance from its anchor, the camera moves to a closer anchor or creates one where it is
+	static constexpr double maxAnchorDistance = 1.0;
+
+	// When the camera rebases, it is only just past maxAnchorDistance from its anchor, so every anchor within
+	// maxAnchorDistance of it is within this distance of the anchor. Anchors this close are linked as neighbors.
+	static constexpr double neighborDistance = 3 * maxAnchorDistance;
+
+	AnchorTree* anchors;
+	Anchor* anchor;
+	Matrix4d pos; // Relative to the anchor
 	Vector4d vel; //Relative to camera
 	double zoom;
 	bool rotationLock;
 	bool slow;
-	bool spherical;
-
-	class Inputs {
-	public:
-		InputHandle forwards = MouseButton(GLFW_MOUSE_BUTTON_1);
-		InputHandle backwards = MouseButton(GLFW_MOUSE_BUTTON_2);
-		InputHandle left = KeyboardButton(GLFW_KEY_A);
-		InputHandle right = KeyboardButton(GLFW_KEY_D);
-		InputHandle up = KeyboardButton(GLFW_KEY_W);
-		InputHandle down = KeyboardButton(GLFW_KEY_S);
-		InputHandle clockwise = KeyboardButton(GLFW_KEY_E);
-		InputHandle counterclockwise = KeyboardButton(GLFW_KEY_Q);
-
-		InputHandle toggleSpeed = KeyboardButton(GLFW_KEY_LEFT_SHIFT);
-
-		InputHandle rotationLock = KeyboardButton(GLFW_KEY_LEFT_CONTROL);
-		InputHandle goHome = KeyboardButton(GLFW_KEY_HOME);
-	};
-
-	Inputs inputs;
 
 	void setSwitchesFromInput(double dt, const UserInput& userInput) {
-		if (userInput.pressedThisStep(inputs.rotationLock)) {
+		if (userInput.pressedThisStep(InputAction::TOGGLE_ROTATION_LOCK)) {
 			rotationLock = !rotationLock;
 		}
 
-		if (userInput.pressedThisStep(inputs.toggleSpeed)) {
+		if (userInput.pressedThisStep(InputAction::TOGGLE_SPEED)) {
 			slow = !slow;
 		}
 
-		if (userInput.isPressed(KeyboardButton(GLFW_KEY_O))) {
+		if (userInput.isPressed(InputAction::ZOOM_IN)) {
 			zoom *= std::pow(0.1, dt);
 		}
 
-		if (userInput.isPressed(KeyboardButton(GLFW_KEY_P))) {
+		if (userInput.isPressed(InputAction::ZOOM_OUT)) {
 			zoom *= std::pow(0.1, -dt);
 		}
 	}
@@ -101,10 +96,10 @@ private:
 		rotation *= VectorMath::rotation(Vector3d(0, 1, 0), -mouseLook(0) * 0.002 * zoom);
 
 		double zRotation = 0;
-		if (userInput.isPressed(inputs.clockwise)) {
+		if (userInput.isPressed(InputAction::ROLL_CLOCKWISE)) {
 			zRotation -= 1;
 		}
-		if (userInput.isPressed(inputs.counterclockwise)) {
+		if (userInput.isPressed(InputAction::ROLL_COUNTERCLOCKWISE)) {
 			zRotation += 1;
 		}
 		rotation *= VectorMath::rotation(Vector3d(0, 0, 1), zRotation * dt);
@@ -115,22 +110,22 @@ private:
 
 	void setVelocityFromInput(double dt, const UserInput& userInput) {
 		Vector4d goalVel(0, 0, 0, 0);
-		if (userInput.isPressed(inputs.forwards)) {
+		if (userInput.isPressed(InputAction::MOVE_FORWARDS)) {
 			goalVel(2) -= 1;
 		}
-		if (userInput.isPressed(inputs.backwards)) {
+		if (userInput.isPressed(InputAction::MOVE_BACKWARDS)) {
 			goalVel(2) += 1;
 		}
-		if (userInput.isPressed(inputs.left)) {
+		if (userInput.isPressed(InputAction::MOVE_LEFT)) {
 			goalVel(0) -= 1;
 		}
-		if (userInput.isPressed(inputs.right)) {
+		if (userInput.isPressed(InputAction::MOVE_RIGHT)) {
 			goalVel(0) += 1;
 		}
-		if (userInput.isPressed(inputs.down)) {
+		if (userInput.isPressed(InputAction::MOVE_DOWN)) {
 			goalVel(1) -= 1;
 		}
-		if (userInput.isPressed(inputs.up)) {
+		if (userInput.isPressed(InputAction::MOVE_UP)) {
 			goalVel(1) += 1;
 		}
 
@@ -151,26 +146,63 @@ private:
 	}
 
 	void setPositionFromVelocity(double dt) {
-		if (spherical) {
-			pos *= VectorMath::sphericalDisplacement(vel * dt);
+		// Horospheres only exist in hyperbolic geometry, so the rotation lock does nothing elsewhere
+		if (Space::curvature < 0 && rotationLock) {
+			pos *= Space::displacement(Vector4d(0, 0, vel(2), 0) * dt);
+			pos *= VectorMath::horoRotation(vel(0) * dt, vel(1) * dt);
 		} else {
-			if (rotationLock) {
-				pos *= VectorMath::hyperbolicDisplacement(Vector4d(0, 0, vel(2), 0) * dt);
-				pos *= VectorMath::horoRotation(vel(0) * dt, vel(1) * dt);
-			} else {
-				pos *= VectorMath::hyperbolicDisplacement(vel * dt);
-			}
+			pos *= Space::displacement(vel * dt);
 		}
 	}
 
 	void setPositionFromInput(double dt, const UserInput& userInput) {
-		if (userInput.isPressed(inputs.goHome)) {
-			Matrix4d notNormalized = pos + Matrix4d::Identity() * dt;
-			pos = spherical ? VectorMath::sphericalSvdUnitary(notNormalized) : VectorMath::hyperbolicSvdUnitary(notNormalized);
+		if (userInput.isPressed(InputAction::GO_HOME)) {
+			// Home is the root anchor's origin, so this step happens relative to the root
+			const Matrix4d& rootTransform = anchors->getRoot().getRelativeTransform();
+			Matrix4d notNormalized = Space::transpose(rootTransform) * pos + Matrix4d::Identity() * dt;
+			pos = rootTransform * Space::svdUnitary(notNormalized);
 		}
 	}
 
 	void renormalize() {
-		pos = spherical ? VectorMath::sphericalQrUnitary(pos) : VectorMath::hyperbolicQrUnitary(pos);
+		pos = Space::correctDrift(pos);
+	}
+
+	// Keeps pos small by rebasing it onto whichever neighboring anchor is closest, which needs a new anchor once the
+	// camera has left all of them behind. Only the anchor's neighbors are searched, so rebasing costs the same however
+	// far the camera has travelled. Spherical space is bounded, so it never needs more than the root anchor.
+	void reanchor() {
+		if (Space::curvature > 0 || pos(3, 3) <= cosh(maxAnchorDistance)) {
+			return;
+		}
+
+		Anchor* closest = anchor;
+		Matrix4d closestPos = pos;
+		for (Anchor* candidate : anchor->getNeighbors()) {
+			// The relative transforms are relative to the current anchor, which is the tree's origin
+			Matrix4d candidatePos = Space::transpose(candidate->getRelativeTransform()) * pos;
+			if (candidatePos(3, 3) < closestPos(3, 3)) {
+				closest = candidate;
+				closestPos = candidatePos;
+			}
+		}
+
+		if (closestPos(3, 3) <= cosh(maxAnchorDistance)) {
+			anchor = closest;
+			pos = Space::correctDrift(closestPos);
+		} else {
+			// Anything within neighborDistance of the new anchor is close to the current one, so its neighbors are
+			// found among the current anchor's. An anchor missed this way only means a few more anchors get created.
+			Anchor& created = anchors->createAnchor(*anchor, pos, Space::transpose(pos));
+			for (Anchor* candidate : anchor->getNeighbors()) {
+				if ((Space::transpose(candidate->getRelativeTransform()) * pos)(3, 3) <= cosh(neighborDistance)) {
+					anchors->link(*candidate, created);
+				}
+			}
+			anchors->link(*anchor, created);
+			anchor = &created;
+			pos = Matrix4d::Identity();
+		}
+		anchors->setOrigin(*anchor);
 	}
 };
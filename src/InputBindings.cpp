@@ -0,0 +1,255 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cerrno>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include "InputBindings.h"
+
+namespace {
+	const char* const actionNames[] = {
+		"move_forwards", "move_backwards", "move_left", "move_right", "move_up", "move_down", "roll_clockwise",
+		"roll_counterclockwise", "toggle_speed", "toggle_rotation_lock", "go_home", "zoom_in", "zoom_out",
+		"spawn_dodecahedron", "spawn_horosphere", "spawn_plane", "spawn_prism", "spawn_tree", "spawn_ball", "spawn_grid",
+		"spawn_tessellation", "despawn_all",
+	};
+	static_assert(sizeof(actionNames) / sizeof(actionNames[0]) == InputBindings::actionCount,
+		"Every input action needs a name");
+
+	int key(int code) {
+		return InputState::getKeyBit(code);
+	}
+
+	int mouseButton(int code) {
+		return InputState::getMouseButtonBit(code);
+	}
+
+	// GLFW's names for its key and mouse button codes, without the GLFW_ prefix
+	std::vector<std::pair<std::string, int>> makeInputNames() {
+		std::vector<std::pair<std::string, int>> names {
+			{"KEY_SPACE", key(32)}, {"KEY_APOSTROPHE", key(39)}, {"KEY_COMMA", key(44)}, {"KEY_MINUS", key(45)},
+			{"KEY_PERIOD", key(46)}, {"KEY_SLASH", key(47)}, {"KEY_SEMICOLON", key(59)}, {"KEY_EQUAL", key(61)},
+			{"KEY_LEFT_BRACKET", key(91)}, {"KEY_BACKSLASH", key(92)}, {"KEY_RIGHT_BRACKET", key(93)},
+			{"KEY_GRAVE_ACCENT", key(96)}, {"KEY_ESCAPE", key(256)}, {"KEY_ENTER", key(257)}, {"KEY_TAB", key(258)},
+			{"KEY_BACKSPACE", key(259)}, {"KEY_INSERT", key(260)}, {"KEY_DELETE", key(261)}, {"KEY_RIGHT", key(262)},
+			{"KEY_LEFT", key(263)}, {"KEY_DOWN", key(264)}, {"KEY_UP", key(265)}, {"KEY_PAGE_UP", key(266)},
+			{"KEY_PAGE_DOWN", key(267)}, {"KEY_HOME", key(268)}, {"KEY_END", key(269)}, {"KEY_CAPS_LOCK", key(280)},
+			{"KEY_LEFT_SHIFT", key(340)}, {"KEY_LEFT_CONTROL", key(341)}, {"KEY_LEFT_ALT", key(342)},
+			{"KEY_RIGHT_SHIFT", key(344)}, {"KEY_RIGHT_CONTROL", key(345)}, {"KEY_RIGHT_ALT", key(346)},
+		};
+		for (int i = 0; i < 10; ++i) {
+			names.emplace_back("KEY_" + std::to_string(i), key(InputCode::KEY_0 + i));
+			names.emplace_back("KEY_KP_" + std::to_string(i), key(320 + i));
+		}
+		for (char letter = 'A'; letter <= 'Z'; ++letter) {
+			names.emplace_back(std::string("KEY_") + letter, key(letter));
+		}
+		for (int i = 1; i <= 25; ++i) {
+			names.emplace_back("KEY_F" + std::to_string(i), key(289 + i));
+		}
+		for (int i = 1; i <= InputCode::MOUSE_BUTTON_LAST + 1; ++i) {
+			names.emplace_back("MOUSE_BUTTON_" + std::to_string(i), mouseButton(InputCode::MOUSE_BUTTON_1 + i - 1));
+		}
+		return names;
+	}
+
+	const std::vector<std::pair<std::string, int>>& getInputNames() {
+		static const std::vector<std::pair<std::string, int>> inputNames = makeInputNames();
+		return inputNames;
+	}
+
+	std::string trim(const std::string& text) {
+		std::size_t begin = text.find_first_not_of(" \t\r");
+		if (begin == std::string::npos) {
+			return "";
+		}
+		return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+	}
+}
+
+InputBindings::InputBindings() {
+	int unbound = InputState::nullBit;
+	for (ActionBits& bits : table) {
+		bits.fill(unbound);
+	}
+
+	bind(InputAction::MOVE_FORWARDS, {mouseButton(InputCode::MOUSE_BUTTON_1)});
+	bind(InputAction::MOVE_BACKWARDS, {mouseButton(InputCode::MOUSE_BUTTON_2)});
+	bind(InputAction::MOVE_LEFT, {key(InputCode::KEY_A)});
+	bind(InputAction::MOVE_RIGHT, {key(InputCode::KEY_D)});
+	bind(InputAction::MOVE_UP, {key(InputCode::KEY_W)});
+	bind(InputAction::MOVE_DOWN, {key(InputCode::KEY_S)});
+	bind(InputAction::ROLL_CLOCKWISE, {key(InputCode::KEY_E)});
+	bind(InputAction::ROLL_COUNTERCLOCKWISE, {key(InputCode::KEY_Q)});
+	bind(InputAction::TOGGLE_SPEED, {key(InputCode::KEY_LEFT_SHIFT)});
+	bind(InputAction::TOGGLE_ROTATION_LOCK, {key(InputCode::KEY_LEFT_CONTROL)});
+	bind(InputAction::GO_HOME, {key(InputCode::KEY_HOME)});
+	bind(InputAction::ZOOM_IN, {key(InputCode::KEY_O)});
+	bind(InputAction::ZOOM_OUT, {key(InputCode::KEY_P)});
+
+	bind(InputAction::SPAWN_DODECAHEDRON, {key(InputCode::KEY_1)});
+	bind(InputAction::SPAWN_HOROSPHERE, {key(InputCode::KEY_2)});
+	bind(InputAction::SPAWN_PLANE, {key(InputCode::KEY_3)});
+	bind(InputAction::SPAWN_PRISM, {key(InputCode::KEY_4)});
+	bind(InputAction::SPAWN_TREE, {key(InputCode::KEY_5)});
+	bind(InputAction::SPAWN_BALL, {key(InputCode::KEY_6)});
+	bind(InputAction::SPAWN_GRID, {key(InputCode::KEY_7)});
+	bind(InputAction::SPAWN_TESSELLATION, {key(InputCode::KEY_8)});
+	bind(InputAction::DESPAWN_ALL, {key(InputCode::KEY_0)});
+}
+
+InputBindings InputBindings::parse(const std::string& text, const std::string& sourceName) {
+	InputBindings bindings;
+	bool listed[actionCount] = {};
+	std::istringstream lines(text);
+	std::string line;
+	for (int lineNumber = 1; std::getline(lines, line); ++lineNumber) {
+		std::string location = sourceName + ":" + std::to_string(lineNumber) + ": ";
+		line = trim(line.substr(0, line.find('#')));
+		if (line.empty()) {
+			continue;
+		}
+
+		std::size_t equals = line.find('=');
+		if (equals == std::string::npos) {
+			throw std::runtime_error(location + "Expected an action name followed by =");
+		}
+
+		std::string actionName = trim(line.substr(0, equals));
+		int action = 0;
+		while (action < actionCount && actionName != actionNames[action]) {
+			++action;
+		}
+		if (action == actionCount) {
+			throw std::runtime_error(location + "Unknown action " + actionName);
+		}
+		if (listed[action]) {
+			throw std::runtime_error(location + actionName + " is listed more than once");
+		}
+		listed[action] = true;
+
+		std::vector<int> bits;
+		std::istringstream inputNames(line.substr(equals + 1));
+		std::string inputName;
+		while (std::getline(inputNames, inputName, ',')) {
+			inputName = trim(inputName);
+			int bit = parseInput(inputName);
+			if (bit == InputState::nullBit) {
+				throw std::runtime_error(location + "Unknown input " + inputName);
+			}
+			bits.push_back(bit);
+		}
+
+		try {
+			bindings.bind(static_cast<InputAction>(action), bits);
+		} catch (const std::runtime_error& e) {
+			throw std::runtime_error(location + e.what());
+		}
+	}
+
+	std::vector<std::string> conflicts = bindings.findConflicts();
+	if (!conflicts.empty()) {
+		std::string message = sourceName + " has conflicting bindings:";
+		for (const std::string& conflict : conflicts) {
+			message += "\n" + conflict;
+		}
+		throw std::runtime_error(message);
+	}
+	return bindings;
+}
+
+InputBindings InputBindings::load(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file) {
+		throw std::runtime_error("Input bindings not found: " + path);
+	}
+	std::string text;
+	char buffer[4096];
+	std::size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		text.append(buffer, count);
+	}
+	fclose(file);
+	return parse(text, path);
+}
+
+InputBindings InputBindings::loadIfPresent(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file) {
+		if (errno == ENOENT) {
+			return InputBindings();
+		}
+		throw std::runtime_error("Input bindings not found: " + path);
+	}
+	fclose(file);
+	return load(path);
+}
+
+void InputBindings::bind(InputAction action, const std::vector<int>& bits) {
+	if (bits.size() > maxInputsPerAction) {
+		throw std::runtime_error(std::string("Too many inputs bound to ") + getActionName(action) + ", the most is "
+			+ std::to_string(maxInputsPerAction));
+	}
+	int unbound = InputState::nullBit;
+	ActionBits& actionBits = table[static_cast<int>(action)];
+	actionBits.fill(unbound);
+	for (std::size_t i = 0; i < bits.size(); ++i) {
+		actionBits[i] = bits[i];
+	}
+}
+
+std::vector<std::string> InputBindings::findConflicts() const {
+	std::vector<std::string> conflicts;
+	int unbound = actionCount;
+	std::vector<int> boundAction(InputState::bitCount, unbound);
+	for (int action = 0; action < actionCount; ++action) {
+		for (int bit : table[action]) {
+			if (bit == InputState::nullBit || boundAction[bit] == action) {
+				continue;
+			}
+			if (boundAction[bit] != unbound) {
+				conflicts.push_back(getInputName(bit) + " is bound to both " + actionNames[boundAction[bit]] + " and "
+					+ actionNames[action]);
+			} else {
+				boundAction[bit] = action;
+			}
+		}
+	}
+	return conflicts;
+}
+
+const char* InputBindings::getActionName(InputAction action) {
+	return actionNames[static_cast<int>(action)];
+}
+
+std::string InputBindings::getInputName(int bit) {
+	for (const auto& inputName : getInputNames()) {
+		if (inputName.second == bit) {
+			return inputName.first;
+		}
+	}
+	return "";
+}
+
+int InputBindings::parseInput(const std::string& name) {
+	for (const auto& inputName : getInputNames()) {
+		if (inputName.first == name) {
+			return inputName.second;
+		}
+	}
+	return InputState::nullBit;
+}
@@ -0,0 +1,82 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+#include "InputState.h"
+
+// Everything the player can do with a key or mouse button. Entities ask about these instead of physical inputs, so the
+// bindings can change without any entity knowing.
+enum class InputAction {
+	MOVE_FORWARDS, MOVE_BACKWARDS, MOVE_LEFT, MOVE_RIGHT, MOVE_UP, MOVE_DOWN, ROLL_CLOCKWISE, ROLL_COUNTERCLOCKWISE,
+	TOGGLE_SPEED, TOGGLE_ROTATION_LOCK, GO_HOME, ZOOM_IN, ZOOM_OUT,
+	SPAWN_DODECAHEDRON, SPAWN_HOROSPHERE, SPAWN_PLANE, SPAWN_PRISM, SPAWN_TREE, SPAWN_BALL, SPAWN_GRID,
+	SPAWN_TESSELLATION, DESPAWN_ALL,
+	COUNT
+};
+
+// Maps each action to the inputs bound to it, as a flat table of InputState bits indexed by the action, so asking about
+// an action is a few bit tests with no lookups by name. Every action has room for the same number of inputs, and the
+// unused entries are the null bit, which is never set.
+class InputBindings {
+public:
+	static constexpr int maxInputsPerAction = 4;
+	static constexpr int actionCount = static_cast<int>(InputAction::COUNT);
+
+	using ActionBits = std::array<int, maxInputsPerAction>;
+
+	// The default bindings, as listed in the README
+	InputBindings();
+
+	// Starts from the default bindings and replaces the inputs of every action the text lists. Each line is an action
+	// name, an equals sign and a comma-separated list of input names, which may be empty to unbind the action, and
+	// everything after a # is a comment. Throws std::runtime_error, naming the source and line, if the text has an
+	// unknown action or input, lists an action twice or binds too many inputs to one, or if the resulting bindings
+	// have a conflict.
+	static InputBindings parse(const std::string& text, const std::string& sourceName);
+
+	// Parses the file as above, also throwing std::runtime_error if it cannot be read
+	static InputBindings load(const std::string& path);
+
+	// As load, but returns the default bindings if the file does not exist
+	static InputBindings loadIfPresent(const std::string& path);
+
+	// Replaces the action's inputs with the given InputState bits. Throws std::runtime_error if there are more than
+	// maxInputsPerAction of them.
+	void bind(InputAction action, const std::vector<int>& bits);
+
+	// Describes every input bound to more than one action. All actions are active at once, so pressing such an input
+	// would do two things.
+	std::vector<std::string> findConflicts() const;
+
+	const ActionBits& getBits(InputAction action) const {
+		return table[static_cast<int>(action)];
+	}
+
+	// The name of the action in binding files, such as "move_forwards"
+	static const char* getActionName(InputAction action);
+
+	// The name of the input with the given InputState bit in binding files, such as "KEY_W", or an empty string for
+	// an input without one
+	static std::string getInputName(int bit);
+
+	// Returns the InputState bit of the named input, or InputState::nullBit if there is no such input
+	static int parseInput(const std::string& name);
+
+private:
+	std::array<ActionBits, actionCount> table;
+};
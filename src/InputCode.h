@@ -0,0 +1,53 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+
+// Keyboard key and mouse button codes. They have the same values as GLFW's, so the window layer can pass GLFW's codes
+// through unchanged while the rest of the game does not depend on GLFW.
+namespace InputCode {
+	constexpr int MOUSE_BUTTON_1 = 0;
+	constexpr int MOUSE_BUTTON_2 = 1;
+	constexpr int MOUSE_BUTTON_3 = 2;
+	constexpr int MOUSE_BUTTON_LAST = 7;
+
+	constexpr int KEY_SPACE = 32;
+	constexpr int KEY_0 = 48;
+	constexpr int KEY_1 = 49;
+	constexpr int KEY_2 = 50;
+	constexpr int KEY_3 = 51;
+	constexpr int KEY_4 = 52;
+	constexpr int KEY_5 = 53;
+	constexpr int KEY_6 = 54;
+	constexpr int KEY_7 = 55;
+	constexpr int KEY_8 = 56;
+	constexpr int KEY_9 = 57;
+	constexpr int KEY_A = 65;
+	constexpr int KEY_D = 68;
+	constexpr int KEY_E = 69;
+	constexpr int KEY_O = 79;
+	constexpr int KEY_P = 80;
+	constexpr int KEY_Q = 81;
+	constexpr int KEY_S = 83;
+	constexpr int KEY_W = 87;
+	constexpr int KEY_ESCAPE = 256;
+	constexpr int KEY_UP = 265;
+	constexpr int KEY_HOME = 268;
+	constexpr int KEY_F11 = 300;
+	constexpr int KEY_LEFT_SHIFT = 340;
+	constexpr int KEY_LEFT_CONTROL = 341;
+	constexpr int KEY_LAST = 348;
+}
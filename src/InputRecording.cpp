@@ -0,0 +1,162 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "InputRecording.h"
+
+// File layout, all little-endian: the magic bytes "HWIN", a uint32 version, the float64 tick interval and a uint32 step
+// count, then for each step the float64 dt, the float64 mouse look x and y, and four code lists (keys down, mouse buttons
+// down, keys pressed, mouse buttons pressed), each a uint16 count followed by that many int16 codes. Version 1 has no
+// tick interval, and is read with a tick interval of 0.
+namespace {
+	const char magic[4] = {'H', 'W', 'I', 'N'};
+	const std::uint32_t version = 2;
+	const std::uint32_t versionWithoutTickInterval = 1;
+
+	class Writer {
+	public:
+		explicit Writer(std::vector<unsigned char>& bytes): bytes(bytes) {}
+
+		void writeUnsigned(std::uint64_t value, int size) {
+			for (int i = 0; i < size; ++i) {
+				bytes.push_back(static_cast<unsigned char>(value >> (8 * i)));
+			}
+		}
+
+		void writeDouble(double value) {
+			std::uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			writeUnsigned(bits, 8);
+		}
+
+		void writeCodes(const std::vector<int>& codes) {
+			writeUnsigned(codes.size(), 2);
+			for (int code : codes) {
+				writeUnsigned(static_cast<std::uint16_t>(static_cast<std::int16_t>(code)), 2);
+			}
+		}
+
+	private:
+		std::vector<unsigned char>& bytes;
+	};
+
+	class Reader {
+	public:
+		explicit Reader(const std::vector<unsigned char>& bytes): bytes(bytes) {}
+
+		std::uint64_t readUnsigned(int size) {
+			if (position + size > bytes.size()) {
+				throw std::runtime_error("Input recording is truncated");
+			}
+			std::uint64_t value = 0;
+			for (int i = 0; i < size; ++i) {
+				value |= static_cast<std::uint64_t>(bytes[position++]) << (8 * i);
+			}
+			return value;
+		}
+
+		double readDouble() {
+			std::uint64_t bits = readUnsigned(8);
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		std::vector<int> readCodes() {
+			std::vector<int> codes(readUnsigned(2));
+			for (int& code : codes) {
+				code = static_cast<std::int16_t>(static_cast<std::uint16_t>(readUnsigned(2)));
+			}
+			return codes;
+		}
+
+	private:
+		const std::vector<unsigned char>& bytes;
+		std::size_t position = 0;
+	};
+}
+
+void InputRecording::save(const std::string& path) const {
+	std::vector<unsigned char> bytes(magic, magic + sizeof(magic));
+	Writer writer(bytes);
+	writer.writeUnsigned(version, 4);
+	writer.writeDouble(tickInterval);
+	writer.writeUnsigned(steps.size(), 4);
+	for (const RecordedInputStep& step : steps) {
+		writer.writeDouble(step.dt);
+		writer.writeDouble(step.mouseLook.x());
+		writer.writeDouble(step.mouseLook.y());
+		writer.writeCodes(step.keysDown);
+		writer.writeCodes(step.mouseButtonsDown);
+		writer.writeCodes(step.keysPressed);
+		writer.writeCodes(step.mouseButtonsPressed);
+	}
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file) {
+		throw std::runtime_error("Could not open " + path + " for writing");
+	}
+	bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	written = fclose(file) == 0 && written;
+	if (!written) {
+		throw std::runtime_error("Failed to write " + path);
+	}
+}
+
+InputRecording InputRecording::load(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file) {
+		throw std::runtime_error("Input recording not found: " + path);
+	}
+	std::vector<unsigned char> bytes;
+	unsigned char buffer[4096];
+	std::size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		bytes.insert(bytes.end(), buffer, buffer + count);
+	}
+	fclose(file);
+
+	if (bytes.size() < sizeof(magic) || std::memcmp(bytes.data(), magic, sizeof(magic)) != 0) {
+		throw std::runtime_error(path + " is not an input recording");
+	}
+
+	Reader reader(bytes);
+	reader.readUnsigned(sizeof(magic));
+	std::uint64_t fileVersion = reader.readUnsigned(4);
+	if (fileVersion != version && fileVersion != versionWithoutTickInterval) {
+		throw std::runtime_error(path + " was recorded with an unsupported version");
+	}
+
+	InputRecording recording;
+	if (fileVersion != versionWithoutTickInterval) {
+		recording.tickInterval = reader.readDouble();
+	}
+	std::uint64_t stepCount = reader.readUnsigned(4);
+	for (std::uint64_t i = 0; i < stepCount; ++i) {
+		RecordedInputStep step;
+		step.dt = reader.readDouble();
+		step.mouseLook.x() = reader.readDouble();
+		step.mouseLook.y() = reader.readDouble();
+		step.keysDown = reader.readCodes();
+		step.mouseButtonsDown = reader.readCodes();
+		step.keysPressed = reader.readCodes();
+		step.mouseButtonsPressed = reader.readCodes();
+		recording.addStep(std::move(step));
+	}
+	return recording;
+}
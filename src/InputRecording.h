@@ -0,0 +1,104 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "VectorMath.h"
+#include "InputState.h"
+
+// Everything UserInput reported during one step of the scene, along with the step's duration
+class RecordedInputStep {
+public:
+	double dt = 0;
+	Vector2d mouseLook = Vector2d::Zero();
+	std::vector<int> keysDown;
+	std::vector<int> mouseButtonsDown;
+	std::vector<int> keysPressed;
+	std::vector<int> mouseButtonsPressed;
+
+	// The codes of everything held and pressed in the state, in increasing order
+	static RecordedInputStep fromState(double dt, Vector2d mouseLook, const InputState& state) {
+		RecordedInputStep step;
+		step.dt = dt;
+		step.mouseLook = mouseLook;
+		addCodes(state.getHeld(), step.keysDown, step.mouseButtonsDown);
+		addCodes(state.getPressed(), step.keysPressed, step.mouseButtonsPressed);
+		return step;
+	}
+
+	// Moves the state on to this step
+	void applyTo(InputState& state) const {
+		state.advance(toBits(keysDown, mouseButtonsDown), toBits(keysPressed, mouseButtonsPressed));
+	}
+
+private:
+	static void addCodes(const InputState::Bits& bits, std::vector<int>& keys, std::vector<int>& mouseButtons) {
+		for (int key = 0; key < InputState::keyCount; ++key) {
+			if (bits[InputState::getKeyBit(key)]) {
+				keys.push_back(key);
+			}
+		}
+		for (int button = 0; button < InputState::mouseButtonCount; ++button) {
+			if (bits[InputState::getMouseButtonBit(button)]) {
+				mouseButtons.push_back(button);
+			}
+		}
+	}
+
+	static InputState::Bits toBits(const std::vector<int>& keys, const std::vector<int>& mouseButtons) {
+		InputState::Bits bits;
+		for (int key : keys) {
+			bits.set(InputState::getKeyBit(key));
+		}
+		for (int button : mouseButtons) {
+			bits.set(InputState::getMouseButtonBit(button));
+		}
+		bits.reset(InputState::nullBit);
+		return bits;
+	}
+};
+
+// A sequence of input steps, which can be saved and replayed so that the scene goes through exactly the same steps
+class InputRecording {
+public:
+	void addStep(RecordedInputStep step) {
+		steps.push_back(std::move(step));
+	}
+
+	const std::vector<RecordedInputStep>& getSteps() const {
+		return steps;
+	}
+
+	// The fixed tick interval the steps were taken at, in seconds, or 0 if it is not known, as in recordings saved
+	// before it was stored
+	double getTickInterval() const {
+		return tickInterval;
+	}
+
+	void setTickInterval(double tickInterval) {
+		this->tickInterval = tickInterval;
+	}
+
+	// Throws std::runtime_error if the file cannot be written or read
+	void save(const std::string& path) const;
+	static InputRecording load(const std::string& path);
+
+private:
+	std::vector<RecordedInputStep> steps;
+	double tickInterval = 0;
+};
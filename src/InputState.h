@@ -0,0 +1,106 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <bitset>
+#include "InputCode.h"
+
+// The state of every key and mouse button, as one bit each in fixed-size bitsets, so that a query is a single bit test
+// with no branches or allocation. Keys take the bits of their codes, mouse buttons the bits after them, and the last bit
+// is never set, so an unbound input can be tested like any other.
+class InputState {
+public:
+	static constexpr int keyCount = InputCode::KEY_LAST + 1;
+	static constexpr int mouseButtonCount = InputCode::MOUSE_BUTTON_LAST + 1;
+	static constexpr int bitCount = keyCount + mouseButtonCount + 1;
+	static constexpr int nullBit = bitCount - 1;
+
+	using Bits = std::bitset<bitCount>;
+
+	// Codes outside of the known range, such as a key with no code, map to the null bit
+	static int getKeyBit(int key) {
+		return key >= 0 && key < keyCount ? key : nullBit;
+	}
+
+	static int getMouseButtonBit(int button) {
+		return button >= 0 && button < mouseButtonCount ? keyCount + button : nullBit;
+	}
+
+	// For the window layer, which calls these as events arrive
+	void press(int bit) {
+		if (bit != nullBit) {
+			held.set(bit);
+			pressed.set(bit);
+		}
+	}
+
+	// Holds the input without counting it as a press, for a press the window layer handles itself
+	void hold(int bit) {
+		if (bit != nullBit) {
+			held.set(bit);
+		}
+	}
+
+	void release(int bit) {
+		if (bit != nullBit) {
+			held.reset(bit);
+			released.set(bit);
+		}
+	}
+
+	// Forgets the presses and releases, keeping what is held
+	void clearEdges() {
+		pressed.reset();
+		released.reset();
+	}
+
+	// Moves on to the next step, given what is held and what was pressed during it. Releases are whatever was held and
+	// no longer is, so they only depend on the held state of both steps and a replay reproduces them exactly.
+	void advance(const Bits& nextHeld, const Bits& nextPressed) {
+		released = held & ~nextHeld;
+		held = nextHeld;
+		pressed = nextPressed;
+	}
+
+	bool isHeld(int bit) const {
+		return held[bit];
+	}
+
+	bool wasPressed(int bit) const {
+		return pressed[bit];
+	}
+
+	bool wasReleased(int bit) const {
+		return released[bit];
+	}
+
+	const Bits& getHeld() const {
+		return held;
+	}
+
+	const Bits& getPressed() const {
+		return pressed;
+	}
+
+	const Bits& getReleased() const {
+		return released;
+	}
+
+private:
+	Bits held;
+	Bits pressed;
+	Bits released;
+};
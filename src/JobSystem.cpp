@@ -0,0 +1,204 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include "JobSystem.h"
+
+namespace {
+	// Which system's worker the current thread is, if any, so that jobs started by a job go to that worker's own queue
+	thread_local const JobSystem* currentSystem = nullptr;
+	thread_local std::size_t currentQueue = 0;
+}
+
+JobSystem::JobSystem(unsigned threadCount): queuedJobs(0) {
+	threadCount = std::max(threadCount, 1u);
+	for (unsigned i = 0; i < threadCount; ++i) {
+		queues.push_back(std::make_unique<WorkQueue>());
+	}
+	for (unsigned i = 1; i < threadCount; ++i) {
+		workers.emplace_back([this, i]() { workerLoop(i); });
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wakeUp.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void JobSystem::run(JobGroup& group, Job job) {
+	{
+		std::lock_guard<std::mutex> lock(group.mutex);
+		++group.pending;
+	}
+	push(QueuedJob {&group, std::move(job)});
+}
+
+void JobSystem::runAfter(JobGroup& dependency, JobGroup& group, Job job) {
+	{
+		std::lock_guard<std::mutex> lock(group.mutex);
+		++group.pending;
+	}
+	std::exception_ptr exception;
+	{
+		std::lock_guard<std::mutex> lock(dependency.mutex);
+		if (dependency.pending != 0) {
+			dependency.continuations.push_back(JobGroup::Continuation {&group, std::move(job)});
+			return;
+		}
+		exception = dependency.exception;
+	}
+
+	if (exception) {
+		finish(group, exception);
+	} else {
+		push(QueuedJob {&group, std::move(job)});
+	}
+}
+
+void JobSystem::wait(JobGroup& group) {
+	std::size_t queueIndex = getCurrentQueue();
+	while (!group.isFinished()) {
+		if (tryRunJob(queueIndex)) {
+			continue;
+		}
+
+		// Nothing to run, so sleep until a job is queued or the group's last job finishes (see finish)
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this, &group]() { return queuedJobs != 0 || group.isFinished(); });
+	}
+
+	std::exception_ptr exception;
+	{
+		std::lock_guard<std::mutex> lock(group.mutex);
+		std::swap(exception, group.exception);
+	}
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
+
+std::size_t JobSystem::getCurrentQueue() const {
+	return currentSystem == this ? currentQueue : 0;
+}
+
+void JobSystem::push(QueuedJob queuedJob) {
+	// Counted under the sleep mutex so that a worker cannot miss the job between checking the count and sleeping, and
+	// before the job is queued so that the thread that takes it cannot count it off first
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		++queuedJobs;
+	}
+
+	WorkQueue& queue = *queues[getCurrentQueue()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(queuedJob));
+	}
+	wakeUp.notify_one();
+}
+
+bool JobSystem::tryRunJob(std::size_t queueIndex) {
+	QueuedJob queuedJob {nullptr, nullptr};
+
+	// Newest job first from the thread's own queue, which keeps the data a job just produced in cache
+	{
+		WorkQueue& queue = *queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			queuedJob = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+		}
+	}
+
+	// Otherwise the oldest job from another queue, which tends to be the largest piece of work left there
+	for (std::size_t i = 1; i < queues.size() && queuedJob.group == nullptr; ++i) {
+		WorkQueue& queue = *queues[(queueIndex + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			queuedJob = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+	}
+
+	if (queuedJob.group == nullptr) {
+		return false;
+	}
+
+	--queuedJobs;
+	std::exception_ptr exception;
+	try {
+		queuedJob.job();
+	} catch (...) {
+		exception = std::current_exception();
+	}
+	finish(*queuedJob.group, exception);
+	return true;
+}
+
+void JobSystem::finish(JobGroup& group, std::exception_ptr exception) {
+	std::vector<JobGroup::Continuation> continuations;
+	bool finished = false;
+	{
+		// The waiting thread may destroy the group as soon as the mutex is released, so nothing touches the group after
+		std::lock_guard<std::mutex> lock(group.mutex);
+		if (exception && !group.exception) {
+			group.exception = exception;
+		}
+		if (--group.pending == 0) {
+			std::swap(continuations, group.continuations);
+			exception = group.exception;
+			finished = true;
+		}
+	}
+
+	// Jobs that depend on a group that threw are not run, and their own groups finish with the same exception
+	for (JobGroup::Continuation& continuation : continuations) {
+		if (exception) {
+			finish(*continuation.group, exception);
+		} else {
+			push(QueuedJob {continuation.group, std::move(continuation.job)});
+		}
+	}
+
+	// Taking the sleep mutex orders the wake-up after a waiting thread's last check of the group
+	if (finished) {
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeUp.notify_all();
+	}
+}
+
+void JobSystem::workerLoop(std::size_t queueIndex) {
+	currentSystem = this;
+	currentQueue = queueIndex;
+
+	while (true) {
+		if (tryRunJob(queueIndex)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this]() { return stopping || queuedJobs != 0; });
+		if (stopping) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,130 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A small work-stealing scheduler. Every worker thread has its own queue of jobs, taking the newest job from its own
+// queue and stealing the oldest job from another queue when its own is empty. Threads outside the pool share one more
+// queue. Jobs can start more jobs, and a thread waiting for a group of jobs runs other jobs until the group is done, so
+// jobs can wait for jobs they started without tying up a thread. Threads with nothing to run sleep until a job is
+// queued or a group finishes.
+class JobSystem {
+public:
+	using Job = std::function<void()>;
+
+	// Jobs that are waited for together. A group must outlive every job added to it.
+	class JobGroup {
+	public:
+		JobGroup() = default;
+		JobGroup(const JobGroup&) = delete;
+		JobGroup& operator=(const JobGroup&) = delete;
+
+		bool isFinished() {
+			std::lock_guard<std::mutex> lock(mutex);
+			return pending == 0;
+		}
+
+	private:
+		friend class JobSystem;
+
+		class Continuation {
+		public:
+			JobGroup* group;
+			Job job;
+		};
+
+		std::mutex mutex;
+		std::size_t pending = 0;
+		std::vector<Continuation> continuations; // Queued once pending reaches zero, or cancelled if a job threw
+		std::exception_ptr exception; // The first exception thrown by a job in the group
+	};
+
+	// The thread count includes the thread that creates the system, so a count of 1 runs every job on the threads
+	// that wait for them.
+	explicit JobSystem(unsigned threadCount = std::thread::hardware_concurrency());
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	unsigned getThreadCount() const {
+		return static_cast<unsigned>(workers.size() + 1);
+	}
+
+	void run(JobGroup& group, Job job);
+
+	// Adds the job to the group, but only queues it once every job in the dependency has finished. If one of them
+	// threw, the job is not run, and the group gets the exception instead.
+	void runAfter(JobGroup& dependency, JobGroup& group, Job job);
+
+	// Runs jobs until every job in the group has finished. If any of them threw, rethrows the first exception.
+	void wait(JobGroup& group);
+
+	// Calls function(i) for every i in [begin, end), grainSize indices per job, and waits for all of them
+	template<typename Function>
+	void parallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const Function& function) {
+		JobGroup group;
+		grainSize = std::max<std::size_t>(grainSize, 1);
+		for (std::size_t chunkBegin = begin; chunkBegin < end; chunkBegin += std::min(grainSize, end - chunkBegin)) {
+			std::size_t chunkEnd = chunkBegin + std::min(grainSize, end - chunkBegin);
+			run(group, [&function, chunkBegin, chunkEnd]() {
+				for (std::size_t i = chunkBegin; i < chunkEnd; ++i) {
+					function(i);
+				}
+			});
+		}
+		wait(group);
+	}
+
+private:
+	class QueuedJob {
+	public:
+		JobGroup* group;
+		Job job;
+	};
+
+	// The owner pushes and pops at the back, and other threads steal from the front
+	class WorkQueue {
+	public:
+		std::mutex mutex;
+		std::deque<QueuedJob> jobs;
+	};
+
+	std::vector<std::unique_ptr<WorkQueue>> queues; // Queue 0 is shared by threads outside the pool
+	std::vector<std::thread> workers;
+	std::atomic<std::size_t> queuedJobs;
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+
+	std::size_t getCurrentQueue() const;
+	void push(QueuedJob queuedJob);
+	bool tryRunJob(std::size_t queueIndex);
+	void finish(JobGroup& group, std::exception_ptr exception);
+	void workerLoop(std::size_t queueIndex);
+};
@@ -0,0 +1,63 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <stdexcept>
+#include <string>
+
+class LaunchOptions {
+public:
+	LaunchOptions(int argc, char* argv[]) {
+		for (int i = 1; i < argc; ++i) {
+			std::string argument = argv[i];
+			if (argument == "--watch-shaders") {
+				watchShaders = true;
+			} else if (argument == "--double-float-transforms") {
+				doubleFloatTransforms = true;
+			} else if (argument == "--record-input" && i + 1 < argc) {
+				recordInputPath = argv[++i];
+			} else if (argument == "--replay-input" && i + 1 < argc) {
+				replayInputPath = argv[++i];
+			} else if (argument == "--bindings" && i + 1 < argc) {
+				bindingsPath = argv[++i];
+				bindingsRequired = true;
+			} else {
+				throw std::runtime_error("Unknown command-line argument: " + argument);
+			}
+		}
+	}
+
+	// Reload shaders whenever their source files change
+	bool watchShaders = false;
+
+	// Transform the models that extend far from their origin in double-float precision
+	bool doubleFloatTransforms = false;
+
+	// Save every step's input to this file on exit, if set
+	std::string recordInputPath;
+
+	// Step the scene with the input and step durations from this file instead of the keyboard, mouse and clock, and
+	// exit when the recording ends, if set
+	std::string replayInputPath;
+
+	// The file that binds keys and mouse buttons to actions. A replay is stepped with these bindings too, so it only
+	// reproduces the recorded session if they are the same as when it was recorded.
+	std::string bindingsPath = "bindings.cfg";
+
+	// Whether the bindings file was given on the command line. If not, the default bindings are used when it does not
+	// exist.
+	bool bindingsRequired = false;
+};
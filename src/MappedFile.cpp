@@ -0,0 +1,119 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <stdexcept>
+#include <utility>
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("Could not open " + path);
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		throw std::runtime_error("Could not read the size of " + path);
+	}
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+	if (size == 0) {
+		CloseHandle(file);
+		return; // An empty file cannot be mapped, but has nothing to map anyway
+	}
+
+	// The mapping keeps the file open by itself, so the file handle is not needed past this point
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping) {
+		throw std::runtime_error("Could not map " + path);
+	}
+	data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!data) {
+		CloseHandle(mapping);
+		mapping = nullptr;
+		throw std::runtime_error("Could not map " + path);
+	}
+}
+
+void MappedFile::close() {
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+	data = nullptr;
+	mapping = nullptr;
+	size = 0;
+}
+#else
+MappedFile::MappedFile(const std::string& path) {
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		throw std::runtime_error("Could not open " + path);
+	}
+
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0) {
+		::close(file);
+		throw std::runtime_error("Could not read the size of " + path);
+	}
+	size = static_cast<std::size_t>(fileStatus.st_size);
+	if (size == 0) {
+		::close(file);
+		return; // An empty file cannot be mapped, but has nothing to map anyway
+	}
+
+	// The mapping keeps the file open by itself, so the descriptor is not needed past this point
+	void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (view == MAP_FAILED) {
+		size = 0;
+		throw std::runtime_error("Could not map " + path);
+	}
+	data = static_cast<const unsigned char*>(view);
+}
+
+void MappedFile::close() {
+	if (data) {
+		munmap(const_cast<unsigned char*>(data), size);
+	}
+	data = nullptr;
+	size = 0;
+}
+#endif
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		close();
+		std::swap(data, other.data);
+		std::swap(size, other.size);
+		std::swap(mapping, other.mapping);
+	}
+	return *this;
+}
@@ -0,0 +1,58 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+// A read-only view of a file's contents, mapped into memory so that reading it copies nothing until the pages are
+// touched. The view stays valid for as long as this object lives.
+class MappedFile {
+public:
+	MappedFile() = default;
+
+	// Throws std::runtime_error if the file cannot be opened or mapped
+	explicit MappedFile(const std::string& path);
+
+	~MappedFile() {
+		close();
+	}
+
+	MappedFile(MappedFile&& other) noexcept {
+		*this = std::move(other);
+	}
+
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const unsigned char* getData() const {
+		return data;
+	}
+
+	std::size_t getSize() const {
+		return size;
+	}
+
+private:
+	const unsigned char* data = nullptr;
+	std::size_t size = 0;
+	void* mapping = nullptr; // Only used on Windows, where the view needs its mapping object to be closed as well
+
+	void close();
+};
@@ -0,0 +1,36 @@
+/*
+	Copyright 2020 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class Vertex {
+public:
+	Vertex(std::array<float, 4> pos, std::array<float, 4> normal, std::array<float, 2> texCoord): pos(pos), normal(normal), texCoord(texCoord) {}
+	std::array<float, 4> pos;
+	std::array<float, 4> normal;
+	std::array<float, 2> texCoord;
+};
+
+// The CPU-side data of a model, before it is uploaded to the GPU
+class Mesh {
+public:
+	std::vector<Vertex> vertices;
+	std::vector<std::uint32_t> elements;
+};
@@ -0,0 +1,222 @@
+/*
+	Copyright 2020 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "MeshGenerators.h"
+#include "Tessellation.h"
+#include "VectorMathBatch.h"
+
+Mesh makeDodecahedron() {
+	float s = 0.31546169558954995f;
+	float goldenRatio = (1.0f + sqrtf(5.0f)) / 2.0f;
+	float q = s / goldenRatio, p = s * goldenRatio;
+
+	// Factor to convert from Poincare ball model to hyperboloid model
+	float factor = 2.0f / (1.0f - s * s * 3.0f);
+
+	std::array<std::array<std::array<float, 3>, 5>, 12> table = {{
+		{{{ 0,  q,  p}, { s,  s,  s}, { q,  p,  0}, {-q,  p,  0}, {-s,  s,  s}}},
+		{{{ 0,  q, -p}, {-s,  s, -s}, {-q,  p,  0}, { q,  p,  0}, { s,  s, -s}}},
+		{{{ 0, -q,  p}, {-s, -s,  s}, {-q, -p,  0}, { q, -p,  0}, { s, -s,  s}}},
+		{{{ 0, -q, -p}, { s, -s, -s}, { q, -p,  0}, {-q, -p,  0}, {-s, -s, -s}}},
+
+		{{{ p,  0,  q}, { s,  s,  s}, { 0,  q,  p}, { 0, -q,  p}, { s, -s,  s}}},
+		{{{-p,  0,  q}, {-s, -s,  s}, { 0, -q,  p}, { 0,  q,  p}, {-s,  s,  s}}},
+		{{{ p,  0, -q}, { s, -s, -s}, { 0, -q, -p}, { 0,  q, -p}, { s,  s, -s}}},
+		{{{-p,  0, -q}, {-s,  s, -s}, { 0,  q, -p}, { 0, -q, -p}, {-s, -s, -s}}},
+
+		{{{ q,  p,  0}, { s,  s,  s}, { p,  0,  q}, { p,  0, -q}, { s,  s, -s}}},
+		{{{ q, -p,  0}, { s, -s, -s}, { p,  0, -q}, { p,  0,  q}, { s, -s,  s}}},
+		{{{-q,  p,  0}, {-s,  s, -s}, {-p,  0, -q}, {-p,  0,  q}, {-s,  s,  s}}},
+		{{{-q, -p,  0}, {-s, -s,  s}, {-p,  0,  q}, {-p,  0, -q}, {-s, -s, -s}}},
+	}};
+
+	ModelBuilder builder;
+
+	for (const auto& face : table) {
+		std::vector<Vector4d> faceVertices;
+
+		for (const auto& faceVertexData : face) {
+			faceVertices.emplace_back(
+				faceVertexData[0] * factor,
+				faceVertexData[1] * factor,
+				faceVertexData[2] * factor,
+				factor - 1.0f
+			);
+		}
+
+		builder.addPolygonFace<HyperbolicGeometry>(faceVertices);
+	}
+
+	builder.addBackFaces();
+
+	return builder.build();
+}
+
+Mesh makeSphericalTetrahedron() {
+	float s = 1.0f;
+	float cos_s = cosf(s);
+	float sin_s = sinf(s);
+
+	float normalization_factor = sqrtf(1.0f / 3.0f);
+
+	std::array<std::array<std::array<float, 3>, 3>, 4> table = {{
+		{{{ 1,  1,  1}, { 1, -1, -1}, {-1,  1, -1}}},
+		{{{ 1,  1,  1}, {-1,  1, -1}, {-1, -1,  1}}},
+		{{{ 1,  1,  1}, {-1, -1,  1}, { 1, -1, -1}}},
+		{{{-1, -1,  1}, {-1,  1, -1}, { 1, -1, -1}}},
+	}};
+
+	ModelBuilder builder;
+
+	for (const auto& face : table) {
+		std::vector<Vector4d> faceVertices;
+
+		for (const auto& faceVertexData : face) {
+			faceVertices.emplace_back(
+				faceVertexData[0] * normalization_factor * sin_s,
+				faceVertexData[1] * normalization_factor * sin_s,
+				faceVertexData[2] * normalization_factor * sin_s,
+				cos_s
+			);
+		}
+
+		builder.addPolygonFace<SphericalGeometry>(faceVertices);
+	}
+
+	builder.addBackFaces();
+
+	return builder.build();
+}
+
+namespace {
+	const int horosphereSteps = 400;
+	const double horosphereSize = 20;
+	const double horosphereTextureSize = 5;
+
+	// Adds the vertices of row i of the horosphere, computed as one batch
+	void addHorosphereRow(ModelBuilder& builder, int i) {
+		Vector2dBatch offsets(horosphereSteps + 1);
+		Matrix4dBatch rotations;
+		Vector4dBatch positions;
+
+		double xPos = (static_cast<double>(i)/horosphereSteps-0.5) * horosphereSize;
+		for (int j=0; j<=horosphereSteps; ++j) {
+			double yPos = (static_cast<double>(j)/horosphereSteps-0.5) * horosphereSize;
+			offsets.set(j, Vector2d(xPos, yPos));
+		}
+
+		VectorMathBatch::horoRotation(offsets, rotations);
+		VectorMathBatch::transform(rotations, Vector4d(0, 0, 0, 1), positions);
+
+		for (int j=0; j<=horosphereSteps; ++j) {
+			Vector2d offset = offsets.get(j);
+			builder.addVertex(
+				positions.get(j),
+				Vector4d(0, 0, 1, -1),
+				Vector2d(offset(0) * horosphereTextureSize, offset(1) * horosphereTextureSize));
+		}
+	}
+
+	// Adds the triangles between the rows, once every row's vertices have been added in order
+	Mesh finishHorosphere(ModelBuilder& builder) {
+		auto vertex = [](int i, int j) { return static_cast<std::uint32_t>(i * (horosphereSteps + 1) + j); };
+
+		for (int i=0; i<horosphereSteps; ++i) {
+			for (int j=0; j<horosphereSteps; ++j) {
+				builder.addTriangle(vertex(i, j), vertex(i+1, j), vertex(i, j+1));
+				builder.addTriangle(vertex(i, j+1), vertex(i+1, j), vertex(i+1, j+1));
+			}
+		}
+
+		builder.addBackFaces();
+
+		return builder.build();
+	}
+}
+
+Mesh makeHorosphere() {
+	ModelBuilder builder;
+	for (int i=0; i<=horosphereSteps; ++i) {
+		addHorosphereRow(builder, i);
+	}
+	return finishHorosphere(builder);
+}
+
+Mesh makeHorosphere(JobSystem& jobs) {
+	std::vector<ModelBuilder> rows(horosphereSteps + 1);
+	jobs.parallelFor(0, rows.size(), 8, [&rows](std::size_t i) {
+		addHorosphereRow(rows[i], static_cast<int>(i));
+	});
+
+	ModelBuilder builder;
+	for (const ModelBuilder& row : rows) {
+		builder.append(row);
+	}
+	return finishHorosphere(builder);
+}
+
+Mesh makePlane() {
+	ModelBuilder builder;
+	Tessellation tessellation;
+	tessellation.testTessellation();
+
+	std::array<Vector2d, tessellation.n> texCoords { Vector2d(0, 0), Vector2d(1, 0), Vector2d(0, 1) };
+	Vector4d normal(0, 0, 1, 0);
+
+	for (size_t i=0; i<tessellation.getNumFaces(); ++i) {
+		std::array<std::uint32_t, tessellation.n> vertices;
+
+		for (size_t j=0; j<tessellation.n; ++j) {
+			vertices[j] = builder.addVertex(tessellation.getVertexPos(i, j), normal, texCoords[j]);
+		}
+
+		int orientation = tessellation.getOrientation(i);
+		builder.addTriangle(vertices[0], vertices[(orientation + tessellation.n) % tessellation.n], vertices[(orientation * 2 + tessellation.n) % tessellation.n]);
+	}
+
+	builder.addBackFaces();
+
+	return builder.build();
+}
+
+Mesh makePrism() {
+	ModelBuilder builder;
+	Matrix4d transform;
+	transform << 1, 0, 0, 0,  0, -1, 0, 0,  0, 0, -1, 0,  0, 0, 0, 1;
+	builder.addPrism(transform, 8, 1, 2, 60);
+
+	builder.addBackFaces();
+
+	return builder.build();
+}
+
+Mesh makeTree() {
+	ModelBuilder builder;
+
+	TreeBuilder().buildTree(builder, SpinIsometry(), 7);
+
+	return builder.build();
+}
+
+Mesh makeTree(JobSystem& jobs) {
+	ModelBuilder builder;
+
+	TreeBuilder().buildTree(jobs, builder, SpinIsometry(), 7);
+
+	return builder.build();
+}
@@ -0,0 +1,162 @@
+/*
+	Copyright 2020 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <memory>
+#include <vector>
+#include "Mesh.h"
+#include "ModelBuilder.h"
+#include "SpinIsometry.h"
+#include "JobSystem.h"
+
+// Builds the CPU-side mesh of each model in ModelBank. None of these need a GL context.
+Mesh makeDodecahedron();
+Mesh makeSphericalTetrahedron();
+Mesh makeHorosphere();
+Mesh makePlane();
+Mesh makePrism();
+Mesh makeTree();
+
+// The same meshes, built with the job system. The result is identical to the serial version.
+Mesh makeHorosphere(JobSystem& jobs);
+Mesh makeTree(JobSystem& jobs);
+
+class TreeBuilder {
+public:
+	TreeBuilder(): sideLength(acosh(3)) {
+		SpinIsometry translation = SpinIsometry::displacement(Vector4d(0, 0, sideLength, 0));
+
+		recursiveTransformations.push_back(translation);
+		recursiveTransformations.push_back(translation * SpinIsometry::rotation(Vector3d(1, 0, 0), M_TAU / 4.0));
+		recursiveTransformations.push_back(translation * SpinIsometry::rotation(Vector3d(0, 1, 0), M_TAU / 4.0));
+		recursiveTransformations.push_back(translation * SpinIsometry::rotation(Vector3d(-1, 0, 0), M_TAU / 4.0));
+		recursiveTransformations.push_back(translation * SpinIsometry::rotation(Vector3d(0, -1, 0), M_TAU / 4.0));
+	}
+
+	void buildTree(ModelBuilder& builder, SpinIsometry transform, int layers) {
+		for (const SpinIsometry& root : getRoots(transform)) {
+			buildBranch(builder, root, layers);
+		}
+	}
+
+	// Every subtree with at least minForkLayers layers is built by its own job into its own fragment, and the fragments
+	// are appended in the order the serial recursion would have added them
+	void buildTree(JobSystem& jobs, ModelBuilder& builder, SpinIsometry transform, int layers) {
+		std::vector<SpinIsometry> roots = getRoots(transform);
+		std::vector<BranchFragment> fragments(roots.size());
+		JobSystem::JobGroup group;
+		for (std::size_t i = 0; i < roots.size(); ++i) {
+			jobs.run(group, [this, &jobs, &group, &fragments, &roots, i, layers]() {
+				buildBranch(jobs, group, fragments[i], roots[i], layers);
+			});
+		}
+		jobs.wait(group);
+
+		std::size_t vertexCount = builder.getVertexCount(), elementCount = builder.getElementCount();
+		for (const BranchFragment& fragment : fragments) {
+			fragment.count(vertexCount, elementCount);
+		}
+		builder.reserve(vertexCount, elementCount);
+		for (const BranchFragment& fragment : fragments) {
+			fragment.appendTo(builder);
+		}
+	}
+
+	// Branches are composed as SpinIsometry, and only expanded to a Matrix4d for the prism itself
+	void buildBranch(ModelBuilder& builder, SpinIsometry transform, int layers) {
+		if (transform.getPosition().w() > 100) {
+			return;
+		}
+
+		builder.addPrism(transform.toMatrix4d(), 8, 0.1, sideLength, 6);
+
+		if (layers != 0) {
+			for (std::size_t i = 0; i < recursiveTransformations.size(); ++i) {
+				buildBranch(builder, getChild(transform, i), layers - 1);
+			}
+		}
+	}
+
+private:
+	static constexpr int minForkLayers = 5;
+
+	std::vector<SpinIsometry> recursiveTransformations;
+	double sideLength;
+
+	// A branch's own prism, followed by the fragments of its children in order
+	class BranchFragment {
+	public:
+		ModelBuilder builder;
+		std::vector<std::unique_ptr<BranchFragment>> children;
+
+		void count(std::size_t& vertexCount, std::size_t& elementCount) const {
+			vertexCount += builder.getVertexCount();
+			elementCount += builder.getElementCount();
+			for (const auto& child : children) {
+				child->count(vertexCount, elementCount);
+			}
+		}
+
+		void appendTo(ModelBuilder& result) const {
+			result.append(builder);
+			for (const auto& child : children) {
+				child->appendTo(result);
+			}
+		}
+	};
+
+	std::vector<SpinIsometry> getRoots(const SpinIsometry& transform) const {
+		return {
+			transform,
+			transform * SpinIsometry::rotation(Vector3d(1, 0, 0), M_TAU / 4.0),
+			transform * SpinIsometry::rotation(Vector3d(0, 1, 0), M_TAU / 4.0),
+			transform * SpinIsometry::rotation(Vector3d(-1, 0, 0), M_TAU / 4.0),
+			transform * SpinIsometry::rotation(Vector3d(0, -1, 0), M_TAU / 4.0),
+			transform * SpinIsometry::rotation(Vector3d(1, 0, 0), M_TAU / 2.0),
+		};
+	}
+
+	SpinIsometry getChild(const SpinIsometry& transform, std::size_t i) const {
+		SpinIsometry child = transform * recursiveTransformations[i];
+		child.correctDrift();
+		return child;
+	}
+
+	void buildBranch(JobSystem& jobs, JobSystem::JobGroup& group, BranchFragment& fragment, SpinIsometry transform, int layers) {
+		if (layers < minForkLayers) {
+			buildBranch(fragment.builder, transform, layers);
+			return;
+		}
+
+		if (transform.getPosition().w() > 100) {
+			return;
+		}
+
+		fragment.builder.addPrism(transform.toMatrix4d(), 8, 0.1, sideLength, 6);
+
+		// The children are all allocated before any of their jobs start, so the vector is never resized while in use
+		for (std::size_t i = 0; i < recursiveTransformations.size(); ++i) {
+			fragment.children.push_back(std::make_unique<BranchFragment>());
+		}
+		for (std::size_t i = 0; i < recursiveTransformations.size(); ++i) {
+			BranchFragment& child = *fragment.children[i];
+			SpinIsometry childTransform = getChild(transform, i);
+			jobs.run(group, [this, &jobs, &group, &child, childTransform, layers]() {
+				buildBranch(jobs, group, child, childTransform, layers - 1);
+			});
+		}
+	}
+};
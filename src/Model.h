@@ -18,23 +18,17 @@
 
 #include "glad.h"
 #include <array>
-#include <vector>
 
-#include "VectorMath.h"
-
-class Vertex {
-public:
-	Vertex(std::array<float, 4> pos, std::array<float, 4> normal, std::array<float, 2> texCoord): pos(pos), normal(normal), texCoord(texCoord) {}
-	std::array<float, 4> pos;
-	std::array<float, 4> normal;
-	std::array<float, 2> texCoord;
-};
+#include "Mesh.h"
 
 class Model {
 public:
 	Model(): buffers{0, 0}, vertexArray(0), numVertices(0), numElements(0) {}
 
-	Model(const std::vector<Vertex>& vertices, const std::vector<GLuint>& elements) {
+	explicit Model(const Mesh& mesh) {
+		const std::vector<Vertex>& vertices = mesh.vertices;
+		const std::vector<std::uint32_t>& elements = mesh.elements;
+
 		glGenVertexArrays(1, &vertexArray);
 		glBindVertexArray(vertexArray);
 
@@ -53,7 +47,7 @@ public:
 
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
 		numElements = static_cast<GLsizei>(elements.size());
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * elements.size(), elements.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * elements.size(), elements.data(), GL_STATIC_DRAW);
 
 		glBindVertexArray(0);
 	}
@@ -86,6 +80,10 @@ public:
 		return *this;
 	}
 
+	GLsizei getNumElements() const {
+		return numElements;
+	}
+
 	void render() {
 		glBindVertexArray(vertexArray);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
@@ -16,227 +16,63 @@
 
 #pragma once
 #include <unordered_map>
+#include <memory>
 #include "Model.h"
-#include "ModelBuilder.h"
-#include "Tessellation.h"
+#include "MeshGenerators.h"
+#include "ShaderProgramKey.h"
+#include "JobSystem.h"
+#include "RenderHandles.h"
 
-Model makeDodecahedron() {
-	float s = 0.31546169558954995f;
-	float goldenRatio = (1.0f + sqrtf(5.0f)) / 2.0f;
-	float q = s / goldenRatio, p = s * goldenRatio;
-
-	// Factor to convert from Poincare ball model to hyperboloid model
-	float factor = 2.0f / (1.0f - s * s * 3.0f);
-
-	std::array<std::array<std::array<float, 3>, 5>, 12> table = {{
-		{{{ 0,  q,  p}, { s,  s,  s}, { q,  p,  0}, {-q,  p,  0}, {-s,  s,  s}}},
-		{{{ 0,  q, -p}, {-s,  s, -s}, {-q,  p,  0}, { q,  p,  0}, { s,  s, -s}}},
-		{{{ 0, -q,  p}, {-s, -s,  s}, {-q, -p,  0}, { q, -p,  0}, { s, -s,  s}}},
-		{{{ 0, -q, -p}, { s, -s, -s}, { q, -p,  0}, {-q, -p,  0}, {-s, -s, -s}}},
-
-		{{{ p,  0,  q}, { s,  s,  s}, { 0,  q,  p}, { 0, -q,  p}, { s, -s,  s}}},
-		{{{-p,  0,  q}, {-s, -s,  s}, { 0, -q,  p}, { 0,  q,  p}, {-s,  s,  s}}},
-		{{{ p,  0, -q}, { s, -s, -s}, { 0, -q, -p}, { 0,  q, -p}, { s,  s, -s}}},
-		{{{-p,  0, -q}, {-s,  s, -s}, { 0,  q, -p}, { 0, -q, -p}, {-s, -s, -s}}},
-
-		{{{ q,  p,  0}, { s,  s,  s}, { p,  0,  q}, { p,  0, -q}, { s,  s, -s}}},
-		{{{ q, -p,  0}, { s, -s, -s}, { p,  0, -q}, { p,  0,  q}, { s, -s,  s}}},
-		{{{-q,  p,  0}, {-s,  s, -s}, {-p,  0, -q}, {-p,  0,  q}, {-s,  s,  s}}},
-		{{{-q, -p,  0}, {-s, -s,  s}, {-p,  0,  q}, {-p,  0, -q}, {-s, -s, -s}}},
-	}};
-
-	ModelBuilder builder;
-
-	for (const auto& face : table) {
-		std::vector<Vector4d> faceVertices;
-
-		for (const auto& faceVertexData : face) {
-			faceVertices.emplace_back(
-				faceVertexData[0] * factor,
-				faceVertexData[1] * factor,
-				faceVertexData[2] * factor,
-				factor - 1.0f
-			);
-		}
-
-		builder.addHyperbolicPolygonFace(faceVertices);
-	}
-
-	builder.addBackFaces();
-
-	return builder.build();
-}
-
-Model makeSphericalTetrahedron() {
-	float s = 1.0f;
-	float cos_s = cosf(s);
-	float sin_s = sinf(s);
-
-	float normalization_factor = sqrtf(1.0f / 3.0f);
-
-	std::array<std::array<std::array<float, 3>, 3>, 4> table = {{
-		{{{ 1,  1,  1}, { 1, -1, -1}, {-1,  1, -1}}},
-		{{{ 1,  1,  1}, {-1,  1, -1}, {-1, -1,  1}}},
-		{{{ 1,  1,  1}, {-1, -1,  1}, { 1, -1, -1}}},
-		{{{-1, -1,  1}, {-1,  1, -1}, { 1, -1, -1}}},
-	}};
-
-	ModelBuilder builder;
-
-	for (const auto& face : table) {
-		std::vector<Vector4d> faceVertices;
-
-		for (const auto& faceVertexData : face) {
-			faceVertices.emplace_back(
-				faceVertexData[0] * normalization_factor * sin_s,
-				faceVertexData[1] * normalization_factor * sin_s,
-				faceVertexData[2] * normalization_factor * sin_s,
-				cos_s
-			);
-		}
-
-		builder.addSphericalPolygonFace(faceVertices);
-	}
-
-	builder.addBackFaces();
-
-	return builder.build();
-}
-
-Model makeHorosphere() {
-	int numSteps = 400;
-	double size = 20;
-	double textureSize = 5;
-
-	ModelBuilder builder;
-
-	Eigen::Array<GLuint, Eigen::Dynamic, Eigen::Dynamic> vertices(numSteps + 1, numSteps + 1);
-
-	for (int i=0; i<=numSteps; ++i) {
-		for (int j=0; j<=numSteps; ++j) {
-			double xPos = (static_cast<double>(i)/numSteps-0.5) * size;
-			double yPos = (static_cast<double>(j)/numSteps-0.5) * size;
-			Matrix4d rotation = VectorMath::horoRotation(xPos, yPos);
-			vertices(i, j) = builder.addVertex(
-				rotation * Vector4d(0, 0, 0, 1),
-				Vector4d(0, 0, 1, -1),
-				Vector2d(xPos * textureSize, yPos * textureSize));
-		}
-	}
-
-	for (int i=0; i<numSteps; ++i) {
-		for (int j=0; j<numSteps; ++j) {
-			builder.addTriangle(vertices(i, j), vertices(i+1, j), vertices(i, j+1));
-			builder.addTriangle(vertices(i, j+1), vertices(i+1, j), vertices(i+1, j+1));
-		}
-	}
-
-	builder.addBackFaces();
-
-	return builder.build();
-}
-
-Model makePlane() {
-	ModelBuilder builder;
-	Tessellation tessellation;
-	tessellation.testTessellation();
-
-	std::array<Vector2d, tessellation.n> texCoords { Vector2d(0, 0), Vector2d(1, 0), Vector2d(0, 1) };
-	Vector4d normal(0, 0, 1, 0);
-
-	for (size_t i=0; i<tessellation.getNumFaces(); ++i) {
-		std::array<GLuint, tessellation.n> vertices;
-
-		for (size_t j=0; j<tessellation.n; ++j) {
-			vertices[j] = builder.addVertex(tessellation.getVertexPos(i, j), normal, texCoords[j]);
-		}
-
-		int orientation = tessellation.getOrientation(i);
-		builder.addTriangle(vertices[0], vertices[(orientation + tessellation.n) % tessellation.n], vertices[(orientation * 2 + tessellation.n) % tessellation.n]);
-	}
-
-	builder.addBackFaces();
-
-	return builder.build();
-}
-
-Model makePrism() {
-	ModelBuilder builder;
-	Matrix4d transform;
-	transform << 1, 0, 0, 0,  0, -1, 0, 0,  0, 0, -1, 0,  0, 0, 0, 1;
-	builder.addPrism(transform, 8, 1, 2, 60);
-
-	builder.addBackFaces();
-
-	return builder.build();
-}
-
-class TreeBuilder {
+class ModelBank {
 public:
-	TreeBuilder(): sideLength(acosh(3)) {
-		Matrix4d translation = VectorMath::hyperbolicDisplacement(Vector4d(0, 0, sideLength, 0));
-
-		recursiveTransformations.push_back(translation);
-		recursiveTransformations.push_back(translation * VectorMath::rotation(Vector3d(1, 0, 0), M_TAU / 4.0));
-		recursiveTransformations.push_back(translation * VectorMath::rotation(Vector3d(0, 1, 0), M_TAU / 4.0));
-		recursiveTransformations.push_back(translation * VectorMath::rotation(Vector3d(-1, 0, 0), M_TAU / 4.0));
-		recursiveTransformations.push_back(translation * VectorMath::rotation(Vector3d(0, -1, 0), M_TAU / 4.0));
+	// Requires a current GL context. The meshes are built on the job system, and only uploaded on the calling thread.
+	explicit ModelBank(JobSystem& jobs) {
+		Mesh dodecahedron, horosphere, plane, prism, tree, sphericalTetrahedron;
+		JobSystem::JobGroup group;
+		jobs.run(group, [&]() { dodecahedron = makeDodecahedron(); });
+		jobs.run(group, [&]() { horosphere = makeHorosphere(jobs); });
+		jobs.run(group, [&]() { plane = makePlane(); });
+		jobs.run(group, [&]() { prism = makePrism(); });
+		jobs.run(group, [&]() { tree = makeTree(jobs); });
+		jobs.run(group, [&]() { sphericalTetrahedron = makeSphericalTetrahedron(); });
+		jobs.wait(group);
+
+		models[ModelHandle::DODECAHEDRON] = std::make_unique<Model>(dodecahedron);
+		models[ModelHandle::HOROSPHERE] = std::make_unique<Model>(horosphere);
+		models[ModelHandle::PLANE] = std::make_unique<Model>(plane);
+		models[ModelHandle::PRISM] = std::make_unique<Model>(prism);
+		models[ModelHandle::TREE] = std::make_unique<Model>(tree);
+
+		models[ModelHandle::SPHERICAL_TETRAHEDRON] = std::make_unique<Model>(sphericalTetrahedron);
 	}
 
-	void buildTree(ModelBuilder& builder, Matrix4d transform, int layers) {
-		buildBranch(builder, transform, layers);
-		buildBranch(builder, transform * VectorMath::rotation(Vector3d(1, 0, 0), M_TAU / 4.0), layers);
-		buildBranch(builder, transform * VectorMath::rotation(Vector3d(0, 1, 0), M_TAU / 4.0), layers);
-		buildBranch(builder, transform * VectorMath::rotation(Vector3d(-1, 0, 0), M_TAU / 4.0), layers);
-		buildBranch(builder, transform * VectorMath::rotation(Vector3d(0, -1, 0), M_TAU / 4.0), layers);
-		buildBranch(builder, transform * VectorMath::rotation(Vector3d(1, 0, 0), M_TAU / 2.0), layers);
+	void render(ModelHandle model) {
+		models.at(model)->render();
 	}
 
-	void buildBranch(ModelBuilder& builder, Matrix4d transform, int layers) {
-		if (transform(3, 3) > 100) {
-			return;
-		}
-
-		builder.addPrism(transform, 8, 0.1, sideLength, 6);
-
-		if (layers != 0) {
-			for (int i = 0; i < recursiveTransformations.size(); ++i) {
-				buildBranch(builder, transform * recursiveTransformations[i], layers - 1);
-			}
-		}
+	std::size_t getTriangleCount(ModelHandle model) const {
+		return models.at(model)->getNumElements() / 3;
 	}
 
-private:
-	std::vector<Matrix4d> recursiveTransformations;
-	double sideLength;
-};
-
-Model makeTree() {
-	ModelBuilder builder;
-
-	TreeBuilder().buildTree(builder, Matrix4d::Identity(), 7);
-
-	return builder.build();
-}
-
-enum class ModelHandle {DODECAHEDRON, HOROSPHERE, PLANE, PRISM, TREE, SPHERICAL_TETRAHEDRON};
-
-class ModelBank {
-public:
-	ModelBank() {
-		models[ModelHandle::DODECAHEDRON] = std::make_unique<Model>(makeDodecahedron());
-		models[ModelHandle::HOROSPHERE] = std::make_unique<Model>(makeHorosphere());
-		models[ModelHandle::PLANE] = std::make_unique<Model>(makePlane());
-		models[ModelHandle::PRISM] = std::make_unique<Model>(makePrism());
-		models[ModelHandle::TREE] = std::make_unique<Model>(makeTree());
+	// How precisely the model-view is applied to the model's vertices
+	TransformPrecision getTransformPrecision(ModelHandle model) const {
+		auto it = transformPrecisions.find(model);
+		return it == transformPrecisions.end() ? TransformPrecision::SINGLE : it->second;
+	}
 
-		models[ModelHandle::SPHERICAL_TETRAHEDRON] = std::make_unique<Model>(makeSphericalTetrahedron());
+	void setTransformPrecision(ModelHandle model, TransformPrecision transformPrecision) {
+		transformPrecisions[model] = transformPrecision;
 	}
 
-	void render(ModelHandle model) {
-		models.at(model)->render();
+	// The horosphere, plane and tree extend far from their origin, so parts of them can be near the camera while their
+	// origin is not, which is where DOUBLE_FLOAT helps. Every model is SINGLE by default, which streams its transforms.
+	void setExtendedModelsTransformPrecision(TransformPrecision transformPrecision) {
+		setTransformPrecision(ModelHandle::HOROSPHERE, transformPrecision);
+		setTransformPrecision(ModelHandle::PLANE, transformPrecision);
+		setTransformPrecision(ModelHandle::TREE, transformPrecision);
 	}
 
 private:
 	std::unordered_map<ModelHandle, std::unique_ptr<Model>> models;
+	std::unordered_map<ModelHandle, TransformPrecision> transformPrecisions;
 };
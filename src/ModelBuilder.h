@@ -16,10 +16,11 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
-#include "glad.h"
 #include "VectorMath.h"
-#include "Model.h"
+#include "VectorMathBatch.h"
+#include "Mesh.h"
 
 using std::vector;
 using std::array;
@@ -28,12 +29,12 @@ class ModelBuilder {
 public:
 	ModelBuilder(): currentVertex(0) {}
 
-	Model build() {
-		return Model(vertices, elements);
+	Mesh build() {
+		return Mesh {vertices, elements};
 	}
 
 	// Primitive functions
-	GLuint addVertex(Vector4d pos, Vector4d normal, Vector2d texCoord) {
+	std::uint32_t addVertex(Vector4d pos, Vector4d normal, Vector2d texCoord) {
 		vertices.emplace_back(
 			std::array<float, 4>{static_cast<float>(pos[0]), static_cast<float>(pos[1]), static_cast<float>(pos[2]), static_cast<float>(pos[3])},
 			std::array<float, 4>{static_cast<float>(normal[0]), static_cast<float>(normal[1]), static_cast<float>(normal[2]), static_cast<float>(normal[3])},
@@ -42,34 +43,21 @@ public:
 		return currentVertex++;
 	}
 
-	void addTriangle(GLuint vertex0, GLuint vertex1, GLuint vertex2) {
+	void addTriangle(std::uint32_t vertex0, std::uint32_t vertex1, std::uint32_t vertex2) {
 		elements.push_back(vertex0);
 		elements.push_back(vertex1);
 		elements.push_back(vertex2);
 	}
 
 	// Enhanced functions
-	void addHyperbolicPolygonFace(std::vector<Vector4d> positions) {
+	// Space is a GeometryPolicy, such as HyperbolicGeometry
+	template<typename Space>
+	void addPolygonFace(std::vector<Vector4d> positions) {
 		auto n = positions.size();
 
-		Vector4d normal = VectorMath::hyperbolicNormal(positions[0], positions[n / 3], positions[(n * 2) / 3]);
+		Vector4d normal = Space::normal(positions[0], positions[n / 3], positions[(n * 2) / 3]);
 
-		std::vector<GLuint> vertices;
-		for (int i = 0; i < n; ++i) {
-			vertices.push_back(addVertex(positions[i], normal, Vector2d(0.5 + 0.5 * cos(i * M_TAU / n), 0.5 + 0.5 * sin(i * M_TAU / n))));
-		}
-
-		for (decltype(n) i = 1; i < n - 1; ++i) {
-			addTriangle(vertices[0], vertices[i], vertices[i+1]);
-		}
-	}
-
-	void addSphericalPolygonFace(std::vector<Vector4d> positions) {
-		auto n = positions.size();
-
-		Vector4d normal = VectorMath::sphericalNormal(positions[0], positions[n / 3], positions[(n * 2) / 3]);
-
-		std::vector<GLuint> vertices;
+		std::vector<std::uint32_t> vertices;
 		for (int i = 0; i < n; ++i) {
 			vertices.push_back(addVertex(positions[i], normal, Vector2d(0.5 + 0.5 * cos(i * M_TAU / n), 0.5 + 0.5 * sin(i * M_TAU / n))));
 		}
@@ -84,7 +72,18 @@ public:
 		double sinhRadius = sinh(radius);
 		double coshRadius = cosh(radius);
 
-		vector<vector<array<GLuint, 2>>> prism;
+		// The transforms along the prism are shared by every side
+		Vector4dBatch stepDisplacements(steps + 1);
+		for (int step = 0; step <= steps; ++step) {
+			stepDisplacements.set(step, Vector4d(0, 0, length * step / steps, 0));
+		}
+		Matrix4dBatch stepTransforms;
+		VectorMathBatch::hyperbolicDisplacement(stepDisplacements, stepTransforms);
+		VectorMathBatch::multiply(transform, stepTransforms, stepTransforms);
+
+		vector<vector<array<std::uint32_t, 2>>> prism;
+		array<Vector4dBatch, 2> stepPositions;
+		Vector4dBatch stepNormals;
 		for (int side = 0; side < sides; ++side) {
 			prism.emplace_back();
 			auto& prismSide = prism.back();
@@ -98,12 +97,16 @@ public:
 			Vector4d baseNormal = VectorMath::hyperbolicNormal(basePos[0], basePos[1], VectorMath::hyperbolicTranslation(basePos[0]) * Vector4d(0, 0, 1, sqrt(2)));
 			baseNormal /= sqrt(VectorMath::hyperbolicSqrNorm(baseNormal));
 
+			for (int k=0; k<2; k++) {
+				VectorMathBatch::transform(stepTransforms, basePos[k], stepPositions[k]);
+			}
+			VectorMathBatch::transform(stepTransforms, baseNormal, stepNormals);
+
 			for (int step = 0; step <= steps; ++step) {
 				prismSide.emplace_back();
 				auto& prismSection = prismSide.back();
-				Matrix4d stepTransform = transform * VectorMath::hyperbolicDisplacement(Vector4d(0, 0, length * step / steps, 0));
 				for (int k=0; k<2; k++) {
-					prismSection[k] = addVertex(stepTransform * basePos[k], stepTransform * baseNormal, Vector2d((double)step / steps, (double)(side + k) / sides));
+					prismSection[k] = addVertex(stepPositions[k].get(step), stepNormals.get(step), Vector2d((double)step / steps, (double)(side + k) / sides));
 				}
 			}
 		}
@@ -117,6 +120,28 @@ public:
 		}
 	}
 
+	std::size_t getVertexCount() const {
+		return vertices.size();
+	}
+
+	std::size_t getElementCount() const {
+		return elements.size();
+	}
+
+	void reserve(std::size_t vertexCount, std::size_t elementCount) {
+		vertices.reserve(vertexCount);
+		elements.reserve(elementCount);
+	}
+
+	// Adds everything in a fragment built separately, such as on another thread, as if it had been added to this builder
+	void append(const ModelBuilder& fragment) {
+		vertices.insert(vertices.end(), fragment.vertices.begin(), fragment.vertices.end());
+		for (std::uint32_t element : fragment.elements) {
+			elements.push_back(element + currentVertex);
+		}
+		currentVertex += fragment.currentVertex;
+	}
+
 	void addBackFaces() {
 		int numExistingVertices = vertices.size();
 		for (int i = 0; i < numExistingVertices; ++i) {
@@ -132,7 +157,7 @@ public:
 	}
 
 private:
-	GLuint currentVertex;
+	std::uint32_t currentVertex;
 	std::vector<Vertex> vertices;
-	std::vector<GLuint> elements;
+	std::vector<std::uint32_t> elements;
 };
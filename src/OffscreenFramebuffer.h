@@ -0,0 +1,87 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+
+#include "glad.h"
+#include <array>
+#include <stdexcept>
+#include "TextureData.h"
+
+// A framebuffer object with sRGB color and depth, used as the render target when there is no window
+class OffscreenFramebuffer {
+public:
+	// Requires a current GL context
+	OffscreenFramebuffer(int width, int height): width(width), height(height) {
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+		glGenRenderbuffers(2, renderbuffers.data());
+		glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_SRGB8_ALPHA8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+		glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			glDeleteRenderbuffers(2, renderbuffers.data());
+			glDeleteFramebuffers(1, &framebuffer);
+			throw std::runtime_error("Offscreen framebuffer is incomplete");
+		}
+	}
+
+	~OffscreenFramebuffer() {
+		glDeleteRenderbuffers(2, renderbuffers.data());
+		glDeleteFramebuffers(1, &framebuffer);
+	}
+
+	OffscreenFramebuffer(const OffscreenFramebuffer&) = delete;
+	OffscreenFramebuffer& operator=(const OffscreenFramebuffer&) = delete;
+
+	void bind() {
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glViewport(0, 0, width, height);
+	}
+
+	int getWidth() const {
+		return width;
+	}
+
+	int getHeight() const {
+		return height;
+	}
+
+	// Reads the color buffer, with the top row first
+	TextureData readPixels() {
+		TextureData result(width, height);
+		std::vector<unsigned char> flipped(static_cast<std::size_t>(width) * height * 3);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, flipped.data());
+
+		std::size_t rowSize = static_cast<std::size_t>(width) * 3;
+		for (int y = height - 1; y >= 0; --y) {
+			result.data.insert(result.data.end(), flipped.begin() + y * rowSize, flipped.begin() + (y + 1) * rowSize);
+		}
+		return result;
+	}
+
+private:
+	GLuint framebuffer = 0;
+	std::array<GLuint, 2> renderbuffers {{0, 0}}; // color, depth
+	int width, height;
+};
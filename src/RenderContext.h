@@ -20,15 +20,34 @@
 #include "VectorMath.h"
 #include "ShaderProgramBank.h"
 #include "ModelBank.h"
+#include "UniformBuffers.h"
+#include "Scene.h"
+#include "RenderSnapshot.h"
+#include "DrawList.h"
 
 class Model;
 
+// Counts of the work submitted between beginFrame and endFrame
+class FrameStatistics {
+public:
+	std::size_t drawCalls = 0;
+	std::size_t triangles = 0;
+	std::size_t culledNodes = 0;
+};
+
 class RenderContext {
 public:
+	// Requires a current GL context
 	RenderContext(ShaderProgramBank &shaderProgramBank, ModelBank &modelBank, TextureBank &textureBank) :
 		shaderProgramBank(shaderProgramBank),
 		modelBank(modelBank),
-		textureBank(textureBank) {}
+		textureBank(textureBank),
+		frameUniformBuffer(std::make_unique<FrameUniformBuffer>()) {
+		if (TransformStream::isSupported()) {
+			transformStream = std::make_unique<TransformStream>();
+			shaderProgramKey.streamedTransforms = true;
+		}
+	}
 
 	RenderContext(const RenderContext&) = delete;
 	RenderContext& operator=(const RenderContext&) = delete;
@@ -77,48 +96,139 @@ public:
 		textureBank.bind(texture);
 	}
 
-	void setSpherical(bool spherical) {
-		this->spherical = spherical;
-		shaderProgramHandle = spherical ? ShaderProgramHandle::SPHERICAL : ShaderProgramHandle::HYPERBOLIC;
+	// Space is a GeometryPolicy, such as HyperbolicGeometry, and should match the camera's
+	template<typename Space>
+	void setGeometry() {
+		shaderProgramKey.geometry = Space::curvature < 0 ? Geometry::HYPERBOLIC : Geometry::SPHERICAL;
+		shaderProgramInvalidated = true;
+	}
+
+	// Forces the shader program to be looked up again, such as after the shader program bank reloads its programs
+	void invalidateShaderProgram() {
 		shaderProgramInvalidated = true;
 	}
 
+	void setLightingModel(LightingModel lightingModel) {
+		shaderProgramKey.lightingModel = lightingModel;
+		shaderProgramInvalidated = true;
+	}
+
+	// Every frame's draw calls must be surrounded by beginFrame and endFrame
+	void beginFrame() {
+		frameStatistics = FrameStatistics();
+		if (transformStream) {
+			transformStream->beginFrame();
+		}
+	}
+
+	void endFrame() {
+		if (transformStream) {
+			transformStream->endFrame();
+		}
+	}
+
 	void render(ModelHandle model) {
+		setTransformPrecision(modelBank.getTransformPrecision(model));
 		setUniforms();
 		modelBank.render(model);
+		++frameStatistics.drawCalls;
+		frameStatistics.triangles += modelBank.getTriangleCount(model);
+	}
+
+	const FrameStatistics& getFrameStatistics() const {
+		return frameStatistics;
+	}
+
+	// Draws the scene as it is now, on the calling thread
+	template<typename Space>
+	void renderScene(const Scene<Space>& scene) {
+		scene.makeSnapshot(sceneSnapshot);
+		renderSnapshot<Space>(sceneSnapshot);
+	}
+
+	// Space is a GeometryPolicy, such as HyperbolicGeometry, and should match the one given to setGeometry
+	template<typename Space>
+	void renderSnapshot(const RenderSnapshot& snapshot) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		if (!snapshot.hasCamera) {
+			return; // No camera, no picture
+		}
+
+		beginFrame();
+
+		double ratio = (double)width / (double)height;
+		double zoom = snapshot.cameraZoom;
+		setProjection(VectorMath::perspective(ratio * zoom, zoom, 0.01, 10));
+
+		drawList.build<Space>(snapshot, ratio * zoom, zoom);
+		frameStatistics.culledNodes = drawList.getCulledCount();
+
+		// The draw list is sorted by texture within each model, so a texture is only bound when it changes
+		bool textureBound = false;
+		TextureHandle boundTexture = TextureHandle::BLANK;
+		for (std::uint32_t index : drawList.getIndices()) {
+			const RenderSnapshotNode& node = snapshot.nodes[index];
+			setModelView(snapshot.view * node.transform);
+			if (!textureBound || node.texture != boundTexture) {
+				setTexture(node.texture);
+				boundTexture = node.texture;
+				textureBound = true;
+			}
+			render(node.model);
+		}
+
+		endFrame();
 	}
 
 private:
 	Matrix4d projection = Matrix4d::Identity();
 	Matrix4d modelView = Matrix4d::Identity();
 	ShaderProgramBank& shaderProgramBank;
-	ShaderProgramHandle shaderProgramHandle = ShaderProgramHandle::HYPERBOLIC;
+	ShaderProgramKey shaderProgramKey;
+	ShaderProgram* shaderProgram = nullptr;
 	ModelBank& modelBank;
 	TextureBank& textureBank;
+	std::unique_ptr<FrameUniformBuffer> frameUniformBuffer;
+	std::unique_ptr<TransformStream> transformStream; // Null if persistent mapping is unsupported
+	FrameStatistics frameStatistics;
+	RenderSnapshot sceneSnapshot; // Reused by renderScene
+	DrawList drawList;
 	int width = 1;
 	int height = 1;
 	bool shaderProgramInvalidated = true;
 	bool projectionInvalidated = true;
 	bool modelViewInvalidated = true;
-	bool spherical = false;
 
-	void setUniforms() {
-		ShaderProgram& shaderProgram = shaderProgramBank.get(shaderProgramHandle);
+	void setTransformPrecision(TransformPrecision transformPrecision) {
+		if (shaderProgramKey.transformPrecision != transformPrecision) {
+			shaderProgramKey.transformPrecision = transformPrecision;
+			shaderProgramInvalidated = true;
+		}
+	}
 
+	void setUniforms() {
 		if (shaderProgramInvalidated) {
-			shaderProgram.use();
-			projectionInvalidated = true;
+			shaderProgram = &shaderProgramBank.get(shaderProgramKey);
+			shaderProgram->use();
+			shaderProgramInvalidated = false;
 			modelViewInvalidated = true;
 		}
 
 		if (projectionInvalidated) {
-			shaderProgram.setProjection(projection.cast<float>());
+			frameUniformBuffer->setProjection(projection.cast<float>());
 			projectionInvalidated = false;
 		}
 
 		if (modelViewInvalidated) {
-			shaderProgram.setModelView(modelView.cast<float>());
-			shaderProgram.setLightPos(((spherical ? modelView.transpose() : VectorMath::hyperbolicTranspose(modelView)) * Vector4d(0, 0, 0, 1)).cast<float>());
+			if (shaderProgramKey.transformPrecision == TransformPrecision::DOUBLE_FLOAT) {
+				Eigen::Matrix4f modelViewHi = modelView.cast<float>();
+				Eigen::Matrix4f modelViewLo = (modelView - modelViewHi.cast<double>()).cast<float>();
+				shaderProgram->setModelView(modelViewHi, modelViewLo);
+			} else if (transformStream) {
+				shaderProgram->setDrawIndex(transformStream->push(modelView.cast<float>()));
+			} else {
+				shaderProgram->setModelView(modelView.cast<float>());
+			}
 			modelViewInvalidated = false;
 		}
 	}
@@ -0,0 +1,43 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+
+// Names for the models in ModelBank and the textures in TextureBank, kept apart from the banks so that code without a GL
+// context, such as the simulation, can refer to them
+enum class ModelHandle {DODECAHEDRON, HOROSPHERE, PLANE, PRISM, TREE, SPHERICAL_TETRAHEDRON};
+
+enum class TextureHandle {PERLIN, TILE, BLANK};
+
+// The radius of a ball around the model's origin that contains all of it, measured from the generated meshes. The
+// spherical tetrahedron's is a spherical distance.
+inline double getBoundingRadius(ModelHandle model) {
+	switch (model) {
+	case ModelHandle::DODECAHEDRON:
+		return 1.23;
+	case ModelHandle::HOROSPHERE:
+		return 5.31;
+	case ModelHandle::PLANE:
+		return 5.53;
+	case ModelHandle::PRISM:
+		return 2.45;
+	case ModelHandle::TREE:
+		return 7.06;
+	case ModelHandle::SPHERICAL_TETRAHEDRON:
+		return 1.0;
+	}
+	return 0;
+}
@@ -0,0 +1,223 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "VectorMath.h"
+#include "Anchor.h"
+#include "RenderHandles.h"
+#include "RenderSnapshot.h"
+#include "SlotMap.h"
+#include "ComponentPool.h"
+
+// Constant velocity and angular velocity in a render node's own frame
+class Motion {
+public:
+	Vector3d velocity = Vector3d::Zero(); // Distance per second
+	Vector3d angularVelocity = Vector3d::Zero(); // Radians per second about the axis it points along
+
+	// The generator of the motion, so that after dt seconds the node's transform is multiplied by exp(dt * generator).
+	// Space is a GeometryPolicy, such as HyperbolicGeometry.
+	template<typename Space>
+	Matrix4d getGenerator() const {
+		const Vector3d& v = velocity;
+		const Vector3d& w = angularVelocity;
+		Matrix4d result;
+		result << 0, -w.z(), w.y(), v.x(),
+			w.z(), 0, -w.x(), v.y(),
+			-w.y(), w.x(), 0, v.z(),
+			-Space::curvature * v.x(), -Space::curvature * v.y(), -Space::curvature * v.z(), 0;
+		return result;
+	}
+};
+
+// The scene's render nodes, each a model and texture drawn at a transform relative to an anchor. Every field is kept in
+// its own densely packed array, so building a snapshot is one linear pass over them, and adding or removing a node
+// takes constant time. Components that only some nodes have, such as motion, are kept in a ComponentPool instead. Each
+// node holds its anchor, so the anchor tree keeps it.
+class RenderNodeStore {
+public:
+	// The transform is relative to the anchor
+	SlotHandle add(const Anchor& anchor, const Matrix4d& transform, ModelHandle model, TextureHandle texture) {
+		SlotHandle handle = slots.add();
+		anchor.hold();
+		anchors.push_back(&anchor);
+		transforms.push_back(transform);
+		models.push_back(model);
+		textures.push_back(texture);
+		boundingRadii.push_back(::getBoundingRadius(model));
+		return handle;
+	}
+
+	// Adds a node at each transform, all with the same anchor, model and texture, and appends their handles. Every
+	// array grows at most once for the whole batch, and nodes removed earlier leave their space and slots behind to be
+	// reused, so spawning a batch like one that was despawned allocates nothing.
+	void addAll(const Anchor& anchor, const std::vector<Matrix4d>& transforms, ModelHandle model, TextureHandle texture,
+			std::vector<SlotHandle>& handles) {
+		std::size_t size = slots.getSize() + transforms.size();
+		if (size > this->transforms.capacity()) {
+			reserve(std::max(size, 2 * this->transforms.capacity()));
+		}
+		handles.reserve(handles.size() + transforms.size());
+
+		double boundingRadius = ::getBoundingRadius(model);
+		for (std::size_t i = 0; i < transforms.size(); ++i) {
+			handles.push_back(slots.add());
+			anchor.hold();
+		}
+		anchors.insert(anchors.end(), transforms.size(), &anchor);
+		this->transforms.insert(this->transforms.end(), transforms.begin(), transforms.end());
+		models.insert(models.end(), transforms.size(), model);
+		textures.insert(textures.end(), transforms.size(), texture);
+		boundingRadii.insert(boundingRadii.end(), transforms.size(), boundingRadius);
+	}
+
+	// Throws std::runtime_error if the node was already removed
+	void remove(SlotHandle handle) {
+		motions.remove(handle);
+		std::size_t index = slots.remove(handle);
+		std::size_t last = slots.getSize();
+		anchors[index]->release();
+		if (index != last) {
+			anchors[index] = anchors[last];
+			transforms[index] = transforms[last];
+			models[index] = models[last];
+			textures[index] = textures[last];
+			boundingRadii[index] = boundingRadii[last];
+		}
+		anchors.pop_back();
+		transforms.pop_back();
+		models.pop_back();
+		textures.pop_back();
+		boundingRadii.pop_back();
+	}
+
+	// Throws std::runtime_error if any node was already removed, after removing the ones before it
+	void removeAll(const std::vector<SlotHandle>& handles) {
+		for (SlotHandle handle : handles) {
+			remove(handle);
+		}
+	}
+
+	bool contains(SlotHandle handle) const {
+		return slots.contains(handle);
+	}
+
+	// The transform is relative to the anchor
+	void setTransform(SlotHandle handle, const Anchor& anchor, const Matrix4d& transform) {
+		std::size_t index = slots.getDenseIndex(handle);
+		anchor.hold();
+		anchors[index]->release();
+		anchors[index] = &anchor;
+		transforms[index] = transform;
+	}
+
+	std::size_t getSize() const {
+		return slots.getSize();
+	}
+
+	void reserve(std::size_t size) {
+		slots.reserve(size);
+		motions.reserve(size);
+		anchors.reserve(size);
+		transforms.reserve(size);
+		models.reserve(size);
+		textures.reserve(size);
+		boundingRadii.reserve(size);
+	}
+
+	// Gives the node a motion, replacing any it had. Throws std::runtime_error if the node was removed.
+	void setMotion(SlotHandle handle, const Motion& motion) {
+		slots.getDenseIndex(handle);
+		int stepsSinceCorrection = static_cast<int>(motions.getSize() % driftCorrectionInterval);
+		motions.set(handle, MovingNode {motion, Matrix4d::Zero(), Matrix4d::Identity(), 0, stepsSinceCorrection});
+	}
+
+	// Stops the node where it is
+	void clearMotion(SlotHandle handle) {
+		motions.remove(handle);
+	}
+
+	std::size_t getMovingCount() const {
+		return motions.getSize();
+	}
+
+	// Moves every node with a motion forward by dt seconds, in one pass over the moving nodes. A node's step is
+	// exp(dt * generator), which only depends on dt, which a fixed timestep keeps the same, so it is computed once
+	// rather than every tick. Snapshots carry the generator, so that they can be interpolated exactly. Multiplying
+	// by an isometry adds only rounding error, so each node's drift is corrected every driftCorrectionInterval steps,
+	// with the nodes staggered so that the cost is spread over the ticks. Space is a GeometryPolicy, such as
+	// HyperbolicGeometry.
+	template<typename Space>
+	void integrate(double dt) {
+		for (std::size_t i = 0; i < motions.getSize(); ++i) {
+			MovingNode& moving = motions[i];
+			if (moving.stepInterval != dt) {
+				moving.generator = moving.motion.template getGenerator<Space>();
+				moving.step = Space::exp(dt * moving.generator);
+				moving.stepInterval = dt;
+			}
+
+			Matrix4d& transform = transforms[slots.getDenseIndex(motions.getOwner(i))];
+			transform = transform * moving.step;
+			if (++moving.stepsSinceCorrection == driftCorrectionInterval) {
+				transform = Space::correctDrift(transform);
+				moving.stepsSinceCorrection = 0;
+			}
+		}
+	}
+
+	static constexpr int driftCorrectionInterval = 16;
+
+	// A ball around the node's origin that contains the whole model
+	double getBoundingRadius(SlotHandle handle) const {
+		return boundingRadii[slots.getDenseIndex(handle)];
+	}
+
+	// Adds every node to the snapshot, with its transform relative to the origin anchor, and the motion of every node
+	// that has one
+	void addToSnapshot(RenderSnapshot& snapshot) const {
+		std::size_t first = snapshot.nodes.size();
+		for (std::size_t i = 0; i < slots.getSize(); ++i) {
+			snapshot.nodes.push_back(RenderSnapshotNode {
+				slots.getHandle(i).getId(), anchors[i]->getRelativeTransform() * transforms[i], models[i], textures[i],
+				boundingRadii[i]});
+		}
+		for (std::size_t i = 0; i < motions.getSize(); ++i) {
+			std::size_t index = first + slots.getDenseIndex(motions.getOwner(i));
+			snapshot.motions.push_back(RenderSnapshotMotion {static_cast<std::uint32_t>(index), motions[i].generator});
+		}
+	}
+
+private:
+	class MovingNode {
+	public:
+		Motion motion;
+		Matrix4d generator; // Of the motion, computed along with the step
+		Matrix4d step; // The node's transform is multiplied by this every stepInterval seconds
+		double stepInterval;
+		int stepsSinceCorrection;
+	};
+
+	SlotMap slots;
+	std::vector<const Anchor*> anchors;
+	std::vector<Matrix4d> transforms;
+	std::vector<ModelHandle> models;
+	std::vector<TextureHandle> textures;
+	std::vector<double> boundingRadii;
+	ComponentPool<MovingNode> motions;
+};
@@ -0,0 +1,184 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "VectorMath.h"
+#include "RenderHandles.h"
+#include "FixedTimestep.h"
+
+// One draw in a snapshot. The transform is relative to the origin anchor, and the renderer composes it with the
+// snapshot's view, so a node that does not move keeps the same transform from snapshot to snapshot.
+class RenderSnapshotNode {
+public:
+	std::uint64_t id; // Identifies the render node across snapshots
+	Matrix4d transform;
+	ModelHandle model;
+	TextureHandle texture;
+	double boundingRadius; // Of a ball around the model's origin that contains all of it
+};
+
+// A node whose transform changes from tick to tick. After dt more seconds, its transform is multiplied by
+// exp(dt * generator).
+class RenderSnapshotMotion {
+public:
+	std::uint32_t index; // Into the snapshot's nodes
+	Matrix4d generator; // Per second, in the node's own frame
+};
+
+// Everything the renderer needs to draw the scene as it was after one simulation tick, copied so that the simulation can
+// move on while the frame is drawn
+class RenderSnapshot {
+public:
+	std::uint64_t tick = 0;
+	double time = 0; // Seconds on the simulation's clock
+	bool hasCamera = false;
+	double cameraZoom = 1;
+	Matrix4d view = Matrix4d::Identity(); // Maps from the origin anchor's frame to the camera's
+	std::vector<RenderSnapshotNode> nodes; // In the dense order of the scene's render nodes
+	std::vector<RenderSnapshotMotion> motions;
+	TimestepStatistics timestep; // How well the simulation kept up with real time, as of this snapshot
+
+	// The frame of every transform changes with the origin anchor. If originChanges is one more than in an earlier
+	// snapshot, these map between that snapshot's frame and this one's.
+	std::uint64_t originChanges = 0;
+	Matrix4d fromPreviousOrigin = Matrix4d::Identity();
+	Matrix4d toPreviousOrigin = Matrix4d::Identity();
+};
+
+// Keeps the last two snapshots and draws the scene between them, so the picture moves smoothly even when frames and
+// ticks do not line up. The camera's view follows the geodesic between its two values, and a moving node follows its
+// motion, whose generator each snapshot carries. Both are one-parameter groups set up once per snapshot, so each frame
+// evaluates exp(t * X) from cached powers of X and lands exactly on the simulation's transforms. Nodes that do not move
+// are drawn as they are. Space is a GeometryPolicy, such as HyperbolicGeometry, and should match the scene's.
+template<typename Space>
+class SnapshotInterpolator {
+public:
+	// Call with every new snapshot, in order
+	void add(const RenderSnapshot& snapshot) {
+		std::swap(previous, current);
+		current = snapshot; // Copying into the old snapshot reuses its allocation
+		++snapshotCount;
+		prepareInterpolation();
+
+		if (interpolating) {
+			result.tick = current.tick;
+			result.timestep = current.timestep;
+			result.hasCamera = current.hasCamera;
+			result.originChanges = current.originChanges;
+			result.nodes = current.nodes; // Only the moving nodes change from frame to frame
+			result.motions = current.motions;
+		}
+	}
+
+	const RenderSnapshot& getLatest() const {
+		return current;
+	}
+
+	// The scene at the given time on the simulation's clock, clamped to the span between the last two snapshots
+	const RenderSnapshot& interpolate(double time) {
+		if (!interpolating) {
+			return current;
+		}
+
+		double t = std::min(std::max((time - previous.time) / (current.time - previous.time), 0.0), 1.0);
+		result.time = previous.time + t * (current.time - previous.time);
+		result.cameraZoom = previous.cameraZoom + t * (current.cameraZoom - previous.cameraZoom);
+		result.view = viewFrom * viewPath.at(t);
+		for (const MovingNode& node : movingNodes) {
+			result.nodes[node.index].transform = node.from * node.path.at(t);
+		}
+		return result;
+	}
+
+private:
+	using OneParameterGroup = typename Space::OneParameterGroup;
+
+	class MovingNode {
+	public:
+		std::size_t index; // Into the nodes of the current snapshot
+		Matrix4d from;
+		OneParameterGroup path; // From the previous snapshot's transform to the current one's, relative to from
+	};
+
+	RenderSnapshot previous;
+	RenderSnapshot current;
+	RenderSnapshot result;
+	std::size_t snapshotCount = 0;
+	bool interpolating = false;
+	Matrix4d viewFrom = Matrix4d::Identity();
+	OneParameterGroup viewPath;
+	std::vector<MovingNode> movingNodes;
+	std::vector<std::uint32_t> previousIndices; // By slot index, where each node is in the previous snapshot
+	static constexpr std::uint32_t noIndex = std::numeric_limits<std::uint32_t>::max();
+
+	// How far, relative to the transform's size, a motion may miss the current transform before the node is drawn where
+	// it is now instead. Only rounding and drift correction separate them when the motion ran for the whole span.
+	static constexpr double endpointTolerance = 1e-9;
+
+	void prepareInterpolation() {
+		movingNodes.clear();
+
+		// Across one change of origin, the previous snapshot is brought into the current one's frame. Across more, which
+		// takes several changes within a single frame, the frames can't be matched, so the frame is drawn as it is now.
+		bool originChanged = current.originChanges == previous.originChanges + 1;
+		interpolating = snapshotCount >= 2 && current.time > previous.time && current.hasCamera && previous.hasCamera
+			&& (originChanged || current.originChanges == previous.originChanges);
+		if (!interpolating) {
+			return;
+		}
+
+		viewFrom = originChanged ? previous.view * current.toPreviousOrigin : previous.view;
+		viewPath = OneParameterGroup(Space::log(Space::transpose(viewFrom) * current.view));
+
+		// Removing a render node moves the last one into its place, so nodes are matched by id rather than by index. The
+		// low half of an id is the node's slot index (see SlotHandle::getId), which indexes the previous snapshot's
+		// nodes. A node that was just added is drawn where it is now.
+		std::uint32_t unmatched = noIndex;
+		previousIndices.clear();
+		for (std::size_t i = 0; i < previous.nodes.size(); ++i) {
+			std::uint32_t slot = static_cast<std::uint32_t>(previous.nodes[i].id);
+			if (slot >= previousIndices.size()) {
+				previousIndices.resize(slot + 1, unmatched);
+			}
+			previousIndices[slot] = static_cast<std::uint32_t>(i);
+		}
+
+		// A motion that was set or changed between the snapshots does not lead from the previous transform to the current
+		// one, so a node whose motion misses is drawn where it is now
+		double span = current.time - previous.time;
+		for (const RenderSnapshotMotion& motion : current.motions) {
+			const RenderSnapshotNode& to = current.nodes[motion.index];
+			std::uint32_t slot = static_cast<std::uint32_t>(to.id);
+			if (slot >= previousIndices.size() || previousIndices[slot] == noIndex
+					|| previous.nodes[previousIndices[slot]].id != to.id) {
+				continue;
+			}
+
+			const Matrix4d& previousTransform = previous.nodes[previousIndices[slot]].transform;
+			Matrix4d from = originChanged ? current.fromPreviousOrigin * previousTransform : previousTransform;
+			OneParameterGroup path(span * motion.generator);
+			double miss = (from * path.at(1) - to.transform).template lpNorm<Eigen::Infinity>();
+			if (miss <= endpointTolerance * to.transform.template lpNorm<Eigen::Infinity>()) {
+				movingNodes.push_back(MovingNode {motion.index, from, path});
+			}
+		}
+	}
+};
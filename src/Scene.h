@@ -15,23 +15,38 @@
  */
 
 #pragma once
-#include <unordered_set>
+#include <vector>
 #include <memory>
-#include "RenderNode.h"
-#include "GhostCamera.h"
-#include "RenderContext.h"
+#include "RenderNodeStore.h"
+#include "RenderSnapshot.h"
+#include "SlotMap.h"
+#include "Entity.h"
+#include "Camera.h"
+#include "Anchor.h"
 
+// Space is a GeometryPolicy, such as HyperbolicGeometry, and should match the camera's
+template<typename Space>
 class Scene {
 public:
-	void addRenderNode(RenderNode& renderNode) {
-		renderNodes.insert(&renderNode);
+	SlotHandle addEntity(Entity& entity) {
+		SlotHandle handle = entitySlots.add();
+		entities.push_back(&entity);
+		return handle;
 	}
 
-	void addEntity(Entity& entity) {
-		entities.insert(&entity);
+	// Throws std::runtime_error if the entity was already removed. Removing moves the last entity into its place, so
+	// an entity must not be removed while the scene is stepping.
+	void removeEntity(SlotHandle handle) {
+		std::size_t index = entitySlots.remove(handle);
+		entities[index] = entities.back();
+		entities.pop_back();
 	}
 
-	void setCamera(GhostCamera& camera) {
+	AnchorTree& getAnchors() {
+		return anchors;
+	}
+
+	void setCamera(Camera& camera) {
 		this->camera = &camera;
 	}
 
@@ -39,28 +54,46 @@ public:
 		for (Entity* entity : entities) {
 			entity->step(dt, userInput);
 		}
+		renderNodes.integrate<Space>(dt);
 	}
 
-	void render(RenderContext& context) {
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		if (camera == nullptr) {
-			return; // No camera, no picture
-		}
+	Camera* getCamera() const {
+		return camera;
+	}
 
-		double ratio = (double)context.getWidth() / (double)context.getHeight();
-		double zoom = camera->getCameraZoom();
-		context.setProjection(VectorMath::perspective(ratio * zoom, zoom, 0.01, 10));
+	RenderNodeStore& getRenderNodes() {
+		return renderNodes;
+	}
 
-		context.resetModelView();
-		context.addModelView(camera->getCameraTransform());
+	const RenderNodeStore& getRenderNodes() const {
+		return renderNodes;
+	}
 
-		for (RenderNode* renderNode : renderNodes) {
-			renderNode->render(context);
+	// Replaces the snapshot's contents with the scene as it is now, keeping the snapshot's allocations
+	void makeSnapshot(RenderSnapshot& snapshot) const {
+		snapshot.nodes.clear();
+		snapshot.motions.clear();
+		snapshot.hasCamera = camera != nullptr;
+		if (camera == nullptr) {
+			return;
 		}
+
+		// Render nodes add their anchor's transform relative to the origin, which is the camera's anchor, so nothing
+		// near the camera is composed with anything large
+		snapshot.cameraZoom = camera->getCameraZoom();
+		snapshot.view = camera->getCameraTransform();
+		snapshot.originChanges = anchors.getOriginChanges();
+		snapshot.fromPreviousOrigin = anchors.getFromPreviousOrigin();
+		snapshot.toPreviousOrigin = anchors.getToPreviousOrigin();
+		renderNodes.addToSnapshot(snapshot);
 	}
 
 private:
-	std::unordered_set<Entity*> entities;
-	std::unordered_set<RenderNode*> renderNodes;
-	GhostCamera* camera = nullptr;
+	AnchorTree anchors;
+	// Entities are stepped in dense order, which only depends on the order of adds and removes, so replayed input steps
+	// them in the same order every run
+	SlotMap entitySlots;
+	std::vector<Entity*> entities;
+	RenderNodeStore renderNodes;
+	Camera* camera = nullptr;
 };
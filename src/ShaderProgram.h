@@ -16,22 +16,25 @@
 
 #pragma once
 #include "glad.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
 #include "VectorMath.h"
 #include "Model.h"
 #include "ShaderProgramData.h"
+#include "UniformBuffers.h"
 
 class ShaderProgram {
 public:
 	ShaderProgram(const ShaderProgramData& data) {
-		GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		const char *vertexShaderText = data.vertexShaderText.c_str();
-		glShaderSource(vertexShader, 1, &vertexShaderText, NULL);
-		glCompileShader(vertexShader);
-
-		GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-		const char* fragmentShaderText = data.fragmentShaderText.c_str();
-		glShaderSource(fragmentShader, 1, &fragmentShaderText, NULL);
-		glCompileShader(fragmentShader);
+		GLuint vertexShader = compileShader(GL_VERTEX_SHADER, data.vertexShaderText);
+		GLuint fragmentShader;
+		try {
+			fragmentShader = compileShader(GL_FRAGMENT_SHADER, data.fragmentShaderText);
+		} catch (const std::runtime_error&) {
+			glDeleteShader(vertexShader);
+			throw;
+		}
 
 		shaderProgramRef = glCreateProgram();
 		glAttachShader(shaderProgramRef, vertexShader);
@@ -41,6 +44,10 @@ public:
 		glBindAttribLocation(shaderProgramRef, Model::vNormalLocation, "vNormal");
 		glBindAttribLocation(shaderProgramRef, Model::vTexCoordLocation, "vTexCoord");
 
+		if (GLAD_GL_ARB_get_program_binary) {
+			glProgramParameteri(shaderProgramRef, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
 		glLinkProgram(shaderProgramRef);
 
 		glDetachShader(shaderProgramRef, vertexShader);
@@ -48,36 +55,51 @@ public:
 		glDeleteShader(vertexShader);
 		glDeleteShader(fragmentShader);
 
-		GLint isLinked = 0;
-		glGetProgramiv(shaderProgramRef, GL_LINK_STATUS, &isLinked);
-		if (!isLinked) {
-			glDeleteProgram(shaderProgramRef);
-			throw std::runtime_error("Shader Compile/Link Error");
-		}
+		checkLinkStatus();
+		initUniforms();
+	}
 
-		projectionLocation = glGetUniformLocation(shaderProgramRef, "projection");
-		modelViewLocation = glGetUniformLocation(shaderProgramRef, "modelView");
-		lightPosLocation = glGetUniformLocation(shaderProgramRef, "light");
+	// Restores a program previously retrieved with getBinary. Drivers are free to reject binaries (for instance, after
+	// an update), in which case a runtime_error is thrown and the program must be compiled from source instead.
+	ShaderProgram(const ShaderProgramBinary& binary) {
+		shaderProgramRef = glCreateProgram();
+		glProgramBinary(shaderProgramRef, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+
+		checkLinkStatus();
+		initUniforms();
 	}
 
 	~ShaderProgram() {
 		glDeleteProgram(shaderProgramRef);
 	}
 
-	void use() {
-		glUseProgram(shaderProgramRef);
+	ShaderProgramBinary getBinary() const {
+		GLint length = 0;
+		glGetProgramiv(shaderProgramRef, GL_PROGRAM_BINARY_LENGTH, &length);
+
+		ShaderProgramBinary binary;
+		binary.data.resize(length);
+		glGetProgramBinary(shaderProgramRef, length, nullptr, &binary.format, binary.data.data());
+		return binary;
 	}
 
-	void setProjection(const Eigen::Matrix4f& projection) {
-		glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, (const GLfloat*) projection.data());
+	void use() {
+		glUseProgram(shaderProgramRef);
 	}
 
 	void setModelView(const Eigen::Matrix4f& modelView) {
 		glUniformMatrix4fv(modelViewLocation, 1, GL_FALSE, (const GLfloat*) modelView.data());
 	}
 
-	void setLightPos(const Eigen::Vector4f& lightPos) {
-		glUniform4fv(lightPosLocation, 1, (const GLfloat*) lightPos.data());
+	// For variants with double-float transforms, where the model-view is the sum of the two matrices
+	void setModelView(const Eigen::Matrix4f& modelViewHi, const Eigen::Matrix4f& modelViewLo) {
+		glUniformMatrix4fv(modelViewLocation, 1, GL_FALSE, (const GLfloat*) modelViewHi.data());
+		glUniformMatrix4fv(modelViewLoLocation, 1, GL_FALSE, (const GLfloat*) modelViewLo.data());
+	}
+
+	// For variants with streamed transforms, selects the matrix within the bound block of the TransformStream
+	void setDrawIndex(GLint drawIndex) {
+		glUniform1i(drawIndexLocation, drawIndex);
 	}
 
 	ShaderProgram(const ShaderProgram&) = delete;
@@ -85,5 +107,63 @@ public:
 
 private:
 	GLuint shaderProgramRef;
-	GLint projectionLocation, modelViewLocation, lightPosLocation;
+	GLint modelViewLocation, modelViewLoLocation, drawIndexLocation;
+
+	static GLuint compileShader(GLenum type, const std::string& text) {
+		GLuint shader = glCreateShader(type);
+		const char* shaderText = text.c_str();
+		glShaderSource(shader, 1, &shaderText, NULL);
+		glCompileShader(shader);
+
+		GLint isCompiled = 0;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+		if (!isCompiled) {
+			GLint logLength = 0;
+			glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+			std::string log(std::max(logLength, 1), '\0');
+			glGetShaderInfoLog(shader, logLength, nullptr, &log[0]);
+			glDeleteShader(shader);
+			throw std::runtime_error("Shader Compile Error: " + std::string(log.c_str()));
+		}
+
+		return shader;
+	}
+
+	void checkLinkStatus() {
+		GLint isLinked = 0;
+		glGetProgramiv(shaderProgramRef, GL_LINK_STATUS, &isLinked);
+		if (!isLinked) {
+			GLint logLength = 0;
+			glGetProgramiv(shaderProgramRef, GL_INFO_LOG_LENGTH, &logLength);
+			std::string log(std::max(logLength, 1), '\0');
+			glGetProgramInfoLog(shaderProgramRef, logLength, nullptr, &log[0]);
+			glDeleteProgram(shaderProgramRef);
+			throw std::runtime_error("Shader Link Error: " + std::string(log.c_str()));
+		}
+	}
+
+	void initUniforms() {
+		modelViewLocation = glGetUniformLocation(shaderProgramRef, "modelView");
+		modelViewLoLocation = glGetUniformLocation(shaderProgramRef, "modelViewLo");
+		drawIndexLocation = glGetUniformLocation(shaderProgramRef, "drawIndex");
+
+		// Block bindings are not part of the program binary, so they are set up even when loading from one
+		bindUniformBlock("FrameData", FrameUniformBuffer::binding);
+		bindUniformBlock("DrawData", TransformStream::binding);
+
+		// Dekker's splitter for double-float variants without fused multiply-adds. Uniform values are not part of the
+		// program binary either.
+		GLint splitterLocation = glGetUniformLocation(shaderProgramRef, "splitter");
+		if (splitterLocation != -1) {
+			glUseProgram(shaderProgramRef);
+			glUniform1f(splitterLocation, 4097.0f);
+		}
+	}
+
+	void bindUniformBlock(const char* name, GLuint binding) {
+		GLuint blockIndex = glGetUniformBlockIndex(shaderProgramRef, name);
+		if (blockIndex != GL_INVALID_INDEX) {
+			glUniformBlockBinding(shaderProgramRef, blockIndex, binding);
+		}
+	}
 };
@@ -17,22 +17,56 @@
 #pragma once
 #include <unordered_map>
 #include <memory>
+#include <cstdio>
+#include <string>
 #include "ShaderProgram.h"
 #include "ShaderProgramLoader.h"
-
-enum class ShaderProgramHandle {HYPERBOLIC, SPHERICAL};
+#include "ShaderProgramKey.h"
+#include "ShaderProgramCache.h"
+#include "ShaderWatcher.h"
 
 class ShaderProgramBank {
 public:
-	ShaderProgramBank() {
-		shaderPrograms[ShaderProgramHandle::HYPERBOLIC] = std::make_unique<ShaderProgram>(ShaderProgramLoader::loadShaderProgram("hyperbolic"));
-		shaderPrograms[ShaderProgramHandle::SPHERICAL] = std::make_unique<ShaderProgram>(ShaderProgramLoader::loadShaderProgram("spherical"));
+	// Requires a current GL context, as does every other method
+	ShaderProgramBank(): cache("shader_cache.bin") {}
+
+	// Variants are loaded the first time they are requested
+	ShaderProgram& get(const ShaderProgramKey& key) {
+		auto shaderProgram = shaderPrograms.find(key);
+		if (shaderProgram == shaderPrograms.end()) {
+			shaderProgram = shaderPrograms.emplace(key, cache.load(ShaderProgramLoader::loadShaderProgram(name, key.getDefines()))).first;
+		}
+		return *shaderProgram->second;
 	}
 
-	ShaderProgram& get(ShaderProgramHandle shaderProgramHandle) {
-		return *shaderPrograms[shaderProgramHandle];
+	// Development mode: Shader source files are watched so that they can be reloaded without restarting
+	void watchForChanges() {
+		watcher = std::make_unique<ShaderWatcher>(std::vector<std::string> {
+			ShaderProgramLoader::getVertexShaderPath(name),
+			ShaderProgramLoader::getFragmentShaderPath(name)
+		});
+	}
+
+	// Should be called between frames. Returns true if programs were replaced, invalidating references returned by get.
+	// A program that fails to compile is reported and keeps its previous version.
+	bool reloadChangedPrograms() {
+		if (!watcher || !watcher->takeChanges()) {
+			return false;
+		}
+
+		for (auto& shaderProgram : shaderPrograms) {
+			try {
+				shaderProgram.second = cache.load(ShaderProgramLoader::loadShaderProgram(name, shaderProgram.first.getDefines()));
+			} catch (const std::runtime_error& e) {
+				fprintf(stderr, "Failed to reload shader program: %s\n", e.what());
+			}
+		}
+		return true;
 	}
 
 private:
-	std::unordered_map<ShaderProgramHandle, std::unique_ptr<ShaderProgram>> shaderPrograms;
+	const std::string name = "standard";
+	ShaderProgramCache cache;
+	std::unique_ptr<ShaderWatcher> watcher;
+	std::unordered_map<ShaderProgramKey, std::unique_ptr<ShaderProgram>, ShaderProgramKey::Hash> shaderPrograms;
 };
@@ -0,0 +1,169 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include "glad.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "ShaderProgram.h"
+#include "ShaderProgramData.h"
+
+// Keeps linked program binaries in a single file so that later launches can skip compiling and linking. Entries are
+// keyed by a hash of the shader source and the driver identification strings, so editing a shader or updating the driver
+// simply results in a cache miss. A GL context must be current when this is constructed.
+class ShaderProgramCache {
+public:
+	ShaderProgramCache(const std::string& path): path(path), enabled(false) {
+		GLint numBinaryFormats = 0;
+		if (GLAD_GL_ARB_get_program_binary) {
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+		}
+		enabled = numBinaryFormats > 0;
+
+		if (enabled) {
+			driver = getGlString(GL_VENDOR) + "\n" + getGlString(GL_RENDERER) + "\n" + getGlString(GL_VERSION);
+			readEntries();
+		}
+	}
+
+	ShaderProgramCache(const ShaderProgramCache&) = delete;
+	ShaderProgramCache& operator=(const ShaderProgramCache&) = delete;
+
+	std::unique_ptr<ShaderProgram> load(const ShaderProgramData& data) {
+		auto startTime = std::chrono::steady_clock::now();
+
+		if (!enabled) {
+			auto shaderProgram = std::make_unique<ShaderProgram>(data);
+			logLoadTime("compiled from source", startTime);
+			return shaderProgram;
+		}
+
+		std::uint64_t key = getKey(data);
+		auto entry = entries.find(key);
+		if (entry != entries.end()) {
+			try {
+				auto shaderProgram = std::make_unique<ShaderProgram>(entry->second);
+				logLoadTime("loaded from binary cache", startTime);
+				return shaderProgram;
+			} catch (const std::runtime_error&) {
+				entries.erase(entry); // The driver rejected the binary, so fall back to the source
+			}
+		}
+
+		auto shaderProgram = std::make_unique<ShaderProgram>(data);
+		logLoadTime("compiled from source", startTime);
+
+		entries[key] = shaderProgram->getBinary();
+		writeEntries();
+		return shaderProgram;
+	}
+
+private:
+	static constexpr std::uint32_t magic = 0x43535748; // "HWSC"
+	static constexpr std::uint32_t version = 1;
+
+	std::string path;
+	bool enabled;
+	std::string driver;
+	std::unordered_map<std::uint64_t, ShaderProgramBinary> entries;
+
+	static std::string getGlString(GLenum name) {
+		const GLubyte* value = glGetString(name);
+		return value == nullptr ? "" : reinterpret_cast<const char*>(value);
+	}
+
+	// 64-bit FNV-1a, which is plenty to tell shader revisions apart
+	static void hash(std::uint64_t& state, const std::string& text) {
+		for (char c : text) {
+			state ^= static_cast<unsigned char>(c);
+			state *= 0x100000001b3ull;
+		}
+		state ^= 0xff; // Separator, so that moving text between strings changes the hash
+		state *= 0x100000001b3ull;
+	}
+
+	std::uint64_t getKey(const ShaderProgramData& data) const {
+		std::uint64_t state = 0xcbf29ce484222325ull;
+		hash(state, data.vertexShaderText);
+		hash(state, data.fragmentShaderText);
+		hash(state, driver);
+		return state;
+	}
+
+	void logLoadTime(const char* method, std::chrono::steady_clock::time_point startTime) {
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+		printf("Shader program %s in %.2f ms\n", method, elapsed.count());
+	}
+
+	template<typename T>
+	static bool readValue(std::istream& stream, T& value) {
+		return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	template<typename T>
+	static void writeValue(std::ostream& stream, T value) {
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	// A missing, truncated or outdated file is treated as an empty cache
+	void readEntries() {
+		std::ifstream stream(path, std::ios::binary);
+		std::uint32_t fileMagic = 0, fileVersion = 0, numEntries = 0;
+		if (!readValue(stream, fileMagic) || !readValue(stream, fileVersion) || !readValue(stream, numEntries)
+				|| fileMagic != magic || fileVersion != version) {
+			return;
+		}
+
+		for (std::uint32_t i = 0; i < numEntries; ++i) {
+			std::uint64_t key;
+			std::uint32_t format, length;
+			if (!readValue(stream, key) || !readValue(stream, format) || !readValue(stream, length)) {
+				return;
+			}
+
+			ShaderProgramBinary binary;
+			binary.format = format;
+			binary.data.resize(length);
+			if (!stream.read(binary.data.data(), length)) {
+				return;
+			}
+			entries[key] = std::move(binary);
+		}
+	}
+
+	void writeEntries() {
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		writeValue(stream, magic);
+		writeValue(stream, version);
+		writeValue(stream, static_cast<std::uint32_t>(entries.size()));
+
+		for (const auto& entry : entries) {
+			writeValue(stream, entry.first);
+			writeValue(stream, static_cast<std::uint32_t>(entry.second.format));
+			writeValue(stream, static_cast<std::uint32_t>(entry.second.data.size()));
+			stream.write(entry.second.data.data(), entry.second.data.size());
+		}
+
+		if (!stream) {
+			fprintf(stderr, "Warning: Failed to write shader cache to %s\n", path.c_str());
+		}
+	}
+};
@@ -15,7 +15,7 @@
  */
 
 #pragma once
-#include <GLFW/glfw3.h>
+#include "glad.h"
 #include <vector>
 #include <string>
 
@@ -25,3 +25,11 @@ public:
 	const std::string vertexShaderText;
 	const std::string fragmentShaderText;
 };
+
+// Driver-specific compiled form of a linked shader program
+class ShaderProgramBinary {
+public:
+	ShaderProgramBinary(): format(0) {}
+	GLenum format;
+	std::vector<char> data;
+};
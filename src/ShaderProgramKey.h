@@ -0,0 +1,79 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include "UniformBuffers.h"
+
+enum class Geometry {HYPERBOLIC, SPHERICAL};
+enum class LightingModel {POINT_LIGHT, UNLIT};
+enum class TransformPrecision {SINGLE, DOUBLE_FLOAT};
+
+// Identifies one variant of the standard shader program. Every feature is resolved by the GLSL preprocessor when the
+// variant is compiled, so none of them cost anything at draw time.
+class ShaderProgramKey {
+public:
+	ShaderProgramKey():
+		geometry(Geometry::HYPERBOLIC),
+		lightingModel(LightingModel::POINT_LIGHT),
+		streamedTransforms(false),
+		transformPrecision(TransformPrecision::SINGLE) {}
+
+	Geometry geometry;
+	LightingModel lightingModel;
+	bool streamedTransforms; // Whether model-view matrices come from a TransformStream instead of a uniform
+	// DOUBLE_FLOAT passes each model-view as a pair of matrices whose sum is closer to the double-precision original.
+	// The pair always comes from uniforms, so it overrides streamedTransforms.
+	TransformPrecision transformPrecision;
+
+	// Packs every feature into a single integer, used for hashing and equality
+	unsigned getBits() const {
+		return static_cast<unsigned>(geometry)
+			| static_cast<unsigned>(lightingModel) << 1
+			| static_cast<unsigned>(streamedTransforms) << 2
+			| static_cast<unsigned>(transformPrecision) << 3;
+	}
+
+	// Preprocessor definitions to insert directly after the version directive of each shader stage
+	std::string getDefines() const {
+		std::string defines;
+		defines += geometry == Geometry::SPHERICAL ? "#define GEOMETRY_SPHERICAL\n" : "#define GEOMETRY_HYPERBOLIC\n";
+		defines += lightingModel == LightingModel::UNLIT ? "#define LIGHTING_UNLIT\n" : "#define LIGHTING_POINT\n";
+		if (transformPrecision == TransformPrecision::DOUBLE_FLOAT) {
+			defines += "#define TRANSFORM_DOUBLE_FLOAT\n";
+		} else if (streamedTransforms) {
+			defines += "#define TRANSFORM_STREAMED\n";
+			defines += "#define DRAWS_PER_BLOCK " + std::to_string(TransformStream::drawsPerBlock) + "\n";
+		}
+		return defines;
+	}
+
+	bool operator==(const ShaderProgramKey& other) const {
+		return getBits() == other.getBits();
+	}
+
+	bool operator!=(const ShaderProgramKey& other) const {
+		return getBits() != other.getBits();
+	}
+
+	class Hash {
+	public:
+		std::size_t operator()(const ShaderProgramKey& key) const {
+			return key.getBits();
+		}
+	};
+};
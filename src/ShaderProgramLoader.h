@@ -17,21 +17,41 @@
 #pragma once
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 #include "ShaderProgramData.h"
 
 class ShaderProgramLoader {
 public:
-	static ShaderProgramData loadShaderProgram(const std::string& name) {
-		std::string vertexShaderPath = "shaders/" + name + ".vert";
-		std::ifstream vertexShaderFstream(vertexShaderPath);
+	// The given preprocessor definitions are inserted into both stages directly after the version directive, which
+	// must stay on the first line of each shader file.
+	static ShaderProgramData loadShaderProgram(const std::string& name, const std::string& defines) {
+		std::ifstream vertexShaderFstream(getVertexShaderPath(name));
 		std::stringstream vertexShaderStringStream;
 		vertexShaderStringStream << vertexShaderFstream.rdbuf();
 
-		std::string fragmentShaderPath = "shaders/" + name + ".frag";
-		std::ifstream fragmentShaderFstream(fragmentShaderPath);
+		std::ifstream fragmentShaderFstream(getFragmentShaderPath(name));
 		std::stringstream fragmentShaderStringStream;
 		fragmentShaderStringStream << fragmentShaderFstream.rdbuf();
 
-		return ShaderProgramData(vertexShaderStringStream.str(), fragmentShaderStringStream.str());
+		return ShaderProgramData(
+			insertDefines(vertexShaderStringStream.str(), defines),
+			insertDefines(fragmentShaderStringStream.str(), defines));
+	}
+
+	static std::string getVertexShaderPath(const std::string& name) {
+		return "shaders/" + name + ".vert";
+	}
+
+	static std::string getFragmentShaderPath(const std::string& name) {
+		return "shaders/" + name + ".frag";
+	}
+
+private:
+	static std::string insertDefines(const std::string& shaderText, const std::string& defines) {
+		std::string::size_type versionEnd = shaderText.find('\n');
+		if (versionEnd == std::string::npos) {
+			throw std::runtime_error("Shader file is missing a version directive");
+		}
+		return shaderText.substr(0, versionEnd + 1) + defines + shaderText.substr(versionEnd + 1);
 	}
 };
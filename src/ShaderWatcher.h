@@ -0,0 +1,81 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <sys/stat.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Polls the modification times of a set of files on a background thread. Meant for development, so that shaders can be
+// edited while the program is running.
+class ShaderWatcher {
+public:
+	ShaderWatcher(const std::vector<std::string>& paths): paths(paths), running(true), changed(false) {
+		modificationTimes = getModificationTimes();
+		thread = std::thread([this]() { watch(); });
+	}
+
+	~ShaderWatcher() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running = false;
+		}
+		wakeUp.notify_all();
+		thread.join();
+	}
+
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	// Returns whether any file changed since the last call
+	bool takeChanges() {
+		return changed.exchange(false);
+	}
+
+private:
+	std::vector<std::string> paths;
+	std::vector<time_t> modificationTimes;
+	bool running;
+	std::atomic<bool> changed;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::thread thread;
+
+	std::vector<time_t> getModificationTimes() {
+		std::vector<time_t> result;
+		for (const std::string& path : paths) {
+			struct stat fileStatus;
+			result.push_back(stat(path.c_str(), &fileStatus) == 0 ? fileStatus.st_mtime : 0);
+		}
+		return result;
+	}
+
+	void watch() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!wakeUp.wait_for(lock, std::chrono::milliseconds(250), [this]() { return !running; })) {
+			std::vector<time_t> newModificationTimes = getModificationTimes();
+			if (newModificationTimes != modificationTimes) {
+				modificationTimes = newModificationTimes;
+				changed = true;
+			}
+		}
+	}
+};
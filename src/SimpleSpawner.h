@@ -14,60 +14,89 @@
 	limitations under the License.
  */
 
+#include <random>
 #include <vector>
-#include <memory>
 #include "Entity.h"
-#include "SimpleRenderNode.h"
 #include "UserInput.h"
-#include "GhostCamera.h"
+#include "Camera.h"
 #include "Scene.h"
-#include "ModelBank.h"
-#include "TextureBank.h"
+#include "RenderHandles.h"
+#include "SpawnPatterns.h"
 
+// Its patterns are hyperbolic, so it only spawns into hyperbolic scenes
 class SimpleSpawner : public Entity {
 public:
-	SimpleSpawner(Scene& scene, GhostCamera& spawnCursor): scene(&scene), spawnCursor(&spawnCursor) {}
+	// The grid and tiling are the same every time, so they are only built once
+	SimpleSpawner(Scene<HyperbolicGeometry>& scene, Camera& spawnCursor):
+		scene(&scene),
+		spawnCursor(&spawnCursor),
+		single {Matrix4d::Identity()},
+		grid(SpawnPatterns::geodesicGrid(5, 2.5)),
+		tessellation(SpawnPatterns::tessellation(18)) {}
 
 	void step(double dt, const UserInput& userInput) override {
-		if (userInput.pressedThisStep(inputs.spawnDodecahedron)) {
-			simpleRenderNodes.emplace_back(std::make_unique<SimpleRenderNode>(spawnCursor->getPos(), ModelHandle::DODECAHEDRON, TextureHandle::PERLIN));
-			scene->addRenderNode(*simpleRenderNodes.back());
-		}
+		// Dodecahedra spin in place, so the motion component is exercised by every scene with one
+		spawnOnPress(userInput, InputAction::SPAWN_DODECAHEDRON, single, ModelHandle::DODECAHEDRON, TextureHandle::PERLIN, true);
+		spawnOnPress(userInput, InputAction::SPAWN_HOROSPHERE, single, ModelHandle::HOROSPHERE, TextureHandle::TILE, false);
+		spawnOnPress(userInput, InputAction::SPAWN_PLANE, single, ModelHandle::PLANE, TextureHandle::PERLIN, false);
+		spawnOnPress(userInput, InputAction::SPAWN_PRISM, single, ModelHandle::PRISM, TextureHandle::BLANK, false);
+		spawnOnPress(userInput, InputAction::SPAWN_TREE, single, ModelHandle::TREE, TextureHandle::BLANK, false);
 
-		if (userInput.pressedThisStep(inputs.spawnHorosphere)) {
-			simpleRenderNodes.emplace_back(std::make_unique<SimpleRenderNode>(spawnCursor->getPos(), ModelHandle::HOROSPHERE, TextureHandle::TILE));
-			scene->addRenderNode(*simpleRenderNodes.back());
+		if (userInput.pressedThisStep(InputAction::SPAWN_BALL)) {
+			spawn(SpawnPatterns::randomBall(1000, 5.0, random), spawnCursor->getPos(), ModelHandle::DODECAHEDRON, TextureHandle::PERLIN, true);
 		}
+		spawnOnPress(userInput, InputAction::SPAWN_GRID, grid, ModelHandle::DODECAHEDRON, TextureHandle::PERLIN, false);
 
-		if (userInput.pressedThisStep(inputs.spawnPlane)) {
-			simpleRenderNodes.emplace_back(std::make_unique<SimpleRenderNode>(spawnCursor->getPos(), ModelHandle::PLANE, TextureHandle::PERLIN));
-			scene->addRenderNode(*simpleRenderNodes.back());
+		// The tiling lies flat below the cursor, so the prisms stand upright on it
+		if (userInput.pressedThisStep(InputAction::SPAWN_TESSELLATION)) {
+			Matrix4d floor = spawnCursor->getPos() * VectorMath::hyperbolicDisplacement(Vector4d(0, -1.5, 0, 0))
+				* VectorMath::rotation(Vector3d(1, 0, 0), M_TAU / 4);
+			spawn(tessellation, floor, ModelHandle::PRISM, TextureHandle::BLANK, false);
 		}
 
-		if (userInput.pressedThisStep(inputs.spawnPrism)) {
-			simpleRenderNodes.emplace_back(std::make_unique<SimpleRenderNode>(spawnCursor->getPos(), ModelHandle::PRISM, TextureHandle::BLANK));
-			scene->addRenderNode(*simpleRenderNodes.back());
+		if (userInput.pressedThisStep(InputAction::DESPAWN_ALL)) {
+			scene->getRenderNodes().removeAll(spawned);
+			spawned.clear();
 		}
+	}
 
-		if (userInput.pressedThisStep(inputs.spawnTree)) {
-			simpleRenderNodes.emplace_back(std::make_unique<SimpleRenderNode>(spawnCursor->getPos(), ModelHandle::TREE, TextureHandle::BLANK));
-			scene->addRenderNode(*simpleRenderNodes.back());
-		}
+	std::size_t getSpawnedCount() const {
+		return spawned.size();
 	}
 
-	class Inputs {
-	public:
-		InputHandle spawnDodecahedron = KeyboardButton(GLFW_KEY_1);
-		InputHandle spawnHorosphere = KeyboardButton(GLFW_KEY_2);
-		InputHandle spawnPlane = KeyboardButton(GLFW_KEY_3);
-		InputHandle spawnPrism = KeyboardButton(GLFW_KEY_4);
-		InputHandle spawnTree = KeyboardButton(GLFW_KEY_5);
-	};
+private:
+	Scene<HyperbolicGeometry>* scene;
+	Camera* spawnCursor;
+	std::mt19937 random; // Default-seeded, so a replay spawns the same random patterns
+	std::vector<Matrix4d> single;
+	std::vector<Matrix4d> grid;
+	std::vector<Matrix4d> tessellation;
+	std::vector<Matrix4d> placed; // Reused for each batch
+	std::vector<SlotHandle> spawned; // Everything still in the scene, in the order it was spawned
 
-	Inputs inputs;
+	void spawnOnPress(const UserInput& userInput, InputAction action, const std::vector<Matrix4d>& pattern,
+			ModelHandle model, TextureHandle texture, bool spins) {
+		if (userInput.pressedThisStep(action)) {
+			spawn(pattern, spawnCursor->getPos(), model, texture, spins);
+		}
+	}
 
-private:
-	Scene* scene;
-	GhostCamera* spawnCursor;
-	std::vector<std::unique_ptr<SimpleRenderNode>> simpleRenderNodes;
-};
\ No newline at end of file
+	// Spawns an instance at each of the pattern's transforms, relative to the given transform in the cursor's anchor
+	void spawn(const std::vector<Matrix4d>& pattern, const Matrix4d& transform, ModelHandle model, TextureHandle texture, bool spins) {
+		placed.clear();
+		for (const Matrix4d& patternTransform : pattern) {
+			placed.push_back(transform * patternTransform);
+		}
+
+		RenderNodeStore& nodes = scene->getRenderNodes();
+		std::size_t first = spawned.size();
+		nodes.addAll(spawnCursor->getAnchor(), placed, model, texture, spawned);
+		if (spins) {
+			Motion spin;
+			spin.angularVelocity = Vector3d(0, 0.5, 0);
+			for (std::size_t i = first; i < spawned.size(); ++i) {
+				nodes.setMotion(spawned[i], spin);
+			}
+		}
+	}
+};
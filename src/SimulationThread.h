@@ -0,0 +1,212 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Scene.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
+#include "InputRecording.h"
+#include "InputState.h"
+#include "InputBindings.h"
+#include "UserInput.h"
+#include "FixedTimestep.h"
+
+// Steps the scene on its own thread in fixed ticks, publishing a snapshot after every update. The scene belongs to this
+// thread once it starts, so the window thread only passes in input and draws the snapshots. Space is the scene's
+// GeometryPolicy.
+template<typename Space>
+class SimulationThread {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// If the simulation falls more than maxTicksPerUpdate ticks behind, it drops the excess and carries on from there. The
+	// bindings are read by the simulation thread, so they must not change while it runs.
+	SimulationThread(Scene<Space>& scene, const InputBindings& bindings, double tickInterval, int maxTicksPerUpdate = 5):
+		scene(scene), bindings(bindings), timestep(tickInterval, maxTicksPerUpdate), startTime(Clock::now()), running(false), finished(false), droppedSeconds(0) {}
+
+	~SimulationThread() {
+		stop();
+	}
+
+	SimulationThread(const SimulationThread&) = delete;
+	SimulationThread& operator=(const SimulationThread&) = delete;
+
+	// Steps through the recording, one recorded step per tick, instead of taking input from addInput. The recording
+	// must have been made at this tick interval, as the snapshots are timed by tick. That is checked against the
+	// interval in the recording's header, or against every step's dt in a recording without one. Must be called before
+	// start.
+	void replay(const InputRecording& recording) {
+		double tickInterval = timestep.getTickInterval();
+		auto matches = [tickInterval](double interval) {
+			return std::abs(interval - tickInterval) <= tickIntervalTolerance * tickInterval;
+		};
+		bool recordedAtTickInterval = recording.getTickInterval() != 0 ? matches(recording.getTickInterval())
+			: std::all_of(recording.getSteps().begin(), recording.getSteps().end(),
+				[&matches](const RecordedInputStep& step) { return matches(step.dt); });
+		if (!recordedAtTickInterval) {
+			throw std::runtime_error("Recording was not made at a tick interval of " + std::to_string(tickInterval) + " seconds");
+		}
+		replaySteps = &recording;
+	}
+
+	// Adds the input of every tick to the recording, which must not be read until the thread has stopped. Must be called
+	// before start.
+	void record(InputRecording& recording) {
+		recording.setTickInterval(timestep.getTickInterval());
+		this->recording = &recording;
+	}
+
+	void start() {
+		startTime = Clock::now();
+		running = true;
+		thread = std::thread([this]() { run(); });
+	}
+
+	void stop() {
+		running = false;
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+
+	// Called by the window thread with the input gathered since its last call. What is held replaces what was held
+	// before, while presses and mouse movement add up until a tick takes them.
+	void addInput(const InputState& input, Vector2d mouseLook) {
+		std::lock_guard<std::mutex> lock(inputMutex);
+		pendingHeld = input.getHeld();
+		pendingPressed |= input.getPressed();
+		pendingMouseLook += mouseLook;
+	}
+
+	// Seconds since the simulation started, less any time it dropped, on the same clock as the snapshots' times
+	double getTime() const {
+		return std::chrono::duration<double>(Clock::now() - startTime).count() - droppedSeconds;
+	}
+
+	double getTickInterval() const {
+		return timestep.getTickInterval();
+	}
+
+	// Whether a replay has run out of steps
+	bool isFinished() const {
+		return finished;
+	}
+
+	// Only the window thread may take snapshots
+	TripleBuffer<RenderSnapshot>& getSnapshots() {
+		return snapshots;
+	}
+
+private:
+	// How far, relative to the tick interval, a recorded interval may be from it, which covers the same interval
+	// computed in a different way
+	static constexpr double tickIntervalTolerance = 1e-9;
+
+	Scene<Space>& scene;
+	const InputBindings& bindings;
+	FixedTimestep timestep; // Only used by the simulation thread
+	Clock::time_point startTime;
+	std::thread thread;
+	std::atomic<bool> running;
+	std::atomic<bool> finished;
+	std::atomic<double> droppedSeconds;
+	TripleBuffer<RenderSnapshot> snapshots;
+	const InputRecording* replaySteps = nullptr;
+	InputRecording* recording = nullptr;
+
+	InputState input; // Only used by the simulation thread
+
+	std::mutex inputMutex;
+	InputState::Bits pendingHeld;
+	InputState::Bits pendingPressed;
+	Vector2d pendingMouseLook = Vector2d::Zero();
+
+	// Moves the input on to the next tick, returning the mouse movement since the last one
+	Vector2d takeInput() {
+		std::lock_guard<std::mutex> lock(inputMutex);
+		input.advance(pendingHeld, pendingPressed);
+		pendingPressed.reset();
+		Vector2d mouseLook = pendingMouseLook;
+		pendingMouseLook = Vector2d::Zero();
+		return mouseLook;
+	}
+
+	void publish(std::uint64_t tick) {
+		RenderSnapshot& snapshot = snapshots.getBack();
+		scene.makeSnapshot(snapshot);
+		snapshot.tick = tick;
+		snapshot.time = tick * timestep.getTickInterval();
+		snapshot.timestep = timestep.getStatistics();
+		snapshots.publish();
+	}
+
+	// Returns false once a replay has run out of steps
+	bool step(std::uint64_t tick) {
+		double dt = timestep.getTickInterval();
+		Vector2d mouseLook;
+		if (replaySteps != nullptr) {
+			if (tick > replaySteps->getSteps().size()) {
+				return false;
+			}
+			const RecordedInputStep& replayStep = replaySteps->getSteps()[tick - 1];
+			replayStep.applyTo(input);
+			mouseLook = replayStep.mouseLook;
+		} else {
+			mouseLook = takeInput();
+		}
+
+		scene.step(dt, UserInput(input, bindings, mouseLook));
+		if (recording != nullptr) {
+			recording->addStep(RecordedInputStep::fromState(dt, mouseLook, input));
+		}
+		return true;
+	}
+
+	void run() {
+		std::uint64_t tick = 0;
+		publish(tick);
+
+		Clock::time_point previousUpdate = startTime;
+		while (running) {
+			std::this_thread::sleep_for(std::chrono::duration<double>(timestep.getTimeToNextTick()));
+
+			Clock::time_point now = Clock::now();
+			int ticks = timestep.advance(std::chrono::duration<double>(now - previousUpdate).count());
+			previousUpdate = now;
+			droppedSeconds = timestep.getStatistics().droppedSeconds;
+
+			for (int i = 0; i < ticks; ++i) {
+				if (!step(++tick)) {
+					finished = true;
+					return;
+				}
+			}
+			if (ticks != 0) {
+				publish(tick);
+			}
+		}
+	}
+};
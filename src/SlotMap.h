@@ -0,0 +1,127 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Refers to an element of a SlotMap. A handle stays valid however other elements are added and removed, and once its
+// element is removed, the handle is never mistaken for a newer element that reuses the slot.
+class SlotHandle {
+public:
+	static constexpr std::uint32_t nullIndex = std::numeric_limits<std::uint32_t>::max();
+
+	std::uint32_t index = nullIndex;
+	std::uint32_t generation = 0;
+
+	bool isNull() const {
+		return index == nullIndex;
+	}
+
+	// Unique among every handle a SlotMap has given out
+	std::uint64_t getId() const {
+		return static_cast<std::uint64_t>(generation) << 32 | index;
+	}
+
+	bool operator==(const SlotHandle& other) const {
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator!=(const SlotHandle& other) const {
+		return !(*this == other);
+	}
+};
+
+// Hands out stable handles to elements kept densely packed in arrays owned by the caller, such as one array per field.
+// Adding puts the new element at the end, and removing moves the last element into the removed one's place, so both
+// take constant time and the arrays never have gaps to skip over.
+class SlotMap {
+public:
+	// The new element's dense index is getSize() - 1
+	SlotHandle add() {
+		std::uint32_t slotIndex;
+		if (freeSlot != SlotHandle::nullIndex) {
+			slotIndex = freeSlot;
+			freeSlot = slots[slotIndex].denseIndex;
+			++slots[slotIndex].generation;
+		} else {
+			slotIndex = static_cast<std::uint32_t>(slots.size());
+			slots.push_back(Slot {0, 0});
+		}
+
+		slots[slotIndex].denseIndex = static_cast<std::uint32_t>(denseSlots.size());
+		denseSlots.push_back(slotIndex);
+		return SlotHandle {slotIndex, slots[slotIndex].generation};
+	}
+
+	bool contains(SlotHandle handle) const {
+		return handle.index < slots.size() && slots[handle.index].generation == handle.generation
+			&& (slots[handle.index].generation & 1) == 0;
+	}
+
+	// Throws std::runtime_error if the element was removed
+	std::size_t getDenseIndex(SlotHandle handle) const {
+		if (!contains(handle)) {
+			throw std::runtime_error("Tried to use a removed slot map element");
+		}
+		return slots[handle.index].denseIndex;
+	}
+
+	SlotHandle getHandle(std::size_t denseIndex) const {
+		std::uint32_t slotIndex = denseSlots[denseIndex];
+		return SlotHandle {slotIndex, slots[slotIndex].generation};
+	}
+
+	// Returns the dense index the element had. Unless it was the last element, the caller must then move its last
+	// element, at index getSize(), into that index. Throws std::runtime_error if the element was already removed.
+	std::size_t remove(SlotHandle handle) {
+		std::size_t denseIndex = getDenseIndex(handle);
+		std::uint32_t lastSlot = denseSlots.back();
+		denseSlots[denseIndex] = lastSlot;
+		slots[lastSlot].denseIndex = static_cast<std::uint32_t>(denseIndex);
+		denseSlots.pop_back();
+
+		// Odd generations mark free slots, so the next element in this slot gets a generation no handle has had
+		Slot& slot = slots[handle.index];
+		++slot.generation;
+		slot.denseIndex = freeSlot;
+		freeSlot = handle.index;
+		return denseIndex;
+	}
+
+	std::size_t getSize() const {
+		return denseSlots.size();
+	}
+
+	void reserve(std::size_t size) {
+		slots.reserve(size);
+		denseSlots.reserve(size);
+	}
+
+private:
+	class Slot {
+	public:
+		std::uint32_t denseIndex; // The next free slot instead, while the slot is free
+		std::uint32_t generation;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<std::uint32_t> denseSlots; // The slot of each element, in dense order
+	std::uint32_t freeSlot = SlotHandle::nullIndex;
+};
@@ -0,0 +1,108 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <cmath>
+#include <random>
+#include <vector>
+#include "VectorMath.h"
+#include "Tessellation.h"
+
+// Transforms for placing many instances at once, relative to the frame they are spawned in. Each is an isometry of
+// hyperbolic space, so spawning at a transform composed with any of them keeps the instances undistorted.
+class SpawnPatterns {
+public:
+	// Points spread uniformly by volume through a ball of the given radius around the origin, each turned to a
+	// uniformly random orientation. Hyperbolic volume grows exponentially with radius, so most land near the edge.
+	template<typename Random>
+	static std::vector<Matrix4d> randomBall(std::size_t count, double radius, Random& random) {
+		std::uniform_real_distribution<double> unit(0.0, 1.0);
+		std::normal_distribution<double> normal;
+		double maxDensity = sinh(radius) * sinh(radius);
+
+		std::vector<Matrix4d> transforms;
+		transforms.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			// The volume at distance r grows with sinh(r)^2, so distances are sampled by rejection against it
+			double distance;
+			do {
+				distance = radius * unit(random);
+			} while (unit(random) * maxDensity > sinh(distance) * sinh(distance));
+
+			Vector3d direction;
+			do {
+				direction = Vector3d(normal(random), normal(random), normal(random));
+			} while (direction.squaredNorm() == 0);
+			direction *= distance / direction.norm();
+
+			// A normally distributed quaternion, once normalized, is a uniformly distributed rotation
+			Eigen::Quaterniond orientation(normal(random), normal(random), normal(random), normal(random));
+			Matrix4d rotation = Matrix4d::Identity();
+			rotation.topLeftCorner<3, 3>() = orientation.normalized().toRotationMatrix();
+
+			transforms.push_back(VectorMath::hyperbolicDisplacement(Vector4d(direction.x(), direction.y(), direction.z(), 0)) * rotation);
+		}
+		return transforms;
+	}
+
+	// A cube of countPerAxis points on each side, centered on the origin. Each point is reached by walking along the x,
+	// y and z axes in turn, taking the given number of steps of the given spacing along each geodesic. Space curves
+	// away from the origin, so the outer points are further apart from each other than the spacing. A corner is nearly
+	// as far from the origin as the sum of its three walks, and transforms lose precision exponentially with distance,
+	// so the grid should stay within a few units of the origin along each axis.
+	static std::vector<Matrix4d> geodesicGrid(int countPerAxis, double spacing) {
+		std::vector<Matrix4d> steps;
+		for (int i = 0; i < countPerAxis; ++i) {
+			steps.push_back(VectorMath::hyperbolicDisplacement(Vector4d(0, 0, (i - (countPerAxis - 1) / 2.0) * spacing, 0)));
+		}
+
+		// The displacements along each axis are the same matrices with their axes permuted, so they are only computed once
+		std::vector<Matrix4d> transforms;
+		transforms.reserve(static_cast<std::size_t>(countPerAxis) * countPerAxis * countPerAxis);
+		Matrix4d toX = VectorMath::rotation(Vector3d(0, 1, 0), M_TAU / 4);
+		Matrix4d toY = VectorMath::rotation(Vector3d(1, 0, 0), -M_TAU / 4);
+		for (int x = 0; x < countPerAxis; ++x) {
+			Matrix4d alongX = toX * steps[x] * toX.transpose();
+			for (int y = 0; y < countPerAxis; ++y) {
+				Matrix4d alongXY = alongX * (toY * steps[y] * toY.transpose());
+				for (int z = 0; z < countPerAxis; ++z) {
+					transforms.push_back(alongXY * steps[z]);
+				}
+			}
+		}
+		return transforms;
+	}
+
+	// The centers of the pentagons of Tessellation's tiling of the plane z = 0, out to the given number of rounds of
+	// growth from the origin. Neighboring centers are about 1.26 apart.
+	static std::vector<Matrix4d> tessellation(unsigned rounds) {
+		Tessellation tessellation;
+		tessellation.createSeedFaces();
+		for (unsigned i = 0; i < rounds; ++i) {
+			tessellation.grow();
+		}
+
+		// The corners where five faces meet, and so ten triangles, are the pentagons' centers
+		const unsigned pentagonCenter = 2;
+		std::vector<Matrix4d> transforms;
+		for (size_t i = 0; i < tessellation.getNumVertices(); ++i) {
+			if (tessellation.getVertexType(i) == pentagonCenter) {
+				transforms.push_back(VectorMath::hyperbolicTranslation(tessellation.getVertexPos(i)));
+			}
+		}
+		return transforms;
+	}
+};
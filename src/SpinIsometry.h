@@ -0,0 +1,222 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#pragma once
+#include <complex>
+#include "VectorMath.h"
+
+// An orientation-preserving isometry of hyperbolic space, stored as the matrix
+// [a b; c d] in SL(2,C). A point (x, y, z, w) corresponds to the Hermitian matrix
+// [w+z, x-iy; x+iy, w-z], which the isometry maps to A X A^*. Compared to a
+// Matrix4d, this is half the size, composes with half the multiplications, and
+// is renormalized by rescaling to unit determinant. Both A and -A represent the
+// same isometry.
+class SpinIsometry {
+public:
+	using Complex = std::complex<double>;
+	using Matrix2cd = Eigen::Matrix<Complex, 2, 2, Eigen::DontAlign>;
+
+	SpinIsometry(): matrix(Matrix2cd::Identity()) {}
+
+	SpinIsometry(Complex a, Complex b, Complex c, Complex d) {
+		matrix << a, b, c, d;
+	}
+
+	// Equivalent to VectorMath::hyperbolicDisplacement
+	static SpinIsometry displacement(const Vector4d& displacement) {
+		double norm = displacement.head<3>().norm();
+		double scaleFactor = norm < 1e-30 ? 0.5 : sinh(norm * 0.5) / norm;
+		double coshHalf = cosh(norm * 0.5);
+		double x = displacement.x() * scaleFactor, y = displacement.y() * scaleFactor, z = displacement.z() * scaleFactor;
+		return SpinIsometry(Complex(coshHalf + z, 0), Complex(x, -y), Complex(x, y), Complex(coshHalf - z, 0));
+	}
+
+	// Equivalent to VectorMath::rotation, with a unit axis
+	static SpinIsometry rotation(const Vector3d& axis, double theta) {
+		double c = cos(theta * 0.5), s = sin(theta * 0.5);
+		double x = axis.x() * s, y = axis.y() * s, z = axis.z() * s;
+		return SpinIsometry(Complex(c, -z), Complex(-y, -x), Complex(y, -x), Complex(c, z));
+	}
+
+	// Equivalent to VectorMath::horoRotation
+	static SpinIsometry horoRotation(double x, double y) {
+		return SpinIsometry(Complex(1, 0), Complex(0, 0), Complex(x, y), Complex(1, 0));
+	}
+
+	// The inverse of toMatrix4d. The matrix must be an orientation-preserving isometry that keeps the sign of w.
+	static SpinIsometry fromMatrix(const Matrix4d& matrix) {
+		// For any K, the sum over the basis matrices s_j of (A s_j A^*) K s_j is 2 tr(A^* K) A. The images A s_j A^*
+		// are read from the columns of the matrix, and K is chosen from the basis matrices so that the trace isn't 0.
+		SpinIsometry best(0, 0, 0, 0);
+		double bestNorm = 0;
+		for (int k = 0; k < 4; ++k) {
+			SpinIsometry sum(0, 0, 0, 0);
+			for (int j = 0; j < 4; ++j) {
+				sum += fromPoint(matrix.col(j)) * basis(k) * basis(j);
+			}
+
+			double norm = std::abs(sum.determinant());
+			if (norm > bestNorm) {
+				best = sum;
+				bestNorm = norm;
+			}
+		}
+		return best.renormalized();
+	}
+
+	// Eigen's vectorized complex products are several times faster than std::complex's operator*, which guards
+	// against infinities and NaNs
+	SpinIsometry operator*(const SpinIsometry& other) const {
+		SpinIsometry result;
+		result.matrix.noalias() = matrix.lazyProduct(other.matrix);
+		return result;
+	}
+
+	SpinIsometry& operator*=(const SpinIsometry& other) {
+		return *this = *this * other;
+	}
+
+	SpinIsometry inverse() const {
+		return SpinIsometry(d(), -b(), -c(), a());
+	}
+
+	Complex determinant() const {
+		return multiply(a(), d()) - multiply(b(), c());
+	}
+
+	// Undoes accumulated rounding error by rescaling to unit determinant
+	SpinIsometry renormalized() const {
+		SpinIsometry result;
+		result.matrix = matrix * (1.0 / std::sqrt(determinant()));
+		return result;
+	}
+
+	void renormalize() {
+		*this = renormalized();
+	}
+
+	// How far the determinant has drifted from 1
+	double drift() const {
+		return std::abs(determinant() - 1.0);
+	}
+
+	// The SpinIsometry counterpart of GeometryPolicy::correctDrift. Small drift is corrected to first order,
+	// since scaling by 1 - (det - 1)/2 approximates scaling by det^(-1/2).
+	void correctDrift() {
+		Complex deviation = determinant() - 1.0;
+		double drift = std::abs(deviation);
+
+		if (drift <= HyperbolicGeometry::negligibleDrift) {
+			return;
+		} else if (drift <= HyperbolicGeometry::maxFirstOrderDrift) {
+			matrix *= 1.0 - 0.5 * deviation;
+		} else {
+			renormalize();
+		}
+	}
+
+	// The traceless generator X with exp(X) equal to this isometry, choosing the sign of A that makes it the smallest, so
+	// that exp(t X) for t from 0 to 1 is the shortest path from the identity
+	Matrix2cd log() const {
+		Complex halfTrace = 0.5 * (a() + d());
+		double sign = halfTrace.real() < 0 ? -1.0 : 1.0;
+		halfTrace *= sign;
+
+		// A = cosh(z) I + sinh(z) / z X, since X^2 = z^2 I for traceless X
+		Complex z = std::acosh(halfTrace);
+		Complex scale = std::abs(z) < 1e-4 ? 1.0 + z * z / 6.0 : z / std::sinh(z);
+		return (sign * matrix - halfTrace * Matrix2cd::Identity()) * scale;
+	}
+
+	// The isometry generated by a traceless matrix, the inverse of log
+	static SpinIsometry exp(const Matrix2cd& generator) {
+		Complex sqrtDelta = std::sqrt(multiply(generator(0, 0), generator(0, 0)) + multiply(generator(0, 1), generator(1, 0)));
+		Complex sinhRatio = std::abs(sqrtDelta) < 1e-4 ? 1.0 + sqrtDelta * sqrtDelta / 6.0 : std::sinh(sqrtDelta) / sqrtDelta;
+		SpinIsometry result;
+		result.matrix = std::cosh(sqrtDelta) * Matrix2cd::Identity() + sinhRatio * generator;
+		return result;
+	}
+
+	// Moves along the geodesic in the isometry group from "from" (t = 0) to "to" (t = 1)
+	static SpinIsometry interpolate(const SpinIsometry& from, const SpinIsometry& to, double t) {
+		return from * exp(t * (from.inverse() * to).log());
+	}
+
+	// Where the origin is moved to, which is cheaper than toMatrix4d().col(3)
+	Vector4d getPosition() const {
+		return toPoint(std::norm(a()) + std::norm(b()), multiplyConj(c(), a()) + multiplyConj(d(), b()), std::norm(c()) + std::norm(d()));
+	}
+
+	Matrix4d toMatrix4d() const {
+		// Column j is the point for A s_j A^*, where s_j is the basis matrix for the jth unit vector
+		Complex a = this->a(), b = this->b(), c = this->c(), d = this->d();
+		double normA = std::norm(a), normB = std::norm(b), normC = std::norm(c), normD = std::norm(d);
+		Complex ab = multiplyConj(a, b), cd = multiplyConj(c, d);
+		Complex ca = multiplyConj(c, a), db = multiplyConj(d, b), cb = multiplyConj(c, b), da = multiplyConj(d, a);
+
+		Matrix4d result;
+		result.col(0) = toPoint(2.0 * ab.real(), da + cb, 2.0 * cd.real());
+		result.col(1) = toPoint(2.0 * ab.imag(), Complex(0, 1) * (da - cb), 2.0 * cd.imag());
+		result.col(2) = toPoint(normA - normB, ca - db, normC - normD);
+		result.col(3) = toPoint(normA + normB, ca + db, normC + normD);
+		return result;
+	}
+
+	Eigen::Matrix4f toMatrix4f() const {
+		return toMatrix4d().cast<float>();
+	}
+
+private:
+	Matrix2cd matrix; // [a b; c d]
+
+	Complex a() const { return matrix(0, 0); }
+	Complex b() const { return matrix(0, 1); }
+	Complex c() const { return matrix(1, 0); }
+	Complex d() const { return matrix(1, 1); }
+
+	SpinIsometry& operator+=(const SpinIsometry& other) {
+		matrix += other.matrix;
+		return *this;
+	}
+
+	// The Hermitian matrices for the unit x, y, z and w vectors
+	static SpinIsometry basis(int index) {
+		switch (index) {
+		case 0: return SpinIsometry(0, 1, 1, 0);
+		case 1: return SpinIsometry(0, Complex(0, -1), Complex(0, 1), 0);
+		case 2: return SpinIsometry(1, 0, 0, -1);
+		default: return SpinIsometry(1, 0, 0, 1);
+		}
+	}
+
+	static SpinIsometry fromPoint(const Vector4d& point) {
+		return SpinIsometry(point.w() + point.z(), Complex(point.x(), -point.y()), Complex(point.x(), point.y()), point.w() - point.z());
+	}
+
+	// Reads a point from a Hermitian matrix, given its top-left, bottom-left and bottom-right entries
+	static Vector4d toPoint(double topLeft, Complex bottomLeft, double bottomRight) {
+		return Vector4d(bottomLeft.real(), bottomLeft.imag(), (topLeft - bottomRight) * 0.5, (topLeft + bottomRight) * 0.5);
+	}
+
+	// Plain complex multiplication, without std::complex's checks for infinities and NaNs
+	static Complex multiply(Complex x, Complex y) {
+		return Complex(x.real() * y.real() - x.imag() * y.imag(), x.real() * y.imag() + x.imag() * y.real());
+	}
+
+	// x times the conjugate of y
+	static Complex multiplyConj(Complex x, Complex y) {
+		return Complex(x.real() * y.real() + x.imag() * y.imag(), x.imag() * y.real() - x.real() * y.imag());
+	}
+};
@@ -17,6 +17,9 @@
 #pragma once
 #include <array>
 #include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 #include <iostream>
 #include "VectorMath.h"
 
@@ -63,22 +66,45 @@ public:
 		return faces[faceIndex]->orientation;
 	}
 
+	size_t getNumVertices() {
+		return vertices.size();
+	}
+
+	// Which corner of the seed face the vertex is an image of, which determines how many faces meet there
+	unsigned getVertexType(size_t vertexIndex) {
+		return vertices[vertexIndex]->type;
+	}
+
+	Vector4d getVertexPos(size_t vertexIndex) {
+		return vertices[vertexIndex]->pos;
+	}
+
 	void testTessellation() {
+		createSeedFaces();
+
+		for (unsigned i=0; i<18; ++i) {
+			grow();
+		}
+	}
+
+	// Creates the faces around the seed face's first vertex
+	void createSeedFaces() {
 		Face* currentFace = &createSeedFace();
 		unsigned nextEdge = 1;
 		while (currentFace->adjacentFaces[nextEdge] == nullptr) {
 			currentFace = &createAdjacentFace(*currentFace, nextEdge);
 			nextEdge = 3u - nextEdge;
 		}
+	}
 
-		for (unsigned i=0; i<18; ++i) {
-			size_t currentCount = faces.size();
+	// Adds one round of faces, filling in every missing neighbor of the existing faces
+	void grow() {
+		size_t currentCount = faces.size();
 
-			for (size_t j=0; j<currentCount; ++j) {
-				for (unsigned k=0; k<n; ++k) {
-					if (faces[j]->adjacentFaces[k] == nullptr) {
-						Face& face = createAdjacentFace(*faces[j], k);
-					}
+		for (size_t j=0; j<currentCount; ++j) {
+			for (unsigned k=0; k<n; ++k) {
+				if (faces[j]->adjacentFaces[k] == nullptr) {
+					createAdjacentFace(*faces[j], k);
 				}
 			}
 		}
@@ -174,7 +200,7 @@ private:
 		PolarityArray<unsigned> seedVertexIndices((edge + 2u) % n, (edge + 1u) % n);
 
 		int orientation = -face.orientation;
-		std::unique_ptr<Face> newFacePtr = std::make_unique<Face>(orientation, face.pos * reflections[edge]);
+		std::unique_ptr<Face> newFacePtr = std::make_unique<Face>(orientation, HyperbolicGeometry::correctDrift(face.pos * reflections[edge]));
 		Face& newFace = *newFacePtr;
 
 		// Sort out all direct adjacencies
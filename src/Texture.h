@@ -20,18 +20,43 @@
 #include <vector>
 
 #include "TextureData.h"
+#include "TextureCache.h"
 
 class Texture {
 public:
 	Texture(const TextureData& data, GLint wrap) {
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, data.width, data.height, 0, GL_RGB, GL_UNSIGNED_BYTE, data.data.data());
+		create(wrap);
+		// Rows are tightly packed, which an RGB8 row of odd width is not by GL's default alignment of 4
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		bool alpha = data.channels == 4;
+		glTexImage2D(GL_TEXTURE_2D, 0, alpha ? GL_SRGB8_ALPHA8 : GL_SRGB8, data.width, data.height, 0, alpha ? GL_RGBA : GL_RGB,
+			GL_UNSIGNED_BYTE, data.data.data());
 		glGenerateMipmap(GL_TEXTURE_2D);
 	}
 
+	// Uploads every mip level as it is, so the driver has nothing to generate or convert. The format must be supported.
+	Texture(const CachedTexture& cached, GLint wrap) {
+		create(wrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(cached.levels.size()) - 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (std::size_t i = 0; i < cached.levels.size(); ++i) {
+			const TextureLevel& level = cached.levels[i];
+			GLint levelIndex = static_cast<GLint>(i);
+			switch (cached.format) {
+			case TextureFormat::RGB8:
+				glTexImage2D(GL_TEXTURE_2D, levelIndex, GL_SRGB8, level.width, level.height, 0, GL_RGB, GL_UNSIGNED_BYTE, level.data);
+				break;
+			case TextureFormat::RGBA8:
+				glTexImage2D(GL_TEXTURE_2D, levelIndex, GL_SRGB8_ALPHA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+				break;
+			case TextureFormat::BC1:
+				glCompressedTexImage2D(GL_TEXTURE_2D, levelIndex, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, level.width, level.height, 0,
+					static_cast<GLsizei>(level.size), level.data);
+				break;
+			}
+		}
+	}
+
 	~Texture() {
 		glDeleteTextures(1, &texture);
 	}
@@ -39,10 +64,22 @@ public:
 	Texture(const Texture&) = delete;
 	Texture& operator=(const Texture&) = delete;
 
+	// Requires a current GL context. BC1 needs both the S3TC extension and the sRGB extension that adds its sRGB form.
+	static bool isSupported(TextureFormat format) {
+		return format != TextureFormat::BC1 || (GLAD_GL_EXT_texture_compression_s3tc && GLAD_GL_EXT_texture_sRGB);
+	}
+
 	void bind() {
 		glBindTexture(GL_TEXTURE_2D, texture);
 	}
 
 private:
 	GLuint texture;
+
+	void create(GLint wrap) {
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+	}
 };
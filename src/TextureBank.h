@@ -16,18 +16,75 @@
 
 #pragma once
 
+#include <chrono>
+#include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 #include "Texture.h"
-#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "JobSystem.h"
+#include "RenderHandles.h"
 
-enum class TextureHandle {PERLIN, TILE, BLANK};
+// How one texture was loaded, for startup reports
+class TextureLoadStatistics {
+public:
+	std::string name;
+	int width;
+	int height;
+	TextureFormat format;
+	std::size_t levels;
+	std::size_t bytes; // Of every level, which is roughly the video memory the texture takes
+	bool converted; // Whether the cache was missing or stale, so the PNG was decoded and converted
+	double loadMilliseconds; // On a worker thread, so loads overlap with each other and with uploads
+	double uploadMilliseconds;
+};
 
 class TextureBank {
 public:
-	TextureBank() {
-		textures[TextureHandle::PERLIN] = std::make_unique<Texture>(TextureLoader::loadTexture("perlin.png"), GL_CLAMP_TO_EDGE);
-		textures[TextureHandle::TILE] = std::make_unique<Texture>(TextureLoader::loadTexture("tile.png"), GL_REPEAT);
+	// Requires a current GL context. The textures are loaded through TextureCache on the job system, and each is
+	// uploaded on the calling thread as soon as it is loaded, while the rest are still loading. Unless compression is
+	// turned off or the driver cannot use it, the textures are uploaded as BC1.
+	explicit TextureBank(JobSystem& jobs, bool compress = true) {
+		std::vector<TextureFile> files {
+			{TextureHandle::PERLIN, "perlin.png", GL_CLAMP_TO_EDGE},
+			{TextureHandle::TILE, "tile.png", GL_REPEAT},
+		};
+		TextureFormat format = compress && Texture::isSupported(TextureFormat::BC1) ? TextureFormat::BC1 : TextureFormat::RGB8;
+
+		std::vector<CachedTexture> loaded(files.size());
+		std::vector<double> loadMilliseconds(files.size());
+		std::vector<JobSystem::JobGroup> groups(files.size());
+		for (std::size_t i = 0; i < files.size(); ++i) {
+			jobs.run(groups[i], [&files, &loaded, &loadMilliseconds, format, i]() {
+				Clock::time_point start = Clock::now();
+				loaded[i] = TextureCache::load(files[i].name, format);
+				loadMilliseconds[i] = getMillisecondsSince(start);
+			});
+		}
+
+		for (std::size_t i = 0; i < files.size(); ++i) {
+			try {
+				jobs.wait(groups[i]);
+			} catch (...) {
+				// The other loads write into these locals, so they must finish before the exception leaves
+				for (std::size_t j = i + 1; j < files.size(); ++j) {
+					try {
+						jobs.wait(groups[j]);
+					} catch (...) {
+					}
+				}
+				throw;
+			}
+
+			const CachedTexture& texture = loaded[i];
+			Clock::time_point start = Clock::now();
+			textures[files[i].handle] = std::make_unique<Texture>(texture, files[i].wrap);
+			loadStatistics.push_back({files[i].name, texture.levels[0].width, texture.levels[0].height, format,
+				texture.levels.size(), texture.getSize(), texture.converted, loadMilliseconds[i], getMillisecondsSince(start)});
+			loaded[i] = CachedTexture(); // Unmaps the file while the rest are uploaded
+		}
+
 		textures[TextureHandle::BLANK] = std::make_unique<Texture>(makeBlankTexture(), GL_REPEAT);
 	}
 
@@ -35,8 +92,27 @@ public:
 		textures[textureHandle]->bind();
 	}
 
+	// One entry for each texture loaded from a file, in the order they were uploaded
+	const std::vector<TextureLoadStatistics>& getLoadStatistics() const {
+		return loadStatistics;
+	}
+
 private:
+	using Clock = std::chrono::steady_clock;
+
+	class TextureFile {
+	public:
+		TextureHandle handle;
+		std::string name;
+		GLint wrap;
+	};
+
 	std::unordered_map<TextureHandle, std::unique_ptr<Texture>> textures;
+	std::vector<TextureLoadStatistics> loadStatistics;
+
+	static double getMillisecondsSince(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
 
 	TextureData makeBlankTexture() {
 		TextureData data(1, 1);
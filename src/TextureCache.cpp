@@ -0,0 +1,207 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include "TextureCache.h"
+#include "TextureConversion.h"
+#include "TextureLoader.h"
+
+// File layout, in native byte order since the file never leaves the machine that wrote it: a Header, a LevelEntry for
+// each mip level from the largest down, and then the pixels of each level, starting at its entry's offset
+namespace {
+	const std::uint32_t magic = 0x58545748; // "HWTX"
+	const std::uint32_t version = 1;
+	const std::size_t levelAlignment = 16;
+	const std::uint32_t maxLevels = 32;
+
+	class Header {
+	public:
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t format;
+		std::uint32_t levelCount;
+		std::uint64_t sourceSize;
+		std::uint64_t sourceHash;
+	};
+
+	class LevelEntry {
+	public:
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint64_t offset;
+		std::uint64_t size;
+	};
+
+	std::vector<unsigned char> readFile(const std::string& path) {
+		FILE* file = fopen(path.c_str(), "rb");
+		if (!file) {
+			throw std::runtime_error("Texture file not found: " + path);
+		}
+		std::vector<unsigned char> bytes;
+		unsigned char buffer[65536];
+		std::size_t count;
+		while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+			bytes.insert(bytes.end(), buffer, buffer + count);
+		}
+		fclose(file);
+		return bytes;
+	}
+
+	// 64-bit FNV-1a, as ShaderProgramCache uses to tell shader revisions apart
+	std::uint64_t hashBytes(const std::vector<unsigned char>& bytes) {
+		std::uint64_t state = 0xcbf29ce484222325ull;
+		for (unsigned char byte : bytes) {
+			state ^= byte;
+			state *= 0x100000001b3ull;
+		}
+		return state;
+	}
+
+	int getChannels(TextureFormat format) {
+		return format == TextureFormat::RGBA8 ? 4 : 3;
+	}
+
+	std::size_t getLevelSize(TextureFormat format, int width, int height) {
+		if (format == TextureFormat::BC1) {
+			return TextureConversion::getBc1Size(width, height);
+		}
+		return static_cast<std::size_t>(width) * height * getChannels(format);
+	}
+
+	std::size_t alignLevel(std::size_t offset) {
+		return (offset + levelAlignment - 1) / levelAlignment * levelAlignment;
+	}
+
+	// Fills in the levels if the bytes are a complete cache of the source in the format, and returns false otherwise
+	bool readLevels(const unsigned char* data, std::size_t size, TextureFormat format, std::uint64_t sourceSize,
+			std::uint64_t sourceHash, std::vector<TextureLevel>& levels) {
+		Header header;
+		if (size < sizeof(header)) {
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (header.magic != magic || header.version != version || header.format != static_cast<std::uint32_t>(format)
+				|| header.sourceSize != sourceSize || header.sourceHash != sourceHash
+				|| header.levelCount == 0 || header.levelCount > maxLevels
+				|| size < sizeof(header) + header.levelCount * sizeof(LevelEntry)) {
+			return false;
+		}
+
+		std::size_t pixelsStart = sizeof(header) + header.levelCount * sizeof(LevelEntry);
+		levels.clear();
+		for (std::uint32_t i = 0; i < header.levelCount; ++i) {
+			LevelEntry entry;
+			std::memcpy(&entry, data + sizeof(header) + i * sizeof(LevelEntry), sizeof(entry));
+
+			// Each level must be half the size of the one before, and the last must be 1x1, as GL requires
+			bool expectedSize = i == 0 ? entry.width > 0 && entry.height > 0
+				: entry.width == std::max<std::uint32_t>(levels.back().width / 2, 1)
+					&& entry.height == std::max<std::uint32_t>(levels.back().height / 2, 1);
+			if (!expectedSize || entry.size != getLevelSize(format, entry.width, entry.height)
+					|| entry.offset < pixelsStart || entry.offset > size || entry.size > size - entry.offset) {
+				return false;
+			}
+			levels.push_back({static_cast<int>(entry.width), static_cast<int>(entry.height), data + entry.offset,
+				static_cast<std::size_t>(entry.size)});
+		}
+		return levels.back().width == 1 && levels.back().height == 1;
+	}
+
+	std::vector<unsigned char> convert(const TextureData& image, TextureFormat format, std::uint64_t sourceSize,
+			std::uint64_t sourceHash) {
+		std::vector<TextureData> mipChain = TextureConversion::buildMipChain(image);
+		std::vector<std::vector<unsigned char>> levelPixels;
+		for (TextureData& level : mipChain) {
+			if (format == TextureFormat::BC1) {
+				levelPixels.push_back(TextureConversion::encodeBc1(level));
+			} else {
+				levelPixels.push_back(std::move(level.data));
+			}
+		}
+
+		Header header {magic, version, static_cast<std::uint32_t>(format), static_cast<std::uint32_t>(mipChain.size()),
+			sourceSize, sourceHash};
+		std::vector<LevelEntry> entries;
+		std::size_t offset = sizeof(header) + mipChain.size() * sizeof(LevelEntry);
+		for (std::size_t i = 0; i < mipChain.size(); ++i) {
+			offset = alignLevel(offset);
+			entries.push_back({static_cast<std::uint32_t>(mipChain[i].width), static_cast<std::uint32_t>(mipChain[i].height),
+				offset, levelPixels[i].size()});
+			offset += levelPixels[i].size();
+		}
+
+		std::vector<unsigned char> bytes(offset);
+		std::memcpy(bytes.data(), &header, sizeof(header));
+		std::memcpy(bytes.data() + sizeof(header), entries.data(), entries.size() * sizeof(LevelEntry));
+		for (std::size_t i = 0; i < entries.size(); ++i) {
+			std::memcpy(bytes.data() + entries[i].offset, levelPixels[i].data(), levelPixels[i].size());
+		}
+		return bytes;
+	}
+
+	// Writes to a temporary file first, so that a cache file is either complete or missing, never half written
+	bool writeFile(const std::string& path, const std::vector<unsigned char>& bytes) {
+		std::string temporaryPath = path + ".tmp";
+		FILE* file = fopen(temporaryPath.c_str(), "wb");
+		if (!file) {
+			return false;
+		}
+		bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+		written = fclose(file) == 0 && written;
+
+		// Renaming over an existing file fails on Windows, so any stale cache is removed first
+		std::remove(path.c_str());
+		if (!written || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+		return true;
+	}
+}
+
+CachedTexture TextureCache::load(const std::string& name, TextureFormat format) {
+	std::vector<unsigned char> source = readFile("textures/" + name);
+	std::uint64_t sourceHash = hashBytes(source);
+	std::string cachePath = getCachePath(name, format);
+
+	CachedTexture texture;
+	texture.format = format;
+	try {
+		texture.file = MappedFile(cachePath);
+		if (readLevels(texture.file.getData(), texture.file.getSize(), format, source.size(), sourceHash, texture.levels)) {
+			return texture;
+		}
+	} catch (const std::runtime_error&) {
+		// There is no cache yet, which is no different from an outdated one
+	}
+
+	texture.file = MappedFile();
+	texture.converted = true;
+	texture.bytes = convert(TextureLoader::loadTexture(name, getChannels(format)), format, source.size(), sourceHash);
+	readLevels(texture.bytes.data(), texture.bytes.size(), format, source.size(), sourceHash, texture.levels);
+	if (!writeFile(cachePath, texture.bytes)) {
+		fprintf(stderr, "Warning: Failed to write texture cache to %s\n", cachePath.c_str());
+	}
+	return texture;
+}
+
+std::string TextureCache::getCachePath(const std::string& name, TextureFormat format) {
+	const char* formatNames[] = {"rgb8", "rgba8", "bc1"};
+	return "textures/" + name + "." + formatNames[static_cast<int>(format)] + ".cache";
+}
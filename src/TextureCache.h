@@ -0,0 +1,72 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// The layout of a texture's pixels in a TextureCache file, which is also how they are uploaded
+enum class TextureFormat : std::uint32_t {RGB8, RGBA8, BC1};
+
+// One mip level of a CachedTexture, pointing into memory the CachedTexture owns
+class TextureLevel {
+public:
+	int width;
+	int height;
+	const unsigned char* data;
+	std::size_t size;
+};
+
+// Every mip level of a texture, ready to upload as is. The levels point into the memory-mapped cache file, or into a
+// copy in memory if the cache file could not be written.
+class CachedTexture {
+public:
+	TextureFormat format;
+	std::vector<TextureLevel> levels;
+	bool converted = false; // Whether the PNG had to be decoded and converted because the cache was missing or stale
+
+	// The bytes of every level, which is roughly how much video memory the texture takes
+	std::size_t getSize() const {
+		std::size_t size = 0;
+		for (const TextureLevel& level : levels) {
+			size += level.size;
+		}
+		return size;
+	}
+
+private:
+	friend class TextureCache;
+
+	MappedFile file;
+	std::vector<unsigned char> bytes;
+};
+
+// Keeps each texture in the textures directory converted to the format it is uploaded in, with every mip level already
+// built, in a cache file next to the PNG. Each file records the size and a hash of the PNG it came from, so replacing
+// or editing the PNG makes the next load convert it again.
+class TextureCache {
+public:
+	// Loads textures/<name> in the given format, from the cache if it is up to date, and otherwise by decoding and
+	// converting the PNG and then writing the cache. A cache that cannot be written only prints a warning. Throws
+	// std::runtime_error if the PNG is missing or cannot be decoded. Different textures can be loaded from several
+	// threads at once.
+	static CachedTexture load(const std::string& name, TextureFormat format);
+
+	static std::string getCachePath(const std::string& name, TextureFormat format);
+};
@@ -0,0 +1,260 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "TextureConversion.h"
+
+namespace {
+	// linearValues[k] is sRGB byte k in linear color, and thresholds[k] is the linear color halfway, in sRGB terms,
+	// between bytes k and k + 1, so rounding a linear color to the nearest byte is a binary search
+	class SrgbTables {
+	public:
+		std::array<float, 256> linearValues;
+		std::array<float, 255> thresholds;
+
+		SrgbTables() {
+			for (int k = 0; k < 256; ++k) {
+				linearValues[k] = toLinear(k / 255.0);
+			}
+			for (int k = 0; k < 255; ++k) {
+				thresholds[k] = toLinear((k + 0.5) / 255.0);
+			}
+		}
+
+		unsigned char toByte(float linear) const {
+			return static_cast<unsigned char>(std::upper_bound(thresholds.begin(), thresholds.end(), linear) - thresholds.begin());
+		}
+
+	private:
+		static float toLinear(double srgb) {
+			return static_cast<float>(srgb <= 0.04045 ? srgb / 12.92 : std::pow((srgb + 0.055) / 1.055, 2.4));
+		}
+	};
+
+	const SrgbTables& getSrgbTables() {
+		static const SrgbTables tables;
+		return tables;
+	}
+
+	TextureData halve(const TextureData& image) {
+		const SrgbTables& srgb = getSrgbTables();
+		int channels = image.channels;
+		TextureData result(std::max(image.width / 2, 1), std::max(image.height / 2, 1), channels);
+		result.data.resize(result.getRowSize() * result.height);
+
+		for (int y = 0; y < result.height; ++y) {
+			const unsigned char* rows[2] = {
+				&image.data[2 * y * image.getRowSize()],
+				&image.data[std::min(2 * y + 1, image.height - 1) * image.getRowSize()]};
+			unsigned char* out = &result.data[y * result.getRowSize()];
+			for (int x = 0; x < result.width; ++x) {
+				int columns[2] = {2 * x * channels, std::min(2 * x + 1, image.width - 1) * channels};
+				for (int channel = 0; channel < channels; ++channel) {
+					if (channel == 3) {
+						int sum = rows[0][columns[0] + 3] + rows[0][columns[1] + 3] + rows[1][columns[0] + 3] + rows[1][columns[1] + 3];
+						out[x * channels + 3] = static_cast<unsigned char>((sum + 2) / 4);
+					} else {
+						float sum = srgb.linearValues[rows[0][columns[0] + channel]] + srgb.linearValues[rows[0][columns[1] + channel]]
+							+ srgb.linearValues[rows[1][columns[0] + channel]] + srgb.linearValues[rows[1][columns[1] + channel]];
+						out[x * channels + channel] = srgb.toByte(sum * 0.25f);
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	std::uint16_t packColor(const float color[3]) {
+		int r = static_cast<int>(std::lround(std::min(std::max(color[0], 0.0f), 255.0f) * 31 / 255));
+		int g = static_cast<int>(std::lround(std::min(std::max(color[1], 0.0f), 255.0f) * 63 / 255));
+		int b = static_cast<int>(std::lround(std::min(std::max(color[2], 0.0f), 255.0f) * 31 / 255));
+		return static_cast<std::uint16_t>(r << 11 | g << 5 | b);
+	}
+
+	void unpackColor(std::uint16_t packed, int color[3]) {
+		int r = packed >> 11, g = (packed >> 5) & 63, b = packed & 31;
+		color[0] = r << 3 | r >> 2;
+		color[1] = g << 2 | g >> 4;
+		color[2] = b << 3 | b >> 2;
+	}
+
+	// The four colors a block can use, in index order, for a block whose first color is greater than its second
+	void getPalette(std::uint16_t color0, std::uint16_t color1, int palette[4][3]) {
+		unpackColor(color0, palette[0]);
+		unpackColor(color1, palette[1]);
+		for (int channel = 0; channel < 3; ++channel) {
+			palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+			palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+		}
+	}
+
+	void encodeBlock(const int pixels[16][3], unsigned char* out) {
+		float mean[3] = {0, 0, 0};
+		for (int i = 0; i < 16; ++i) {
+			for (int channel = 0; channel < 3; ++channel) {
+				mean[channel] += pixels[i][channel] / 16.0f;
+			}
+		}
+
+		float covariance[3][3] = {};
+		for (int i = 0; i < 16; ++i) {
+			float offset[3] = {pixels[i][0] - mean[0], pixels[i][1] - mean[1], pixels[i][2] - mean[2]};
+			for (int row = 0; row < 3; ++row) {
+				for (int column = 0; column < 3; ++column) {
+					covariance[row][column] += offset[row] * offset[column];
+				}
+			}
+		}
+
+		// Power iteration converges quickly on the principal axis, since colors in a block are usually close to a line
+		float axis[3] = {1, 1, 1};
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			float next[3];
+			for (int row = 0; row < 3; ++row) {
+				next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+			}
+			float length = std::max(std::abs(next[0]), std::max(std::abs(next[1]), std::abs(next[2])));
+			if (length < 1e-6f) {
+				break; // Every pixel is the same color
+			}
+			for (int channel = 0; channel < 3; ++channel) {
+				axis[channel] = next[channel] / length;
+			}
+		}
+		float axisSquaredLength = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+		float minProjection = 0, maxProjection = 0;
+		for (int i = 0; i < 16; ++i) {
+			float projection = ((pixels[i][0] - mean[0]) * axis[0] + (pixels[i][1] - mean[1]) * axis[1]
+				+ (pixels[i][2] - mean[2]) * axis[2]) / axisSquaredLength;
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		float endpoints[2][3];
+		for (int channel = 0; channel < 3; ++channel) {
+			endpoints[0][channel] = mean[channel] + axis[channel] * maxProjection;
+			endpoints[1][channel] = mean[channel] + axis[channel] * minProjection;
+		}
+		std::uint16_t color0 = packColor(endpoints[0]), color1 = packColor(endpoints[1]);
+
+		// The first color must be the greater one for the block to use four colors rather than three and black
+		if (color0 < color1) {
+			std::swap(color0, color1);
+		}
+
+		std::uint32_t indices = 0;
+		if (color0 != color1) {
+			int palette[4][3];
+			getPalette(color0, color1, palette);
+			for (int i = 0; i < 16; ++i) {
+				int bestIndex = 0, bestDistance = 0;
+				for (int index = 0; index < 4; ++index) {
+					int distance = 0;
+					for (int channel = 0; channel < 3; ++channel) {
+						int difference = pixels[i][channel] - palette[index][channel];
+						distance += difference * difference;
+					}
+					if (index == 0 || distance < bestDistance) {
+						bestIndex = index;
+						bestDistance = distance;
+					}
+				}
+				indices |= static_cast<std::uint32_t>(bestIndex) << (2 * i);
+			}
+		}
+
+		out[0] = static_cast<unsigned char>(color0);
+		out[1] = static_cast<unsigned char>(color0 >> 8);
+		out[2] = static_cast<unsigned char>(color1);
+		out[3] = static_cast<unsigned char>(color1 >> 8);
+		for (int i = 0; i < 4; ++i) {
+			out[4 + i] = static_cast<unsigned char>(indices >> (8 * i));
+		}
+	}
+}
+
+namespace TextureConversion {
+	std::vector<TextureData> buildMipChain(const TextureData& image) {
+		std::vector<TextureData> levels {image};
+		while (levels.back().width > 1 || levels.back().height > 1) {
+			levels.push_back(halve(levels.back()));
+		}
+		return levels;
+	}
+
+	std::size_t getBc1Size(int width, int height) {
+		return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * 8;
+	}
+
+	std::vector<unsigned char> encodeBc1(const TextureData& image) {
+		std::vector<unsigned char> blocks(getBc1Size(image.width, image.height));
+		unsigned char* out = blocks.data();
+		for (int blockY = 0; blockY < image.height; blockY += 4) {
+			for (int blockX = 0; blockX < image.width; blockX += 4) {
+				// Pixels past the edge of the image repeat the last row or column, so they do not skew the colors
+				int pixels[16][3];
+				for (int i = 0; i < 16; ++i) {
+					int x = std::min(blockX + i % 4, image.width - 1);
+					int y = std::min(blockY + i / 4, image.height - 1);
+					const unsigned char* pixel = &image.data[y * image.getRowSize() + x * image.channels];
+					for (int channel = 0; channel < 3; ++channel) {
+						pixels[i][channel] = pixel[channel];
+					}
+				}
+				encodeBlock(pixels, out);
+				out += 8;
+			}
+		}
+		return blocks;
+	}
+
+	TextureData decodeBc1(const std::vector<unsigned char>& blocks, int width, int height) {
+		TextureData image(width, height);
+		image.data.resize(image.getRowSize() * height);
+		const unsigned char* block = blocks.data();
+		for (int blockY = 0; blockY < height; blockY += 4) {
+			for (int blockX = 0; blockX < width; blockX += 4) {
+				std::uint16_t color0 = static_cast<std::uint16_t>(block[0] | block[1] << 8);
+				std::uint16_t color1 = static_cast<std::uint16_t>(block[2] | block[3] << 8);
+				std::uint32_t indices = block[4] | block[5] << 8 | block[6] << 16 | static_cast<std::uint32_t>(block[7]) << 24;
+				int palette[4][3];
+				getPalette(color0, color1, palette);
+				if (color0 <= color1) {
+					// The three-color mode, which encodeBc1 only produces for single-color blocks
+					for (int channel = 0; channel < 3; ++channel) {
+						palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+						palette[3][channel] = 0;
+					}
+				}
+
+				for (int i = 0; i < 16; ++i) {
+					int x = blockX + i % 4, y = blockY + i / 4;
+					if (x < width && y < height) {
+						const int* color = palette[(indices >> (2 * i)) & 3];
+						for (int channel = 0; channel < 3; ++channel) {
+							image.data[y * image.getRowSize() + x * 3 + channel] = static_cast<unsigned char>(color[channel]);
+						}
+					}
+				}
+				block += 8;
+			}
+		}
+		return image;
+	}
+}
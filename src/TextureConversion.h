@@ -0,0 +1,37 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#pragma once
+
+#include <vector>
+#include "TextureData.h"
+
+// Turns decoded images into what Texture uploads, so the work can be done once and cached instead of by the driver on
+// every launch. None of these need a GL context.
+namespace TextureConversion {
+	// Every mip level GL expects for the image, from the image itself down to 1x1. Each level halves the size of the
+	// one before, rounding down, and averages the 2x2 pixels it covers in linear color, as the colors are sRGB.
+	std::vector<TextureData> buildMipChain(const TextureData& image);
+
+	// The size of the image's BC1 (DXT1) encoding, which takes 8 bytes for each 4x4 block, counting partial blocks
+	std::size_t getBc1Size(int width, int height);
+
+	// Encodes an RGB8 or RGBA8 image as BC1 without alpha, in the order glCompressedTexImage2D takes the blocks. The
+	// encoding fits the two colors of each block to the principal axis of its pixels' colors.
+	std::vector<unsigned char> encodeBc1(const TextureData& image);
+
+	// Decodes a BC1 encoding back to RGB8, to measure how much encoding loses
+	TextureData decodeBc1(const std::vector<unsigned char>& blocks, int width, int height);
+}
@@ -16,13 +16,19 @@
 
 #pragma once
 
-#include <GLFW/glfw3.h>
+#include <cstddef>
 #include <vector>
 
+// An image laid out as GL uploads it: rows from top to bottom, with no padding between them, and one byte per channel
 class TextureData {
 public:
-	TextureData(int width, int height): width(width), height(height) {}
+	TextureData(int width, int height, int channels = 3): width(width), height(height), channels(channels) {}
 	int width;
 	int height;
-	std::vector<GLubyte> data;
+	int channels; // 3 for RGB8 or 4 for RGBA8
+	std::vector<unsigned char> data;
+
+	std::size_t getRowSize() const {
+		return static_cast<std::size_t>(width) * channels;
+	}
 };
@@ -21,35 +21,42 @@
 
 #include "TextureLoader.h"
 
-namespace TextureLoader {
-	TextureData loadTexture(const std::string& name) {
-		std::string texturePath = "textures/" + name;
-
-		FILE *fp = fopen(texturePath.c_str(), "rb");
-		if (!fp) {
-			throw std::runtime_error("Texture file not found");
-		}
-
-		png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-		if (!png) {
-			throw std::runtime_error("Failed to load png");
+namespace {
+	// Frees everything a read allocated, however it ends. The structs are created before setjmp and never reassigned
+	// after it, so they are still valid when libpng jumps back on an error.
+	class PngReadGuard {
+	public:
+		FILE* file = nullptr;
+		png_structp png = nullptr;
+		png_infop info = nullptr;
+
+		~PngReadGuard() {
+			if (png) {
+				png_destroy_read_struct(&png, info ? &info : nullptr, nullptr);
+			}
+			if (file) {
+				fclose(file);
+			}
 		}
+	};
 
-		png_infop info = png_create_info_struct(png);
-		if (!info) {
-			throw std::runtime_error("Failed to load png info");
-		}
+	// libpng reports errors by jumping back to the setjmp, skipping the destructors of everything in between, so the
+	// reads that can fail are kept in functions that only touch the libpng structs, raw pointers and plain values.
+	// Each returns false if libpng failed, and the caller throws.
 
+	// Reads the header and sets up libpng to decode each row into the layout GL wants, with the given channel count
+	bool readPngHeader(png_structp png, png_infop info, FILE* file, int channels, png_uint_32* width, png_uint_32* height,
+			png_size_t* rowSize) {
 		if (setjmp(png_jmpbuf(png))) {
-			throw std::runtime_error("Failed to setjmp");
+			return false;
 		}
 
-		png_init_io(png, fp);
+		png_init_io(png, file);
 
 		png_read_info(png, info);
 
-		int width = png_get_image_width(png, info);
-		int height = png_get_image_height(png, info);
+		*width = png_get_image_width(png, info);
+		*height = png_get_image_height(png, info);
 		png_byte color_type = png_get_color_type(png, info);
 		png_byte bit_depth = png_get_bit_depth(png, info);
 
@@ -65,44 +72,124 @@ namespace TextureLoader {
 			png_set_expand_gray_1_2_4_to_8(png);
 		}
 
-		if (png_get_valid(png, info, PNG_INFO_tRNS)) {
-			png_set_tRNS_to_alpha(png);
-		}
-
-		if (color_type == PNG_COLOR_TYPE_RGB ||
-			color_type == PNG_COLOR_TYPE_GRAY ||
-			color_type == PNG_COLOR_TYPE_PALETTE) {
-			png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
-		}
-
 		if (color_type == PNG_COLOR_TYPE_GRAY ||
 			color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
 			png_set_gray_to_rgb(png);
 		}
 
+		// libpng adds or drops the alpha channel itself, so each row comes out in exactly the layout GL wants
+		if (channels == 4) {
+			if (png_get_valid(png, info, PNG_INFO_tRNS)) {
+				png_set_tRNS_to_alpha(png);
+			} else if (!(color_type & PNG_COLOR_MASK_ALPHA)) {
+				png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+			}
+		} else if (color_type & PNG_COLOR_MASK_ALPHA) {
+			png_set_strip_alpha(png);
+		}
+
+		png_set_interlace_handling(png);
 		png_read_update_info(png, info);
 
-		png_bytep* row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * height);
-		for(int y = 0; y < height; y++) {
-			row_pointers[y] = (png_byte*)malloc(png_get_rowbytes(png,info));
+		*rowSize = png_get_rowbytes(png, info);
+		return true;
+	}
+
+	// Decodes the image into the rows, which must already be allocated
+	bool readPngImage(png_structp png, png_bytepp rows) {
+		if (setjmp(png_jmpbuf(png))) {
+			return false;
 		}
 
-		png_read_image(png, row_pointers);
+		png_read_image(png, rows);
+		png_read_end(png, nullptr);
+		return true;
+	}
+}
 
-		fclose(fp);
+namespace TextureLoader {
+	TextureData loadTexture(const std::string& name, int channels) {
+		if (channels != 3 && channels != 4) {
+			throw std::runtime_error("Textures must have 3 or 4 channels");
+		}
+		std::string texturePath = "textures/" + name;
+
+		PngReadGuard guard;
+		guard.file = fopen(texturePath.c_str(), "rb");
+		if (!guard.file) {
+			throw std::runtime_error("Texture file not found: " + texturePath);
+		}
+
+		guard.png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+		if (!guard.png) {
+			throw std::runtime_error("Failed to load png");
+		}
 
-		png_destroy_read_struct(&png, &info, NULL);
+		guard.info = png_create_info_struct(guard.png);
+		if (!guard.info) {
+			throw std::runtime_error("Failed to load png info");
+		}
 
-		TextureData result(width, height);
+		png_uint_32 width;
+		png_uint_32 height;
+		png_size_t rowSize;
+		if (!readPngHeader(guard.png, guard.info, guard.file, channels, &width, &height, &rowSize)) {
+			throw std::runtime_error("Failed to decode " + texturePath);
+		}
 
-		for (int y=0; y<height; ++y) {
-			for (int x=0; x<width; ++x) {
-				result.data.push_back(row_pointers[y][4*x]);
-				result.data.push_back(row_pointers[y][4*x+1]);
-				result.data.push_back(row_pointers[y][4*x+2]);
-			}
+		TextureData result(width, height, channels);
+		if (rowSize != result.getRowSize()) {
+			throw std::runtime_error("Unexpected pixel layout in " + texturePath);
+		}
+
+		result.data.resize(result.getRowSize() * height);
+		std::vector<png_bytep> rows(height);
+		for (png_uint_32 y = 0; y < height; ++y) {
+			rows[y] = &result.data[y * result.getRowSize()];
+		}
+		if (!readPngImage(guard.png, rows.data())) {
+			throw std::runtime_error("Failed to decode " + texturePath);
 		}
 
 		return result;
 	}
-}
\ No newline at end of file
+
+	void saveTexture(const std::string& path, const TextureData& data) {
+		FILE *fp = fopen(path.c_str(), "wb");
+		if (!fp) {
+			throw std::runtime_error("Could not open " + path + " for writing");
+		}
+
+		png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+		if (!png) {
+			fclose(fp);
+			throw std::runtime_error("Failed to save png");
+		}
+
+		png_infop info = png_create_info_struct(png);
+		if (!info) {
+			png_destroy_write_struct(&png, nullptr);
+			fclose(fp);
+			throw std::runtime_error("Failed to save png info");
+		}
+
+		if (setjmp(png_jmpbuf(png))) {
+			png_destroy_write_struct(&png, &info);
+			fclose(fp);
+			throw std::runtime_error("Failed to write " + path);
+		}
+
+		png_init_io(png, fp);
+		png_set_IHDR(png, info, data.width, data.height, 8, data.channels == 4 ? PNG_COLOR_TYPE_RGBA : PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+			PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+		png_write_info(png, info);
+
+		for (int y=0; y<data.height; ++y) {
+			png_write_row(png, const_cast<png_bytep>(&data.data[y * data.getRowSize()]));
+		}
+
+		png_write_end(png, nullptr);
+		png_destroy_write_struct(&png, &info);
+		fclose(fp);
+	}
+}
@@ -16,11 +16,17 @@
 
 #pragma once
 
-#include "glad.h"
+#include <string>
 #include <vector>
 
 #include "TextureData.h"
 
 namespace TextureLoader {
-	TextureData loadTexture(const std::string& name);
+	// Decodes a PNG from the textures directory straight into the returned data, converting it to RGB8 or RGBA8 with
+	// the given number of channels. Throws std::runtime_error if the file is missing or cannot be decoded. Safe to
+	// call from several threads at once.
+	TextureData loadTexture(const std::string& name, int channels = 3);
+
+	// Writes an RGB or RGBA PNG, according to the data's channels. Unlike loadTexture, the path is not relative to the textures directory.
+	void saveTexture(const std::string& path, const TextureData& data);
 }
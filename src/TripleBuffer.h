@@ -0,0 +1,64 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+
+// Passes the newest value from one writer thread to one reader thread without locks or waiting. The writer fills the
+// back slot and publishes it, and the reader takes whichever value was published last, so neither thread ever touches
+// the slot the other is using. Values the reader never took are overwritten.
+template<typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() = default;
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// Only for the writer. The slot keeps whatever it held before, so its allocations can be reused.
+	T& getBack() {
+		return slots[back];
+	}
+
+	// Only for the writer. Hands the back slot to the reader and takes a free one in its place.
+	void publish() {
+		back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+	}
+
+	// Only for the reader. Returns whether a value was published since the last call, and if so, makes it the front.
+	bool update() {
+		if ((middle.load(std::memory_order_relaxed) & freshBit) == 0) {
+			return false;
+		}
+		front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+		return true;
+	}
+
+	// Only for the reader. A default-constructed value until the first update that returns true.
+	const T& getFront() const {
+		return slots[front];
+	}
+
+private:
+	// The middle index carries a flag for whether it was published since the reader last took it
+	static constexpr unsigned indexMask = 3;
+	static constexpr unsigned freshBit = 4;
+
+	std::array<T, 3> slots;
+	unsigned back = 0;
+	std::atomic<unsigned> middle {1};
+	unsigned front = 2;
+};
@@ -0,0 +1,165 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include "glad.h"
+#include <Eigen/Dense>
+#include <array>
+#include <cstring>
+
+// Data shared by every draw call in a frame, uploaded once per frame. Corresponds to the FrameData block in the shaders.
+class FrameUniformBuffer {
+public:
+	FrameUniformBuffer() {
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+	}
+
+	~FrameUniformBuffer() {
+		glDeleteBuffers(1, &buffer);
+	}
+
+	FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+	FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+	void setProjection(const Eigen::Matrix4f& projection) {
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, offsetof(FrameData, projection), sizeof(FrameData::projection), projection.data());
+	}
+
+private:
+	// Must match the std140 layout of the FrameData block
+	struct FrameData {
+		GLfloat projection[16];
+	};
+
+	GLuint buffer;
+	static const GLuint binding = 0;
+	friend class ShaderProgram;
+};
+
+// Streams per-draw model-view matrices through a persistently mapped uniform buffer. The buffer is split into one
+// segment per frame in flight, guarded by fences, so that writing a matrix is a plain memory copy with no GL call and no
+// synchronization with draws that the GPU has not finished yet. The shader reads its matrix from the DrawData block,
+// which is bound to one block of the current segment at a time, at the index given by the drawIndex uniform.
+class TransformStream {
+public:
+	static bool isSupported() {
+		return GLAD_GL_ARB_buffer_storage && GLAD_GL_ARB_sync;
+	}
+
+	TransformStream(): buffer(0), mappedData(nullptr), capacity(0), segment(0), drawsInFrame(0) {
+		fences.fill(nullptr);
+		allocate(initialCapacity);
+	}
+
+	~TransformStream() {
+		release();
+	}
+
+	TransformStream(const TransformStream&) = delete;
+	TransformStream& operator=(const TransformStream&) = delete;
+
+	void beginFrame() {
+		segment = (segment + 1) % numSegments;
+		waitForSegment(segment);
+		drawsInFrame = 0;
+	}
+
+	void endFrame() {
+		fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	// Makes the given matrix available to the next draw call and returns the index the shader should read it from
+	GLint push(const Eigen::Matrix4f& modelView) {
+		if (drawsInFrame == capacity) {
+			// Draws already issued keep the old buffer alive, so it can be replaced in the middle of a frame
+			release();
+			allocate(capacity * 2);
+		}
+
+		GLint drawIndex = drawsInFrame % drawsPerBlock;
+		if (drawIndex == 0) {
+			glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, getOffset(drawsInFrame), blockSize);
+		}
+
+		std::memcpy(mappedData + getOffset(drawsInFrame) + drawIndex * matrixSize, modelView.data(), matrixSize);
+		++drawsInFrame;
+		return drawIndex;
+	}
+
+private:
+	static const GLuint binding = 1;
+	static const GLint drawsPerBlock = 256; // Keeps each block within the 16 KiB minimum guaranteed block size
+	static const GLsizeiptr matrixSize = 16 * sizeof(GLfloat);
+	static const GLsizeiptr blockSize = drawsPerBlock * matrixSize;
+	static const GLint initialCapacity = drawsPerBlock * 4;
+	static const int numSegments = 3;
+
+	GLuint buffer;
+	char* mappedData;
+	GLint capacity; // Draws per segment
+	int segment;
+	GLint drawsInFrame;
+	std::array<GLsync, numSegments> fences;
+
+	// Offset of the block containing the given draw within the current segment
+	GLintptr getOffset(GLint draw) {
+		return segment * capacity * matrixSize + (draw / drawsPerBlock) * blockSize;
+	}
+
+	void allocate(GLint newCapacity) {
+		capacity = newCapacity;
+		segment = 0;
+		drawsInFrame = 0;
+
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLsizeiptr size = numSegments * capacity * matrixSize;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferStorage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+		mappedData = static_cast<char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags));
+	}
+
+	void release() {
+		for (int i = 0; i < numSegments; ++i) {
+			if (fences[i] != nullptr) {
+				glDeleteSync(fences[i]);
+				fences[i] = nullptr;
+			}
+		}
+
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		glDeleteBuffers(1, &buffer);
+		mappedData = nullptr;
+	}
+
+	void waitForSegment(int segment) {
+		if (fences[segment] == nullptr) {
+			return;
+		}
+
+		while (glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+		glDeleteSync(fences[segment]);
+		fences[segment] = nullptr;
+	}
+
+	friend class ShaderProgram;
+	friend class ShaderProgramKey;
+};
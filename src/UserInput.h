@@ -16,122 +16,27 @@
 
 #pragma once
 
-#include <GLFW/glfw3.h>
-#include <memory>
-#include <unordered_set>
+#include "VectorMath.h"
+#include "InputState.h"
+#include "InputBindings.h"
 
-class MouseButton;
-class KeyboardButton;
-
-class InputListener {
-public:
-	void mouseButtonPressed(int button) {
-		mouseButtonsPressedThisStep.insert(button);
-	}
-
-	void keyboardKeyPressed(int key) {
-		keyboardKeysPressedThisStep.insert(key);
-	}
-
-	void clearPressedThisStepList() {
-		mouseButtonsPressedThisStep.clear();
-		keyboardKeysPressedThisStep.clear();
-	}
-
-private:
-	std::unordered_set<int> mouseButtonsPressedThisStep;
-	std::unordered_set<int> keyboardKeysPressedThisStep;
-
-	friend class MouseButton;
-	friend class KeyboardButton;
-};
-
-class InputButton {
-public:
-	virtual ~InputButton() = default;
-
-private:
-	virtual bool isPressed(GLFWwindow* window) = 0;
-	virtual bool pressedThisStep(const InputListener& listener) = 0;
-
-	friend class NullButton;
-	friend class MouseButton;
-	friend class KeyboardButton;
-	friend class UserInput;
-	friend class InputHandle;
-};
-
-class NullButton: public InputButton {
-public:
-	NullButton() {}
-
-private:
-	bool isPressed(GLFWwindow* window) override {
-		return false;
-	}
-
-	bool pressedThisStep(const InputListener& listener) override {
-		return false;
-	}
-
-	void setCallback(InputListener& listener, const std::function<void()>& callback) {
-	}
-};
-
-class MouseButton: public InputButton {
+class UserInput {
 public:
-	MouseButton(int button): button(button) {}
+	UserInput(const InputState& inputState, const InputBindings& bindings, Vector2d mouseLook):
+		inputState(inputState), bindings(bindings), mouseLook(mouseLook) {}
 
-private:
-	bool isPressed(GLFWwindow* window) override {
-		return glfwGetMouseButton(window, button) == GLFW_PRESS;
+	// Whether any of the action's inputs is held
+	bool isPressed(InputAction action) const {
+		return isAnySet(inputState.getHeld(), action);
 	}
 
-	bool pressedThisStep(const InputListener& listener) override {
-		return listener.mouseButtonsPressedThisStep.find(button) != listener.mouseButtonsPressedThisStep.end();
-	}
-
-	int button;
-};
-
-class KeyboardButton : public InputButton {
-public:
-	KeyboardButton(int key): key(key) {}
-
-private:
-	bool isPressed(GLFWwindow* window) override {
-		return glfwGetKey(window, key) == GLFW_PRESS;
+	bool pressedThisStep(InputAction action) const {
+		return isAnySet(inputState.getPressed(), action);
 	}
 
-	bool pressedThisStep(const InputListener& listener) override {
-		return listener.keyboardKeysPressedThisStep.find(key) != listener.keyboardKeysPressedThisStep.end();
-	}
-
-	int key;
-};
-
-class InputHandle {
-public:
-	InputHandle(): inputButton(std::make_unique<NullButton>()) {}
-
-	template<typename T>
-	InputHandle(T&& inputButton): inputButton(std::make_unique<T>(std::move(inputButton))) {}
-
-private:
-	std::unique_ptr<InputButton> inputButton;
-	friend class UserInput;
-};
-
-class UserInput {
-public:
-	UserInput(GLFWwindow* window, const InputListener& inputListener, Vector2d mouseLook): window(window), inputListener(inputListener), mouseLook(mouseLook) {}
-
-	bool isPressed(const InputHandle& inputHandle) const {
-		return inputHandle.inputButton->isPressed(window);
-	}
-
-	bool pressedThisStep(const InputHandle& inputHandle) const {
-		return inputHandle.inputButton->pressedThisStep(inputListener);
+	// Whether the action stopped being held, which it does not while another of its inputs is still held
+	bool releasedThisStep(InputAction action) const {
+		return isAnySet(inputState.getReleased(), action) && !isPressed(action);
 	}
 
 	Vector2d getMouseLook() const {
@@ -139,7 +44,16 @@ public:
 	}
 
 private:
-	GLFWwindow* window;
-	const InputListener& inputListener;
+	const InputState& inputState;
+	const InputBindings& bindings;
 	Vector2d mouseLook;
+
+	// The unused entries are the null bit, so every entry can be tested without a branch
+	bool isAnySet(const InputState::Bits& bits, InputAction action) const {
+		bool result = false;
+		for (int bit : bindings.getBits(action)) {
+			result |= bits[bit];
+		}
+		return result;
+	}
 };
@@ -15,14 +15,58 @@
  */
 
 #include "VectorMath.h"
+#include <cmath>
 #include <unsupported/Eigen/MatrixFunctions>
-#include <Eigen/SVD>
 
-Matrix4d VectorMath::hyperbolicSvdUnitary(const Matrix4d& matrix) {
-	return matrix * (hyperbolicTranspose(matrix) * matrix).sqrt().inverse();
+namespace {
+	// Newton's iteration for the polar decomposition, generalized to the geometry's metric: Averaging a matrix with
+	// the inverse of its geometry transpose converges quadratically to the isometry factor of the matrix, which is
+	// the same factor that M * (M^T M)^(-1/2) produces. Scaling by the determinant first keeps the early iterations
+	// from overshooting when the matrix is far from an isometry. Each step costs one closed-form 4x4 inverse.
+	template<typename Space>
+	Matrix4d polarUnitary(const Matrix4d& matrix) {
+		const int maxIterations = 32;
+		Matrix4d result = matrix;
+
+		for (int i = 0; i < maxIterations; ++i) {
+			double scale = std::pow(std::abs(result.determinant()), -0.25);
+			Matrix4d next = 0.5 * (scale * result + Space::transpose(result.inverse()) / scale);
+			double change = (next - result).lpNorm<Eigen::Infinity>();
+			result = next;
+
+			// Convergence is quadratic, so a change this small means the result is already accurate to rounding
+			if (change <= 1e-9 * result.lpNorm<Eigen::Infinity>()) {
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	// The principal matrix logarithm, projected onto the generators to remove its rounding error
+	template<typename Space>
+	Matrix4d isometryLog(const Matrix4d& matrix) {
+		Matrix4d result = Eigen::Matrix4d(matrix).log();
+		return 0.5 * (result - Space::transpose(result));
+	}
+}
+
+template<>
+Matrix4d GeometryPolicy<-1>::svdUnitary(const Matrix4d& matrix) {
+	return polarUnitary<GeometryPolicy<-1>>(matrix);
+}
+
+template<>
+Matrix4d GeometryPolicy<1>::svdUnitary(const Matrix4d& matrix) {
+	return polarUnitary<GeometryPolicy<1>>(matrix);
+}
+
+template<>
+Matrix4d GeometryPolicy<-1>::log(const Matrix4d& matrix) {
+	return isometryLog<GeometryPolicy<-1>>(matrix);
 }
 
-Matrix4d VectorMath::sphericalSvdUnitary(const Matrix4d& matrix) {
-	Eigen::JacobiSVD<Matrix4d> svd(matrix, Eigen::ComputeThinU | Eigen::ComputeThinV);
-	return svd.matrixU() * svd.matrixV().adjoint();
+template<>
+Matrix4d GeometryPolicy<1>::log(const Matrix4d& matrix) {
+	return isometryLog<GeometryPolicy<1>>(matrix);
 }
@@ -15,6 +15,8 @@
  */
 
 #pragma once
+#include <array>
+#include <cmath>
 #include <Eigen/Dense>
 
 using Matrix4d = Eigen::Matrix<double, 4, 4, Eigen::DontAlign>;
@@ -24,6 +26,246 @@ using Vector2d = Eigen::Matrix<double, 2, 1, Eigen::DontAlign>;
 
 constexpr auto M_TAU = 6.2831853071795864769252867665590057683943;
 
+// Isometries and metric operations for a geometry of constant curvature, where the
+// model space is the set of points with x^2 + y^2 + z^2 + curvature * w^2 = curvature.
+// Everything that differs between geometries is resolved at compile time, so code
+// templated on a policy has no runtime geometry branches. Only curvature -1
+// (hyperbolic) and 1 (spherical) are defined; a flat geometry would need its own
+// specialization, since its metric is degenerate.
+template<int Curvature>
+class GeometryPolicy {
+public:
+	static_assert(Curvature == -1 || Curvature == 1, "Only hyperbolic and spherical geometry are supported");
+
+	static constexpr int curvature = Curvature;
+
+	static double dotProduct(const Vector4d& v0, const Vector4d& v1) {
+		return v0(0)*v1(0) + v0(1)*v1(1) + v0(2)*v1(2) + curvature * v0(3)*v1(3);
+	}
+
+	static double sqrNorm(const Vector4d& v) {
+		return dotProduct(v, v);
+	}
+
+	// Moves the origin to the specified position
+	static Matrix4d translation(const Vector4d &v) {
+		Matrix4d result;
+		double x = v.x(), y = v.y(), z = v.z(), w = v.w();
+		double f = -curvature / (w + 1.0);
+		result << 1 + x*x*f, x*y*f, x*z*f, x,
+			x*y*f, 1 + y*y*f, y*z*f, y,
+			x*z*f, y*z*f, 1 + z*z*f, z,
+			-curvature * x, -curvature * y, -curvature * z, w;
+		return result;
+	}
+
+	// Moves the origin in the specified direction with a distance proportional
+	// to the magnitude of the argument (The fourth component is assumed to be 0)
+	static Matrix4d displacement(const Vector4d &displacement) {
+		double norm = displacement.norm();
+		double scaleFactor = norm < 1e-30 ? 1.0 : sine(norm) / norm;
+		Vector4d translateVector(displacement.x() * scaleFactor, displacement.y() * scaleFactor, displacement.z() * scaleFactor, cosine(norm));
+		return translation(translateVector);
+	}
+
+	static Matrix4d reflection(const Vector4d& normal) {
+		return Matrix4d::Identity() - 2.0 * normal * Eigen::RowVector4d(normal(0), normal(1), normal(2), curvature * normal(3));
+	}
+
+	// The inverse of an isometry
+	static Matrix4d transpose(const Matrix4d& matrix) {
+		Matrix4d result;
+
+		result << matrix(0, 0), matrix(1, 0), matrix(2, 0), curvature * matrix(3, 0),
+			matrix(0, 1), matrix(1, 1), matrix(2, 1), curvature * matrix(3, 1),
+			matrix(0, 2), matrix(1, 2), matrix(2, 2), curvature * matrix(3, 2),
+			curvature * matrix(0, 3), curvature * matrix(1, 3), curvature * matrix(2, 3), matrix(3, 3);
+
+		return result;
+	}
+
+	// Normal of the plane through the three points
+	static Vector4d normal(const Vector4d& v0, const Vector4d& v1, const Vector4d& v2) {
+		double x =   v0[1]*v1[2]*v2[3] + v0[2]*v1[3]*v2[1] + v0[3]*v1[1]*v2[2] - v0[1]*v1[3]*v2[2] - v0[2]*v1[1]*v2[3] - v0[3]*v1[2]*v2[1];
+		double y = -(v0[0]*v1[2]*v2[3] + v0[2]*v1[3]*v2[0] + v0[3]*v1[0]*v2[2] - v0[0]*v1[3]*v2[2] - v0[2]*v1[0]*v2[3] - v0[3]*v1[2]*v2[0]);
+		double z =   v0[0]*v1[1]*v2[3] + v0[1]*v1[3]*v2[0] + v0[3]*v1[0]*v2[1] - v0[0]*v1[3]*v2[1] - v0[1]*v1[0]*v2[3] - v0[3]*v1[1]*v2[0];
+		double w = -(v0[0]*v1[1]*v2[2] + v0[1]*v1[2]*v2[0] + v0[2]*v1[0]*v2[1] - v0[0]*v1[2]*v2[1] - v0[1]*v1[0]*v2[2] - v0[2]*v1[1]*v2[0]);
+		return Vector4d(x, y, z, curvature * w);
+	}
+
+	// Gram-Schmidt with respect to the metric, which keeps the first column's direction
+	static Matrix4d qrUnitary(const Matrix4d& matrix) {
+		Matrix4d result = matrix;
+		result.col(0) /= sqrt(sqrNorm(result.col(0)));
+		result.col(1) -= result.col(0) * dotProduct(result.col(0), result.col(1));
+		result.col(2) -= result.col(0) * dotProduct(result.col(0), result.col(2));
+		result.col(3) -= result.col(0) * dotProduct(result.col(0), result.col(3));
+
+		result.col(1) /= sqrt(sqrNorm(result.col(1)));
+		result.col(2) -= result.col(1) * dotProduct(result.col(1), result.col(2));
+		result.col(3) -= result.col(1) * dotProduct(result.col(1), result.col(3));
+
+		result.col(2) /= sqrt(sqrNorm(result.col(2)));
+		result.col(3) -= result.col(2) * dotProduct(result.col(2), result.col(3));
+
+		result.col(3) /= sqrt(curvature * sqrNorm(result.col(3)));
+		return result;
+	}
+
+	// The closest isometry to the given matrix. Defined in VectorMath.cpp.
+	static Matrix4d svdUnitary(const Matrix4d& matrix);
+
+	// The isometries exp(t * X) for a generator X, that is, a matrix with transpose(X) = -X. Every power of X can be
+	// written with I, X, X^2 and X^3, since X^4 = e1 * X^2 - e2 * I, so evaluating exp(t * X) takes a short scalar
+	// series and one combination of the cached powers, plus a squaring for each halving of t when t * X is large.
+	class OneParameterGroup {
+	public:
+		OneParameterGroup(): OneParameterGroup(Matrix4d::Zero()) {}
+
+		explicit OneParameterGroup(const Matrix4d& generator):
+			generator(generator), square(generator * generator), cube(square * generator),
+			e1(0.5 * square.trace()), e2(generator.determinant()) {}
+
+		Matrix4d at(double t) const {
+			// Halving t until t^2 bounds the square of every eigenvalue of t * X by 1 keeps the series short
+			double bound = std::abs(e1) + std::sqrt(std::abs(e2));
+			int squarings = 0;
+			while (t * t * bound > 1 && squarings < maxSquarings) {
+				t *= 0.5;
+				++squarings;
+			}
+
+			// X^(2k) = alpha * I + beta * X^2 and X^(2k+1) = alpha * X + beta * X^3
+			double alpha = 1, beta = 0;
+			double even = 1, odd = t; // t^(2k) / (2k)! and t^(2k+1) / (2k+1)!
+			double c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+			for (int k = 0; k < seriesTerms; ++k) {
+				c0 += even * alpha;
+				c2 += even * beta;
+				c1 += odd * alpha;
+				c3 += odd * beta;
+
+				double nextAlpha = -e2 * beta;
+				beta = alpha + e1 * beta;
+				alpha = nextAlpha;
+				even *= t * t / ((2*k + 1) * (2*k + 2));
+				odd *= t * t / ((2*k + 2) * (2*k + 3));
+			}
+
+			Matrix4d result = c0 * Matrix4d::Identity() + c1 * generator + c2 * square + c3 * cube;
+			for (int i = 0; i < squarings; ++i) {
+				result = result * result;
+			}
+			return result;
+		}
+
+		const Matrix4d& getGenerator() const {
+			return generator;
+		}
+
+	private:
+		static constexpr int seriesTerms = 10; // With t * X scaled down, enough to reach rounding error
+		static constexpr int maxSquarings = 64;
+
+		Matrix4d generator;
+		Matrix4d square;
+		Matrix4d cube;
+		double e1; // Half the trace of X^2
+		double e2; // The determinant of X
+	};
+
+	static Matrix4d exp(const Matrix4d& generator) {
+		return OneParameterGroup(generator).at(1);
+	}
+
+	// The generator of the shortest one-parameter group through the given isometry, so that exp(log(M)) = M.
+	// Defined in VectorMath.cpp.
+	static Matrix4d log(const Matrix4d& matrix);
+
+	// How far a composed transform has drifted from being an isometry: the largest entry of
+	// transpose(M) * M - I, computed from the metric's dot products between the columns
+	static double drift(const Matrix4d& matrix) {
+		GramDeviations deviations;
+		return gramDeviations(matrix, deviations);
+	}
+
+	// Cheap renormalization for transforms that are composed repeatedly. Negligible drift is left alone,
+	// small drift gets a first-order correction that leaves roughly its square behind, and only drift past
+	// maxFirstOrderDrift pays for a full qrUnitary. Measuring the drift costs about half a qrUnitary, so
+	// this only beats qrUnitary when the drift is usually negligible; code that always has drift to remove
+	// should call qrUnitary directly.
+	static Matrix4d correctDrift(const Matrix4d& matrix) {
+		GramDeviations deviations;
+		double drift = gramDeviations(matrix, deviations);
+		// Kept apart so that the common case stays small enough to inline
+		return drift <= negligibleDrift ? matrix : correctNonNegligibleDrift(matrix, deviations, drift);
+	}
+
+	static constexpr double negligibleDrift = 1e-14;
+	static constexpr double maxFirstOrderDrift = 1e-6;
+
+	// sinh and cosh for hyperbolic geometry, sin and cos for spherical geometry
+	static double sine(double x) {
+		return curvature < 0 ? sinh(x) : sin(x);
+	}
+
+	static double cosine(double x) {
+		return curvature < 0 ? cosh(x) : cos(x);
+	}
+
+private:
+	// The upper triangle of transpose(M) * M - I in row-major order, as it is symmetric
+	using GramDeviations = std::array<double, 10>;
+
+	static Matrix4d correctNonNegligibleDrift(const Matrix4d& matrix, const GramDeviations& deviations, double drift) {
+		if (drift > maxFirstOrderDrift) {
+			return qrUnitary(matrix);
+		}
+
+		// transpose(M) * M is I + JE, where J is the metric and E is the deviation of the dot products,
+		// so multiplying by I - JE/2 cancels the deviation to first order
+		Matrix4d correction;
+		double* correctionData = correction.data();
+		int k = 0;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = i; j < 4; ++j) {
+				double entry = -0.5 * deviations[k++];
+				correctionData[4 * j + i] = (i == 3 ? curvature : 1) * entry + (i == j ? 1 : 0);
+				correctionData[4 * i + j] = (j == 3 ? curvature : 1) * entry + (i == j ? 1 : 0);
+			}
+		}
+		return matrix * correction;
+	}
+
+	// The metric's dot products between each pair of the matrix's columns, minus what they are for an isometry.
+	// Returns the largest of them in absolute value, which is the drift.
+	static double gramDeviations(const Matrix4d& matrix, GramDeviations& result) {
+		// Indexes the column-major data directly, as this is called often enough that Eigen's range checks add up
+		const double* data = matrix.data();
+		double drift = 0;
+		int k = 0;
+		for (int i = 0; i < 4; ++i) {
+			const double* column0 = data + 4 * i;
+			for (int j = i; j < 4; ++j) {
+				const double* column1 = data + 4 * j;
+				double deviation = column0[0]*column1[0] + column0[1]*column1[1] + column0[2]*column1[2]
+					+ curvature * column0[3]*column1[3] - (i == j ? (i == 3 ? curvature : 1) : 0);
+				result[k++] = deviation;
+				drift = std::max(drift, std::abs(deviation));
+			}
+		}
+		return drift;
+	}
+};
+
+template<> Matrix4d GeometryPolicy<-1>::svdUnitary(const Matrix4d& matrix);
+template<> Matrix4d GeometryPolicy<1>::svdUnitary(const Matrix4d& matrix);
+template<> Matrix4d GeometryPolicy<-1>::log(const Matrix4d& matrix);
+template<> Matrix4d GeometryPolicy<1>::log(const Matrix4d& matrix);
+
+using HyperbolicGeometry = GeometryPolicy<-1>;
+using SphericalGeometry = GeometryPolicy<1>;
+
 class VectorMath {
 public:
 	static Matrix4d perspective(double x, double y, double zNear, double zFar) {
@@ -47,25 +289,11 @@ public:
 
 	// Moves the origin to the specified position
 	static Matrix4d hyperbolicTranslation(const Vector4d &v) {
-		Matrix4d result;
-		double x = v.x(), y = v.y(), z = v.z(), w = v.w();
-		double f = 1.0 / (w + 1.0);
-		result << x*x*f + 1, x*y*f, x*z*f, x,
-			x*y*f, y*y*f + 1, y*z*f, y,
-			x*z*f, y*z*f, z*z*f + 1, z,
-			x, y, z, w;
-		return result;
+		return HyperbolicGeometry::translation(v);
 	}
 
 	static Matrix4d sphericalTranslation(const Vector4d &v) {
-		Matrix4d result;
-		double x = v.x(), y = v.y(), z = v.z(), w = v.w();
-		double f = 1.0 / (w + 1.0);
-		result << 1 - x*x*f, x*y*f, x*z*f, x,
-			x*y*f, 1 - y*y*f, y*z*f, y,
-			x*z*f, y*z*f, 1 - z*z*f, z,
-			-x, -y, -z, w;
-		return result;
+		return SphericalGeometry::translation(v);
 	}
 
 	// Does an ideal rotation about (0, 0, 1, 1)
@@ -101,101 +329,56 @@ public:
 	}
 
 	static Matrix4d hyperbolicReflection(const Vector4d& normal) {
-		return Matrix4d::Identity() - 2.0 * normal * Eigen::RowVector4d(normal(0), normal(1), normal(2), -normal(3));
+		return HyperbolicGeometry::reflection(normal);
 	}
 
 	static Matrix4d sphericalReflection(const Vector4d& normal) {
-		return Matrix4d::Identity() - 2.0 * normal * Eigen::RowVector4d(normal(0), normal(1), normal(2), normal(3));
+		return SphericalGeometry::reflection(normal);
 	}
 
 	static Matrix4d hyperbolicTranspose(const Matrix4d& matrix) {
-		Matrix4d result;
-
-		result << matrix(0, 0), matrix(1, 0), matrix(2, 0), -matrix(3, 0),
-			matrix(0, 1), matrix(1, 1), matrix(2, 1), -matrix(3, 1),
-			matrix(0, 2), matrix(1, 2), matrix(2, 2), -matrix(3, 2),
-			-matrix(0, 3), -matrix(1, 3), -matrix(2, 3), matrix(3, 3);
-
-		return result;
+		return HyperbolicGeometry::transpose(matrix);
 	}
 
 	static Vector4d hyperbolicNormal(const Vector4d& v0, const Vector4d& v1, const Vector4d& v2) {
-		double x =   v0[1]*v1[2]*v2[3] + v0[2]*v1[3]*v2[1] + v0[3]*v1[1]*v2[2] - v0[1]*v1[3]*v2[2] - v0[2]*v1[1]*v2[3] - v0[3]*v1[2]*v2[1];
-		double y = -(v0[0]*v1[2]*v2[3] + v0[2]*v1[3]*v2[0] + v0[3]*v1[0]*v2[2] - v0[0]*v1[3]*v2[2] - v0[2]*v1[0]*v2[3] - v0[3]*v1[2]*v2[0]);
-		double z =   v0[0]*v1[1]*v2[3] + v0[1]*v1[3]*v2[0] + v0[3]*v1[0]*v2[1] - v0[0]*v1[3]*v2[1] - v0[1]*v1[0]*v2[3] - v0[3]*v1[1]*v2[0];
-		double w = -(v0[0]*v1[1]*v2[2] + v0[1]*v1[2]*v2[0] + v0[2]*v1[0]*v2[1] - v0[0]*v1[2]*v2[1] - v0[1]*v1[0]*v2[2] - v0[2]*v1[1]*v2[0]);
-		return Vector4d(x, y, z, -w);
+		return HyperbolicGeometry::normal(v0, v1, v2);
 	}
 
 	static Vector4d sphericalNormal(const Vector4d& v0, const Vector4d& v1, const Vector4d& v2) {
-		double x =   v0[1]*v1[2]*v2[3] + v0[2]*v1[3]*v2[1] + v0[3]*v1[1]*v2[2] - v0[1]*v1[3]*v2[2] - v0[2]*v1[1]*v2[3] - v0[3]*v1[2]*v2[1];
-		double y = -(v0[0]*v1[2]*v2[3] + v0[2]*v1[3]*v2[0] + v0[3]*v1[0]*v2[2] - v0[0]*v1[3]*v2[2] - v0[2]*v1[0]*v2[3] - v0[3]*v1[2]*v2[0]);
-		double z =   v0[0]*v1[1]*v2[3] + v0[1]*v1[3]*v2[0] + v0[3]*v1[0]*v2[1] - v0[0]*v1[3]*v2[1] - v0[1]*v1[0]*v2[3] - v0[3]*v1[1]*v2[0];
-		double w = -(v0[0]*v1[1]*v2[2] + v0[1]*v1[2]*v2[0] + v0[2]*v1[0]*v2[1] - v0[0]*v1[2]*v2[1] - v0[1]*v1[0]*v2[2] - v0[2]*v1[1]*v2[0]);
-		return Vector4d(x, y, z, w);
+		return SphericalGeometry::normal(v0, v1, v2);
 	}
 
 	static double hyperbolicDotProduct(const Vector4d& v0, const Vector4d& v1) {
-		return v0(0)*v1(0) + v0(1)*v1(1) + v0(2)*v1(2) - v0(3)*v1(3);
+		return HyperbolicGeometry::dotProduct(v0, v1);
 	}
 
 	static double hyperbolicSqrNorm(const Vector4d& v) {
-		return hyperbolicDotProduct(v, v);
+		return HyperbolicGeometry::sqrNorm(v);
 	}
 
 	// Moves the origin in the specified direction with a distance proportional
 	// to the magnitude of the argument (The fourth component is assumed to be 0)
 	static Matrix4d hyperbolicDisplacement(const Vector4d &displacement) {
-		double norm = displacement.norm();
-		double scaleFactor = norm < 1e-30 ? 1.0 : sinh(norm) / norm;
-		Vector4d translateVector(displacement.x() * scaleFactor, displacement.y() * scaleFactor, displacement.z() * scaleFactor, cosh(norm));
-		return hyperbolicTranslation(translateVector);
+		return HyperbolicGeometry::displacement(displacement);
 	}
 
 	static Matrix4d sphericalDisplacement(const Vector4d &displacement) {
-		double norm = displacement.norm();
-		double scaleFactor = norm < 1e-30 ? 1.0 : sin(norm) / norm;
-		Vector4d translateVector(displacement.x() * scaleFactor, displacement.y() * scaleFactor, displacement.z() * scaleFactor, cos(norm));
-		return sphericalTranslation(translateVector);
+		return SphericalGeometry::displacement(displacement);
 	}
 
 	static Matrix4d hyperbolicQrUnitary(const Matrix4d& matrix) {
-		Matrix4d result = matrix;
-		result.col(0) /= sqrt(hyperbolicSqrNorm(result.col(0)));
-		result.col(1) -= result.col(0) * hyperbolicDotProduct(result.col(0), result.col(1));
-		result.col(2) -= result.col(0) * hyperbolicDotProduct(result.col(0), result.col(2));
-		result.col(3) -= result.col(0) * hyperbolicDotProduct(result.col(0), result.col(3));
-
-		result.col(1) /= sqrt(hyperbolicSqrNorm(result.col(1)));
-		result.col(2) -= result.col(1) * hyperbolicDotProduct(result.col(1), result.col(2));
-		result.col(3) -= result.col(1) * hyperbolicDotProduct(result.col(1), result.col(3));
-
-		result.col(2) /= sqrt(hyperbolicSqrNorm(result.col(2)));
-		result.col(3) -= result.col(2) * hyperbolicDotProduct(result.col(2), result.col(3));
-
-		result.col(3) /= sqrt(-hyperbolicSqrNorm(result.col(3)));
-		return result;
+		return HyperbolicGeometry::qrUnitary(matrix);
 	}
 
 	static Matrix4d sphericalQrUnitary(const Matrix4d& matrix) {
-		Matrix4d result = matrix;
-		result.col(0).normalize();
-		result.col(1) -= result.col(0) * result.col(0).dot(result.col(1));
-		result.col(2) -= result.col(0) * result.col(0).dot(result.col(2));
-		result.col(3) -= result.col(0) * result.col(0).dot(result.col(3));
-
-		result.col(1).normalize();
-		result.col(2) -= result.col(1) * result.col(1).dot(result.col(2));
-		result.col(3) -= result.col(1) * result.col(1).dot(result.col(3));
-
-		result.col(2).normalize();
-		result.col(3) -= result.col(2) * result.col(2).dot(result.col(3));
-
-		result.col(3).normalize();
-		return result;
+		return SphericalGeometry::qrUnitary(matrix);
 	}
 
-	static Matrix4d hyperbolicSvdUnitary(const Matrix4d& matrix);
+	static Matrix4d hyperbolicSvdUnitary(const Matrix4d& matrix) {
+		return HyperbolicGeometry::svdUnitary(matrix);
+	}
 
-	static Matrix4d sphericalSvdUnitary(const Matrix4d& matrix);
+	static Matrix4d sphericalSvdUnitary(const Matrix4d& matrix) {
+		return SphericalGeometry::svdUnitary(matrix);
+	}
 };
@@ -0,0 +1,173 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#include <cmath>
+#include <stdexcept>
+#include "VectorMathBatch.h"
+#include "VectorMathBatchKernels.h"
+
+namespace {
+	bool isSupported(VectorMathBatch::InstructionSet instructionSet) {
+		switch (instructionSet) {
+#if defined(HYPERWORLD_X86_SIMD)
+		case VectorMathBatch::InstructionSet::AVX512:
+			return __builtin_cpu_supports("avx512f");
+		case VectorMathBatch::InstructionSet::AVX2:
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+		case VectorMathBatch::InstructionSet::SCALAR:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Falls back through the instruction sets in order until one is supported
+	VectorMathBatch::InstructionSet getBestSupported(VectorMathBatch::InstructionSet instructionSet) {
+		while (!isSupported(instructionSet)) {
+			instructionSet = static_cast<VectorMathBatch::InstructionSet>(static_cast<int>(instructionSet) - 1);
+		}
+		return instructionSet;
+	}
+
+	VectorMathBatch::InstructionSet& selectedInstructionSet() {
+		static VectorMathBatch::InstructionSet instructionSet = getBestSupported(VectorMathBatch::InstructionSet::AVX512);
+		return instructionSet;
+	}
+
+	const BatchKernelTable& getKernels() {
+#if defined(HYPERWORLD_X86_SIMD)
+		static const BatchKernelTable avx512Kernels = getAvx512BatchKernels();
+		static const BatchKernelTable avx2Kernels = getAvx2BatchKernels();
+#endif
+		static const BatchKernelTable scalarKernels = makeBatchKernelTable<ScalarSimd>();
+
+		switch (selectedInstructionSet()) {
+#if defined(HYPERWORLD_X86_SIMD)
+		case VectorMathBatch::InstructionSet::AVX512:
+			return avx512Kernels;
+		case VectorMathBatch::InstructionSet::AVX2:
+			return avx2Kernels;
+#endif
+		default:
+			return scalarKernels;
+		}
+	}
+
+	template<typename T, typename U>
+	void checkSizes(const T& first, const U& second) {
+		if (first.size() != second.size()) {
+			throw std::runtime_error("Batch sizes do not match");
+		}
+	}
+}
+
+VectorMathBatch::InstructionSet VectorMathBatch::getInstructionSet() {
+	return selectedInstructionSet();
+}
+
+VectorMathBatch::InstructionSet VectorMathBatch::setInstructionSet(InstructionSet instructionSet) {
+	return selectedInstructionSet() = getBestSupported(instructionSet);
+}
+
+const char* VectorMathBatch::getName(InstructionSet instructionSet) {
+	switch (instructionSet) {
+	case InstructionSet::AVX512:
+		return "AVX-512";
+	case InstructionSet::AVX2:
+		return "AVX2";
+	default:
+		return "scalar";
+	}
+}
+
+void VectorMathBatch::multiply(const Matrix4dBatch& left, const Matrix4dBatch& right, Matrix4dBatch& result) {
+	checkSizes(left, right);
+	if (result.size() != right.size()) {
+		result.resize(right.size());
+	}
+	getKernels().multiply(left.entries(0, 0), right.entries(0, 0), result.entries(0, 0), right.getStride());
+}
+
+void VectorMathBatch::multiply(const Matrix4d& left, const Matrix4dBatch& right, Matrix4dBatch& result) {
+	if (result.size() != right.size()) {
+		result.resize(right.size());
+	}
+	getKernels().multiplySingle(left.data(), right.entries(0, 0), result.entries(0, 0), right.getStride());
+}
+
+void VectorMathBatch::transform(const Matrix4dBatch& matrices, const Vector4dBatch& points, Vector4dBatch& result) {
+	checkSizes(matrices, points);
+	if (result.size() != points.size()) {
+		result.resize(points.size());
+	}
+	getKernels().transform(matrices.entries(0, 0), points.entries(0, 0), result.entries(0, 0), points.getStride());
+}
+
+void VectorMathBatch::transform(const Matrix4d& matrix, const Vector4dBatch& points, Vector4dBatch& result) {
+	if (result.size() != points.size()) {
+		result.resize(points.size());
+	}
+	getKernels().transformSingleMatrix(matrix.data(), points.entries(0, 0), result.entries(0, 0), points.getStride());
+}
+
+void VectorMathBatch::transform(const Matrix4dBatch& matrices, const Vector4d& point, Vector4dBatch& result) {
+	if (result.size() != matrices.size()) {
+		result.resize(matrices.size());
+	}
+	getKernels().transformSinglePoint(matrices.entries(0, 0), point.data(), result.entries(0, 0), matrices.getStride());
+}
+
+void VectorMathBatch::hyperbolicTranslation(const Vector4dBatch& positions, Matrix4dBatch& result) {
+	if (result.size() != positions.size()) {
+		result.resize(positions.size());
+	}
+	getKernels().hyperbolicTranslation(positions.entries(0, 0), result.entries(0, 0), positions.getStride());
+}
+
+void VectorMathBatch::hyperbolicDisplacement(const Vector4dBatch& displacements, Matrix4dBatch& result) {
+	if (result.size() != displacements.size()) {
+		result.resize(displacements.size());
+	}
+
+	// The hyperbolic functions have no SIMD implementation in the standard library, so only the translation itself is
+	// vectorized. The position is the last column of its translation, and the kernel loads each position before storing
+	// anything, so the positions are written into that column and translated in place with no scratch batch.
+	std::size_t stride = result.getStride();
+	const double* in = displacements.entries(0, 0);
+	double* positions = result.entries(0, 3);
+	for (std::size_t i = 0; i < displacements.size(); ++i) {
+		double x = in[i], y = in[stride + i], z = in[2 * stride + i], w = in[3 * stride + i];
+		double norm = std::sqrt(x*x + y*y + z*z + w*w);
+		double scaleFactor = norm < 1e-30 ? 1.0 : std::sinh(norm) / norm;
+		positions[i] = x * scaleFactor;
+		positions[stride + i] = y * scaleFactor;
+		positions[2 * stride + i] = z * scaleFactor;
+		positions[3 * stride + i] = std::cosh(norm);
+	}
+	// Padding entries keep whatever the result held before, so they are reset to the zero vector.
+	for (std::size_t i = displacements.size(); i < stride; ++i) {
+		positions[i] = positions[stride + i] = positions[2 * stride + i] = positions[3 * stride + i] = 0.0;
+	}
+	getKernels().hyperbolicTranslation(positions, result.entries(0, 0), stride);
+}
+
+void VectorMathBatch::horoRotation(const Vector2dBatch& offsets, Matrix4dBatch& result) {
+	if (result.size() != offsets.size()) {
+		result.resize(offsets.size());
+	}
+	getKernels().horoRotation(offsets.entries(0, 0), result.entries(0, 0), offsets.getStride());
+}
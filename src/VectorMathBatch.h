@@ -0,0 +1,128 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "VectorMath.h"
+
+// A batch of equally-sized matrices stored as a structure of arrays: entry (row, col) of every matrix in the batch is
+// contiguous in memory. This lets the kernels in VectorMathBatch work on several matrices per SIMD instruction. Storage
+// is padded with zeros to a whole number of the widest SIMD vectors, so kernels never need a scalar remainder loop.
+template<int Rows, int Cols>
+class MatrixBatch {
+public:
+	using Element = Eigen::Matrix<double, Rows, Cols, Eigen::DontAlign>;
+	static constexpr std::size_t padding = 8;
+
+	MatrixBatch(std::size_t size = 0) {
+		resize(size);
+	}
+
+	void resize(std::size_t size) {
+		count = size;
+		stride = (size + padding - 1) / padding * padding;
+		data.assign(stride * Rows * Cols, 0.0);
+	}
+
+	std::size_t size() const {
+		return count;
+	}
+
+	// Distance in doubles between consecutive entries of the same matrix
+	std::size_t getStride() const {
+		return stride;
+	}
+
+	double* entries(int row, int col) {
+		return data.data() + (col * Rows + row) * stride;
+	}
+
+	const double* entries(int row, int col) const {
+		return data.data() + (col * Rows + row) * stride;
+	}
+
+	Element get(std::size_t index) const {
+		Element result;
+		for (int col = 0; col < Cols; ++col) {
+			for (int row = 0; row < Rows; ++row) {
+				result(row, col) = entries(row, col)[index];
+			}
+		}
+		return result;
+	}
+
+	void set(std::size_t index, const Element& value) {
+		for (int col = 0; col < Cols; ++col) {
+			for (int row = 0; row < Rows; ++row) {
+				entries(row, col)[index] = value(row, col);
+			}
+		}
+	}
+
+private:
+	std::size_t count;
+	std::size_t stride;
+	std::vector<double> data;
+};
+
+using Matrix4dBatch = MatrixBatch<4, 4>;
+using Vector4dBatch = MatrixBatch<4, 1>;
+using Vector2dBatch = MatrixBatch<2, 1>;
+
+// Batched versions of the VectorMath operations used in bulk. Each function resizes its result to match its inputs. The
+// kernels use AVX-512 or AVX2 with FMA when the processor supports them and fall back to scalar code otherwise. Only the
+// point transforms and, to a lesser degree, the multiply by a single matrix are measurably faster than a per-matrix loop
+// (see VectorMathBatchBench); the other functions run at per-matrix speed and exist so that bulk code can stay in the
+// batch layout.
+class VectorMathBatch {
+public:
+	enum class InstructionSet {SCALAR, AVX2, AVX512};
+
+	// The best instruction set supported by both the build and the processor, unless overridden
+	static InstructionSet getInstructionSet();
+
+	// Selects the kernels to use, mainly so that benchmarks can compare them. Falls back to a supported instruction set
+	// if the requested one is unavailable, and returns the one actually selected.
+	static InstructionSet setInstructionSet(InstructionSet instructionSet);
+
+	static const char* getName(InstructionSet instructionSet);
+
+	// result[i] = left[i] * right[i]
+	static void multiply(const Matrix4dBatch& left, const Matrix4dBatch& right, Matrix4dBatch& result);
+
+	// result[i] = left * right[i]
+	static void multiply(const Matrix4d& left, const Matrix4dBatch& right, Matrix4dBatch& result);
+
+	// result[i] = matrices[i] * points[i]
+	static void transform(const Matrix4dBatch& matrices, const Vector4dBatch& points, Vector4dBatch& result);
+
+	// result[i] = matrix * points[i]
+	static void transform(const Matrix4d& matrix, const Vector4dBatch& points, Vector4dBatch& result);
+
+	// result[i] = matrices[i] * point
+	static void transform(const Matrix4dBatch& matrices, const Vector4d& point, Vector4dBatch& result);
+
+	// result[i] = VectorMath::hyperbolicTranslation(positions[i])
+	static void hyperbolicTranslation(const Vector4dBatch& positions, Matrix4dBatch& result);
+
+	// result[i] = VectorMath::hyperbolicDisplacement(displacements[i]). Dominated by the scalar sinh and cosh, so no faster
+	// than calling VectorMath per displacement, but it does not allocate.
+	static void hyperbolicDisplacement(const Vector4dBatch& displacements, Matrix4dBatch& result);
+
+	// result[i] = VectorMath::horoRotation(offsets[i](0), offsets[i](1))
+	static void horoRotation(const Vector2dBatch& offsets, Matrix4dBatch& result);
+};
@@ -0,0 +1,26 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+// Compiled with -mavx2 -mfma, and only called after checking that the processor supports AVX2
+#include "VectorMathBatchKernels.h"
+
+#if !(defined(__AVX2__) && defined(__FMA__))
+#error "VectorMathBatchAvx2.cpp must be compiled with -mavx2 -mfma"
+#endif
+
+BatchKernelTable getAvx2BatchKernels() {
+	return makeBatchKernelTable<Avx2Simd>();
+}
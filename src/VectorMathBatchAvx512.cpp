@@ -1,5 +1,3 @@
-#version 150
-
 /*
 	Copyright 2021 Patrick Owen
 
@@ -16,21 +14,13 @@
 	limitations under the License.
  */
 
-uniform mat4 projection;
-uniform mat4 modelView;
-in vec4 vPos;
-in vec4 vNormal;
-in vec2 vTexCoord;
-out vec4 pos;
-out vec4 normal;
-out vec2 texCoord;
-out vec4 pos_global;
+// Compiled with -mavx512f, and only called after checking that the processor supports AVX-512
+#include "VectorMathBatchKernels.h"
+
+#if !(defined(__AVX512F__))
+#error "VectorMathBatchAvx512.cpp must be compiled with -mavx512f"
+#endif
 
-void main()
-{
-	pos_global = modelView * vPos;
-	gl_Position = projection * pos_global;
-	pos = vPos;
-	normal = vNormal;
-	texCoord = vTexCoord;
+BatchKernelTable getAvx512BatchKernels() {
+	return makeBatchKernelTable<Avx512Simd>();
 }
@@ -0,0 +1,258 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+// Kernels behind VectorMathBatch, written once against a minimal SIMD interface and compiled separately for each
+// instruction set. Everything other than the kernel table lives in an anonymous namespace so that code compiled with
+// different instruction sets can never be merged by the linker.
+//
+// Batches are passed as a pointer to their first entry and a stride. Entry (row, col) of a batch with R rows starts at
+// (col * R + row) * stride. Single matrices and vectors are passed as Eigen's column-major data.
+
+#pragma once
+#include <cstddef>
+#if defined(HYPERWORLD_X86_SIMD)
+#include <immintrin.h>
+#endif
+
+struct BatchKernelTable {
+	void (*multiply)(const double* left, const double* right, double* result, std::size_t stride);
+	void (*multiplySingle)(const double* left, const double* right, double* result, std::size_t stride);
+	void (*transform)(const double* matrices, const double* points, double* result, std::size_t stride);
+	void (*transformSingleMatrix)(const double* matrix, const double* points, double* result, std::size_t stride);
+	void (*transformSinglePoint)(const double* matrices, const double* point, double* result, std::size_t stride);
+	void (*hyperbolicTranslation)(const double* positions, double* result, std::size_t stride);
+	void (*horoRotation)(const double* offsets, double* result, std::size_t stride);
+};
+
+#if defined(HYPERWORLD_X86_SIMD)
+BatchKernelTable getAvx2BatchKernels();
+BatchKernelTable getAvx512BatchKernels();
+#endif
+
+namespace {
+	class ScalarSimd {
+	public:
+		using V = double;
+		static constexpr std::size_t width = 1;
+		static V load(const double* p) { return *p; }
+		static void store(double* p, V v) { *p = v; }
+		static V set1(double value) { return value; }
+		static V add(V a, V b) { return a + b; }
+		static V sub(V a, V b) { return a - b; }
+		static V mul(V a, V b) { return a * b; }
+		static V div(V a, V b) { return a / b; }
+		static V fmadd(V a, V b, V c) { return a * b + c; }
+	};
+
+#if defined(__AVX2__) && defined(__FMA__)
+	class Avx2Simd {
+	public:
+		using V = __m256d;
+		static constexpr std::size_t width = 4;
+		static V load(const double* p) { return _mm256_loadu_pd(p); }
+		static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+		static V set1(double value) { return _mm256_set1_pd(value); }
+		static V add(V a, V b) { return _mm256_add_pd(a, b); }
+		static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+		static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+		static V div(V a, V b) { return _mm256_div_pd(a, b); }
+		static V fmadd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+	};
+#endif
+
+#if defined(__AVX512F__)
+	class Avx512Simd {
+	public:
+		using V = __m512d;
+		static constexpr std::size_t width = 8;
+		static V load(const double* p) { return _mm512_loadu_pd(p); }
+		static void store(double* p, V v) { _mm512_storeu_pd(p, v); }
+		static V set1(double value) { return _mm512_set1_pd(value); }
+		static V add(V a, V b) { return _mm512_add_pd(a, b); }
+		static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+		static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+		static V div(V a, V b) { return _mm512_div_pd(a, b); }
+		static V fmadd(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+	};
+#endif
+
+	template<typename Simd>
+	class BatchKernels {
+	public:
+		using V = typename Simd::V;
+
+		// Safe to call with result aliasing either input
+		static void multiply(const double* left, const double* right, double* result, std::size_t stride) {
+			for (std::size_t i = 0; i < stride; i += Simd::width) {
+				V r[16];
+				for (int k = 0; k < 16; ++k) {
+					r[k] = Simd::load(right + k * stride + i);
+				}
+
+				for (int row = 0; row < 4; ++row) {
+					V l[4];
+					for (int k = 0; k < 4; ++k) {
+						l[k] = Simd::load(left + (k * 4 + row) * stride + i);
+					}
+
+					for (int col = 0; col < 4; ++col) {
+						V sum = Simd::mul(l[0], r[col * 4]);
+						sum = Simd::fmadd(l[1], r[col * 4 + 1], sum);
+						sum = Simd::fmadd(l[2], r[col * 4 + 2], sum);
+						sum = Simd::fmadd(l[3], r[col * 4 + 3], sum);
+						Simd::store(result + (col * 4 + row) * stride + i, sum);
+					}
+				}
+			}
+		}
+
+		static void multiplySingle(const double* left, const double* right, double* result, std::size_t stride) {
+			V l[16];
+			for (int k = 0; k < 16; ++k) {
+				l[k] = Simd::set1(left[k]);
+			}
+
+			for (std::size_t i = 0; i < stride; i += Simd::width) {
+				for (int col = 0; col < 4; ++col) {
+					V r[4];
+					for (int k = 0; k < 4; ++k) {
+						r[k] = Simd::load(right + (col * 4 + k) * stride + i);
+					}
+
+					for (int row = 0; row < 4; ++row) {
+						V sum = Simd::mul(l[row], r[0]);
+						sum = Simd::fmadd(l[4 + row], r[1], sum);
+						sum = Simd::fmadd(l[8 + row], r[2], sum);
+						sum = Simd::fmadd(l[12 + row], r[3], sum);
+						Simd::store(result + (col * 4 + row) * stride + i, sum);
+					}
+				}
+			}
+		}
+
+		static void transform(const double* matrices, const double* points, double* result, std::size_t stride) {
+			for (std::size_t i = 0; i < stride; i += Simd::width) {
+				V p[4];
+				for (int k = 0; k < 4; ++k) {
+					p[k] = Simd::load(points + k * stride + i);
+				}
+
+				for (int row = 0; row < 4; ++row) {
+					V sum = Simd::mul(Simd::load(matrices + row * stride + i), p[0]);
+					sum = Simd::fmadd(Simd::load(matrices + (4 + row) * stride + i), p[1], sum);
+					sum = Simd::fmadd(Simd::load(matrices + (8 + row) * stride + i), p[2], sum);
+					sum = Simd::fmadd(Simd::load(matrices + (12 + row) * stride + i), p[3], sum);
+					Simd::store(result + row * stride + i, sum);
+				}
+			}
+		}
+
+		static void transformSingleMatrix(const double* matrix, const double* points, double* result, std::size_t stride) {
+			V m[16];
+			for (int k = 0; k < 16; ++k) {
+				m[k] = Simd::set1(matrix[k]);
+			}
+
+			for (std::size_t i = 0; i < stride; i += Simd::width) {
+				V p[4];
+				for (int k = 0; k < 4; ++k) {
+					p[k] = Simd::load(points + k * stride + i);
+				}
+
+				for (int row = 0; row < 4; ++row) {
+					V sum = Simd::mul(m[row], p[0]);
+					sum = Simd::fmadd(m[4 + row], p[1], sum);
+					sum = Simd::fmadd(m[8 + row], p[2], sum);
+					sum = Simd::fmadd(m[12 + row], p[3], sum);
+					Simd::store(result + row * stride + i, sum);
+				}
+			}
+		}
+
+		static void transformSinglePoint(const double* matrices, const double* point, double* result, std::size_t stride) {
+			V p[4];
+			for (int k = 0; k < 4; ++k) {
+				p[k] = Simd::set1(point[k]);
+			}
+
+			for (std::size_t i = 0; i < stride; i += Simd::width) {
+				for (int row = 0; row < 4; ++row) {
+					V sum = Simd::mul(Simd::load(matrices + row * stride + i), p[0]);
+					sum = Simd::fmadd(Simd::load(matrices + (4 + row) * stride + i), p[1], sum);
+					sum = Simd::fmadd(Simd::load(matrices + (8 + row) * stride + i), p[2], sum);
+					sum = Simd::fmadd(Simd::load(matrices + (12 + row) * stride + i), p[3], sum);
+					Simd::store(result + row * stride + i, sum);
+				}
+			}
+		}
+
+		static void hyperbolicTranslation(const double* positions, double* result, std::size_t stride) {
+			V one = Simd::set1(1.0);
+			for (std::size_t i = 0; i < stride; i += Simd::width) {
+				V x = Simd::load(positions + i);
+				V y = Simd::load(positions + stride + i);
+				V z = Simd::load(positions + 2 * stride + i);
+				V w = Simd::load(positions + 3 * stride + i);
+				V f = Simd::div(one, Simd::add(w, one));
+				V xf = Simd::mul(x, f), yf = Simd::mul(y, f), zf = Simd::mul(z, f);
+				V xy = Simd::mul(x, yf), xz = Simd::mul(x, zf), yz = Simd::mul(y, zf);
+
+				V entries[16] = {
+					Simd::fmadd(x, xf, one), xy, xz, x,
+					xy, Simd::fmadd(y, yf, one), yz, y,
+					xz, yz, Simd::fmadd(z, zf, one), z,
+					x, y, z, w
+				};
+				for (int k = 0; k < 16; ++k) {
+					Simd::store(result + k * stride + i, entries[k]);
+				}
+			}
+		}
+
+		static void horoRotation(const double* offsets, double* result, std::size_t stride) {
+			V zero = Simd::set1(0.0), one = Simd::set1(1.0), half = Simd::set1(0.5);
+			for (std::size_t i = 0; i < stride; i += Simd::width) {
+				V x = Simd::load(offsets + i);
+				V y = Simd::load(offsets + stride + i);
+				V sqrSum = Simd::mul(half, Simd::fmadd(x, x, Simd::mul(y, y)));
+				V negX = Simd::sub(zero, x), negY = Simd::sub(zero, y);
+
+				V entries[16] = {
+					one, zero, negX, x,
+					zero, one, negY, y,
+					x, y, Simd::sub(one, sqrSum), sqrSum,
+					x, y, Simd::sub(zero, sqrSum), Simd::add(sqrSum, one)
+				};
+				for (int k = 0; k < 16; ++k) {
+					Simd::store(result + k * stride + i, entries[k]);
+				}
+			}
+		}
+	};
+
+	template<typename Simd>
+	BatchKernelTable makeBatchKernelTable() {
+		return BatchKernelTable {
+			&BatchKernels<Simd>::multiply,
+			&BatchKernels<Simd>::multiplySingle,
+			&BatchKernels<Simd>::transform,
+			&BatchKernels<Simd>::transformSingleMatrix,
+			&BatchKernels<Simd>::transformSinglePoint,
+			&BatchKernels<Simd>::hyperbolicTranslation,
+			&BatchKernels<Simd>::horoRotation
+		};
+	}
+}
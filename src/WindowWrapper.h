@@ -19,23 +19,32 @@
 #include "glad.h"
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <stdexcept>
 #include "VectorMath.h"
 #include "ShaderProgramBank.h"
+#include "JobSystem.h"
 #include "ModelBank.h"
 #include "TextureBank.h"
 #include "RenderContext.h"
 #include "GhostCamera.h"
-#include "UserInput.h"
+#include "InputRecording.h"
+#include "SimulationThread.h"
 #include "Scene.h"
-#include "SimpleRenderNode.h"
 #include "SimpleSpawner.h"
+#include "LaunchOptions.h"
+
+static_assert(InputCode::KEY_A == GLFW_KEY_A && InputCode::KEY_1 == GLFW_KEY_1 && InputCode::KEY_HOME == GLFW_KEY_HOME
+	&& InputCode::KEY_F11 == GLFW_KEY_F11 && InputCode::KEY_LEFT_SHIFT == GLFW_KEY_LEFT_SHIFT
+	&& InputCode::MOUSE_BUTTON_2 == GLFW_MOUSE_BUTTON_2 && InputCode::KEY_LAST == GLFW_KEY_LAST
+	&& InputCode::MOUSE_BUTTON_LAST == GLFW_MOUSE_BUTTON_LAST, "InputCode values must match GLFW's");
 
 class ContextWrapper;
 
 class WindowWrapper {
 public:
-	WindowWrapper(const ContextWrapper &contextWrapper) : contextWrapper(contextWrapper) {
+	WindowWrapper(const ContextWrapper &contextWrapper, const LaunchOptions &options) : contextWrapper(contextWrapper), options(options) {
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
 
@@ -67,22 +76,49 @@ public:
 	}
 
 	void renderLoop() {
-		Scene scene;
-		GhostCamera camera;
+		InputBindings bindings = options.bindingsRequired ? InputBindings::load(options.bindingsPath) : InputBindings::loadIfPresent(options.bindingsPath);
+		Scene<HyperbolicGeometry> scene;
+		GhostCamera<HyperbolicGeometry> camera(scene.getAnchors());
 		SimpleSpawner simpleSpawner(scene, camera);
-		ModelBank modelBank;
-		TextureBank textureBank;
+		JobSystem jobs;
+		ModelBank modelBank(jobs);
+		TextureBank textureBank(jobs);
 		ShaderProgramBank shaderProgramBank;
 		RenderContext context(shaderProgramBank, modelBank, textureBank);
 
-		camera.setSpherical(false);
-		context.setSpherical(false);
+		if (options.watchShaders) {
+			shaderProgramBank.watchForChanges();
+		}
+		if (options.doubleFloatTransforms) {
+			modelBank.setExtendedModelsTransformPrecision(TransformPrecision::DOUBLE_FLOAT);
+		}
+
+		context.setGeometry<HyperbolicGeometry>();
 
 		scene.setCamera(camera);
 		scene.addEntity(camera);
 		scene.addEntity(simpleSpawner);
 
-		double previousFrameTime = 0;
+		// Declared after everything the scene uses, so the thread stops before any of it is destroyed
+		SimulationThread<HyperbolicGeometry> simulation(scene, bindings, tickInterval);
+		SnapshotInterpolator<HyperbolicGeometry> snapshots;
+
+		bool recording = !options.recordInputPath.empty();
+		InputRecording inputRecording;
+		if (recording) {
+			simulation.record(inputRecording);
+		}
+
+		InputRecording replay;
+		bool replaying = !options.replayInputPath.empty();
+		if (replaying) {
+			replay = InputRecording::load(options.replayInputPath);
+			simulation.replay(replay);
+		}
+
+		simulation.start();
+		bool firstFrame = true;
+		std::uint64_t frames = 0;
 
 		glEnable(GL_DEPTH_TEST);
 		glEnable(GL_FRAMEBUFFER_SRGB);
@@ -95,35 +131,54 @@ public:
 				glfwSetCursorPos(window, 0, 0);
 			}
 
-			UserInput userInput(window, inputListener, mouseLook);
-
-			double currentFrameTime = glfwGetTime();
-			if (currentFrameTime != 0) {
-				if (previousFrameTime != 0) {
-					// Get amount of time passed since last frame
-					double timeInFrame = currentFrameTime - previousFrameTime;
-					if (timeInFrame > 0.05) {
-						// Don't advance over 1/20 of a second in a single frame
-						timeInFrame = 0.05;
-					}
-
-					// Advance the scene by the amount of time passed since last frame
-					scene.step(timeInFrame, userInput);
-					inputListener.clearPressedThisStepList();
+			if (replaying) {
+				if (simulation.isFinished()) {
+					break;
 				}
-				previousFrameTime = currentFrameTime;
+			} else {
+				simulation.addInput(input, mouseLook);
+				input.clearEdges();
+			}
+
+			if (shaderProgramBank.reloadChangedPrograms()) {
+				context.invalidateShaderProgram();
+			}
+
+			// The frame is drawn one tick behind the simulation, between the last two snapshots, so that it moves
+			// smoothly however long each tick takes
+			if (simulation.getSnapshots().update()) {
+				snapshots.add(simulation.getSnapshots().getFront());
 			}
 
 			int width, height;
 			glfwGetFramebufferSize(window, &width, &height);
 			glViewport(0, 0, width, height);
 			context.setDimensions(width, height);
-			scene.render(context);
+			context.renderSnapshot<HyperbolicGeometry>(snapshots.interpolate(simulation.getTime() - tickInterval));
 			glfwSwapInterval(1);
 			glfwSwapBuffers(window);
+			++frames;
+
+			if (firstFrame) {
+				// GLFW's timer starts at initialization, so this covers all loading, including shader compilation
+				printf("First frame presented %.1f ms after startup\n", glfwGetTime() * 1000.0);
+				firstFrame = false;
+			}
 
 			glfwPollEvents();
 		}
+
+		simulation.stop();
+
+		const TimestepStatistics& timestep = snapshots.getLatest().timestep;
+		printf("Simulated %llu ticks over %llu frames (%.2f per frame), up to %d ticks per update, %.1f ms dropped\n",
+			static_cast<unsigned long long>(timestep.ticks), static_cast<unsigned long long>(frames),
+			frames == 0 ? 0.0 : static_cast<double>(timestep.ticks) / frames, timestep.maxTicksPerUpdate, timestep.droppedSeconds * 1000.0);
+
+		if (recording) {
+			inputRecording.save(options.recordInputPath);
+			printf("Recorded %zu steps of input to %s\n", inputRecording.getSteps().size(), options.recordInputPath.c_str());
+		}
 	}
 
 	void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
@@ -146,16 +201,31 @@ public:
 				glfwSetWindowMonitor(window, NULL, windowedXPos, windowedYPos, windowedWidth, windowedHeight, GLFW_DONT_CARE);
 			}
 		} else if (action == GLFW_PRESS) {
-			inputListener.keyboardKeyPressed(key);
+			input.press(InputState::getKeyBit(key));
+			return;
+		}
+
+		if (action == GLFW_PRESS) {
+			input.hold(InputState::getKeyBit(key));
+		} else if (action == GLFW_RELEASE) {
+			input.release(InputState::getKeyBit(key));
 		}
 	}
 
 	void mouseCallback(GLFWwindow* window, int button, int action, int mods) {
+		// The click that captures the mouse is not passed on as a press
 		if (!isMouseCaptured()) {
 			glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 			glfwSetCursorPos(window, 0, 0);
+			if (action == GLFW_PRESS) {
+				input.hold(InputState::getMouseButtonBit(button));
+			}
 		} else if (action == GLFW_PRESS) {
-			inputListener.mouseButtonPressed(button);
+			input.press(InputState::getMouseButtonBit(button));
+		}
+
+		if (action == GLFW_RELEASE) {
+			input.release(InputState::getMouseButtonBit(button));
 		}
 	}
 
@@ -167,9 +237,12 @@ public:
 	WindowWrapper& operator=(const WindowWrapper&) = delete;
 
 private:
+	static constexpr double tickInterval = 1.0 / 60.0;
+
 	GLFWwindow* window;
 	const ContextWrapper &contextWrapper;
-	InputListener inputListener;
+	const LaunchOptions &options;
+	InputState input; // Kept from the callbacks, since GLFW can only be queried on this thread
 	bool fullscreen = false;
 	int windowedXPos, windowedYPos, windowedWidth, windowedHeight;
 };
@@ -0,0 +1,53 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.h"
+
+namespace {
+	std::atomic<std::size_t> allocations(0);
+	std::atomic<std::size_t> bytesAllocated(0);
+}
+
+namespace AllocationCounter {
+	std::size_t getAllocations() {
+		return allocations.load(std::memory_order_relaxed);
+	}
+
+	std::size_t getBytesAllocated() {
+		return bytesAllocated.load(std::memory_order_relaxed);
+	}
+}
+
+// The array and nothrow forms of operator new call this one, so they are counted as well
+void* operator new(std::size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+	void* pointer = std::malloc(size == 0 ? 1 : size);
+	if (!pointer) {
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
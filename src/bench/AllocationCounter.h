@@ -1,5 +1,3 @@
-#version 150
-
 /*
 	Copyright 2021 Patrick Owen
 
@@ -16,21 +14,12 @@
 	limitations under the License.
  */
 
-uniform mat4 projection;
-uniform mat4 modelView;
-in vec4 vPos;
-in vec4 vNormal;
-in vec2 vTexCoord;
-out vec4 pos;
-out vec4 normal;
-out vec2 texCoord;
-out vec4 pos_global;
+#pragma once
+#include <cstddef>
 
-void main()
-{
-	pos_global = modelView * vPos;
-	gl_Position = projection * pos_global;
-	pos = vPos;
-	normal = vNormal;
-	texCoord = vTexCoord;
+// Counts calls to the global operator new, which the benchmark and test executables replace. Memory allocated with
+// malloc, such as by libpng, is not counted.
+namespace AllocationCounter {
+	std::size_t getAllocations();
+	std::size_t getBytesAllocated();
 }
@@ -0,0 +1,60 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+
+// Usage: hyperworld_bench [--json <file>]
+// With --json, every timing is also written to the file as JSON, in addition to the readable output on stdout.
+int main(int argc, char** argv) {
+	const char* jsonPath = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+			jsonPath = argv[++i];
+		} else {
+			std::fprintf(stderr, "Usage: %s [--json <file>]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	runVectorMathBenchmarks();
+	runVectorMathBatchBenchmarks();
+	runVectorMathPolarBenchmarks();
+	runSpinIsometryBenchmarks();
+	runRenormalizationBenchmarks();
+	runDoubleFloatTransformBenchmarks();
+	runCameraPathBenchmarks();
+	runInputBenchmarks();
+	runSceneBenchmarks();
+	runJobSystemBenchmarks();
+	runMeshBenchmarks();
+	runTextureLoaderBenchmarks();
+
+	if (jsonPath) {
+		std::FILE* file = std::fopen(jsonPath, "w");
+		if (!file) {
+			std::fprintf(stderr, "Could not open %s\n", jsonPath);
+			return EXIT_FAILURE;
+		}
+		Benchmark::writeJson(file);
+		std::fclose(file);
+	}
+
+	return EXIT_SUCCESS;
+}
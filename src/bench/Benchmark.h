@@ -0,0 +1,150 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include "AllocationCounter.h"
+
+class Benchmark {
+public:
+	class Result {
+	public:
+		Result(std::string name, std::size_t itemsPerCall): name(std::move(name)), itemsPerCall(itemsPerCall) {}
+
+		std::string name;
+		std::size_t itemsPerCall;
+		std::vector<double> callNanoseconds; // Sorted, one per timed call
+		double allocationsPerCall = 0;
+		double bytesAllocatedPerCall = 0;
+		std::vector<std::pair<std::string, double>> counters; // Any other per-call measurements, written with the timings
+
+		// Time per item of the given percentile of calls, from 0 to 100, using the nearest-rank method
+		double getPercentile(double percentile) const {
+			std::size_t rank = static_cast<std::size_t>(std::ceil(percentile / 100.0 * callNanoseconds.size()));
+			return callNanoseconds[std::max<std::size_t>(rank, 1) - 1] / itemsPerCall;
+		}
+
+		double getMean() const {
+			double total = 0;
+			for (double nanoseconds : callNanoseconds) {
+				total += nanoseconds;
+			}
+			return total / callNanoseconds.size() / itemsPerCall;
+		}
+	};
+
+	// Calls the function repeatedly for at least minDuration and prints the fastest and median runs, divided by the
+	// number of items processed per call. Returns the fastest in nanoseconds. Every run is kept for writeJson.
+	template<typename F>
+	static double run(const std::string& name, std::size_t itemsPerCall, F&& function) {
+		return run(name, itemsPerCall, []() {}, function);
+	}
+
+	// As above, but calls setup before every call of the function, outside of the timed region
+	template<typename S, typename F>
+	static double run(const std::string& name, std::size_t itemsPerCall, S&& setup, F&& function) {
+		using Clock = std::chrono::steady_clock;
+		const std::chrono::duration<double> minDuration(0.2);
+		const std::size_t minCalls = 5;
+
+		setup();
+		function(); // Warm-up
+
+		Result result(name, itemsPerCall);
+		std::size_t allocations = 0, bytesAllocated = 0;
+		Clock::time_point start = Clock::now();
+		while (result.callNanoseconds.size() < minCalls || Clock::now() - start < minDuration) {
+			setup();
+			std::size_t allocationsBefore = AllocationCounter::getAllocations();
+			std::size_t bytesBefore = AllocationCounter::getBytesAllocated();
+			Clock::time_point callStart = Clock::now();
+			function();
+			Clock::time_point callEnd = Clock::now();
+			allocations += AllocationCounter::getAllocations() - allocationsBefore;
+			bytesAllocated += AllocationCounter::getBytesAllocated() - bytesBefore;
+			result.callNanoseconds.push_back(std::chrono::duration<double, std::nano>(callEnd - callStart).count());
+		}
+
+		result.allocationsPerCall = static_cast<double>(allocations) / result.callNanoseconds.size();
+		result.bytesAllocatedPerCall = static_cast<double>(bytesAllocated) / result.callNanoseconds.size();
+
+		addResult(std::move(result));
+		const Result& added = getResults().back();
+		printf("%-48s %14.2f ns %14.2f ns median %10.1f allocs\n", name.c_str(), added.getPercentile(0), added.getPercentile(50), added.allocationsPerCall);
+		return added.getPercentile(0);
+	}
+
+	// For measurements that cannot be made by calling a function repeatedly, such as frames of a render loop
+	static void addResult(Result result) {
+		std::sort(result.callNanoseconds.begin(), result.callNanoseconds.end());
+		getResults().push_back(std::move(result));
+	}
+
+	static std::vector<Result>& getResults() {
+		static std::vector<Result> results;
+		return results;
+	}
+
+	// Writes every result so far in a fixed layout, so that runs on different commits can be compared line by line.
+	// Times are nanoseconds per item.
+	static void writeJson(std::FILE* file) {
+		std::fprintf(file, "{\n  \"version\": 1,\n  \"benchmarks\": [");
+		const char* separator = "\n";
+		for (const Result& result : getResults()) {
+			std::fprintf(file, "%s    {\n", separator);
+			std::fprintf(file, "      \"name\": \"%s\",\n", escapeJson(result.name).c_str());
+			std::fprintf(file, "      \"itemsPerCall\": %zu,\n", result.itemsPerCall);
+			std::fprintf(file, "      \"repetitions\": %zu,\n", result.callNanoseconds.size());
+			std::fprintf(file, "      \"min\": %.6g,\n", result.getPercentile(0));
+			std::fprintf(file, "      \"p50\": %.6g,\n", result.getPercentile(50));
+			std::fprintf(file, "      \"p90\": %.6g,\n", result.getPercentile(90));
+			std::fprintf(file, "      \"p99\": %.6g,\n", result.getPercentile(99));
+			std::fprintf(file, "      \"max\": %.6g,\n", result.getPercentile(100));
+			std::fprintf(file, "      \"mean\": %.6g,\n", result.getMean());
+			std::fprintf(file, "      \"allocationsPerCall\": %.6g,\n", result.allocationsPerCall);
+			std::fprintf(file, "      \"bytesAllocatedPerCall\": %.6g,\n", result.bytesAllocatedPerCall);
+			std::fprintf(file, "      \"counters\": {");
+			const char* counterSeparator = "";
+			for (const auto& counter : result.counters) {
+				std::fprintf(file, "%s\"%s\": %.6g", counterSeparator, escapeJson(counter.first).c_str(), counter.second);
+				counterSeparator = ", ";
+			}
+			std::fprintf(file, "}\n");
+			std::fprintf(file, "    }");
+			separator = ",\n";
+		}
+		std::fprintf(file, "\n  ]\n}\n");
+	}
+
+private:
+	static std::string escapeJson(const std::string& text) {
+		std::string escaped;
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				escaped += '\\';
+			}
+			escaped += c;
+		}
+		return escaped;
+	}
+};
@@ -0,0 +1,47 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#pragma once
+
+// Each benchmark group runs without a window or GL context
+void runVectorMathBenchmarks();
+
+void runVectorMathBatchBenchmarks();
+
+void runSpinIsometryBenchmarks();
+
+void runRenormalizationBenchmarks();
+
+void runDoubleFloatTransformBenchmarks();
+
+void runCameraPathBenchmarks();
+
+// Builds every mesh in ModelBank, also with the job system, and grows the tessellation round by round
+void runMeshBenchmarks();
+
+// Queries held input, replays a step and parses the default bindings
+void runInputBenchmarks();
+
+// Spawns, steps, snapshots, interpolates and culls 100k moving render nodes, and builds each spawn pattern
+void runSceneBenchmarks();
+
+void runJobSystemBenchmarks();
+
+// Needs the textures directory in the working directory, and skips any texture it cannot find
+void runTextureLoaderBenchmarks();
+
+// Compares the speed and accuracy of svdUnitary with the implementations it replaced
+void runVectorMathPolarBenchmarks();
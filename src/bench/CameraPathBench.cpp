@@ -0,0 +1,82 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../CameraPath.h"
+
+namespace {
+	const std::size_t batchSize = 10000;
+
+	// How much the body-frame velocity changes across a keyframe, estimated with finite differences on either side
+	template<typename F>
+	double velocityJump(F&& pathAt, double keyframeTime) {
+		const double h = 1e-4;
+		SpinIsometry at = pathAt(keyframeTime);
+		SpinIsometry::Matrix2cd before = (pathAt(keyframeTime - h).inverse() * at).log() / h;
+		SpinIsometry::Matrix2cd after = (at.inverse() * pathAt(keyframeTime + h)).log() / h;
+		return (after - before).cwiseAbs().maxCoeff();
+	}
+}
+
+void runCameraPathBenchmarks() {
+	printf("CameraPath (time per evaluation, %zu per batch)\n", batchSize);
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+	std::vector<SpinIsometry> keyframes;
+	for (int i = 0; i < 20; ++i) {
+		Vector3d axis = Vector3d(distribution(random), distribution(random), distribution(random)).normalized();
+		keyframes.push_back(SpinIsometry::displacement(Vector4d(distribution(random), distribution(random), distribution(random), 0))
+			* SpinIsometry::rotation(axis, distribution(random) * M_TAU / 2));
+	}
+	CameraPath path(keyframes, 1.0);
+	SampledCameraPath sampled(path, 1.0 / 60.0);
+
+	std::vector<double> times;
+	for (std::size_t i = 0; i < batchSize; ++i) {
+		times.push_back(path.getDuration() * i / batchSize);
+	}
+	std::vector<Matrix4d> transforms(batchSize);
+	Benchmark::run("CameraPath::getTransform", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			transforms[i] = path.getTransform(times[i]);
+		}
+	});
+	Benchmark::run("SampledCameraPath::getTransform", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			transforms[i] = sampled.getTransform(times[i]);
+		}
+	});
+
+	// The path must pass through every keyframe, and its velocity should only jump where piecewise geodesics would turn
+	double keyframeError = 0, splineJump = 0, geodesicJump = 0;
+	auto geodesicAt = [&](double time) {
+		std::size_t index = std::min(static_cast<std::size_t>(time), keyframes.size() - 2);
+		return SpinIsometry::interpolate(keyframes[index], keyframes[index + 1], time - index);
+	};
+	for (std::size_t i = 0; i < keyframes.size(); ++i) {
+		keyframeError = std::max(keyframeError, (path.getTransform(i) - keyframes[i].toMatrix4d()).cwiseAbs().maxCoeff());
+		if (i > 0 && i + 1 < keyframes.size()) {
+			splineJump = std::max(splineJump, velocityJump([&](double time) { return path.evaluate(time); }, i));
+			geodesicJump = std::max(geodesicJump, velocityJump(geodesicAt, i));
+		}
+	}
+	printf("  Largest distance from a keyframe: %g\n", keyframeError);
+	printf("  Largest velocity change at a keyframe: %g for the path, %g for piecewise geodesics\n", splineJump, geodesicJump);
+}
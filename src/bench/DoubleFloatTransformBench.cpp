@@ -0,0 +1,137 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../VectorMath.h"
+
+// Mirrors the TRANSFORM_DOUBLE_FLOAT path of shaders/standard.vert in float arithmetic, to measure its precision and
+// relative cost without a GL context
+namespace {
+	const std::size_t vertexCount = 10000;
+
+	void twoSum(float a, float b, float& sum, float& error) {
+		sum = a + b;
+		float bRounded = sum - a;
+		error = (a - (sum - bRounded)) + (b - bRounded);
+	}
+
+	void split(float a, float& hi, float& lo) {
+		float scaled = 4097.0f * a;
+		hi = scaled - (scaled - a);
+		lo = a - hi;
+	}
+
+	void twoProduct(float a, float b, float& product, float& error) {
+		product = a * b;
+		float aHi, aLo, bHi, bLo;
+		split(a, aHi, aLo);
+		split(b, bHi, bLo);
+		error = ((aHi * bHi - product) + aHi * bLo + aLo * bHi) + aLo * bLo;
+	}
+
+	// The shader's version for drivers with GL_ARB_gpu_shader5
+	void twoProductFma(float a, float b, float& product, float& error) {
+		product = a * b;
+		error = std::fma(a, b, -product);
+	}
+
+	template<bool useFma>
+	Eigen::Vector4f preciseTransform(const Eigen::Matrix4f& hi, const Eigen::Matrix4f& lo, const Eigen::Vector4f& v) {
+		Eigen::Vector4f result;
+		for (int row = 0; row < 4; ++row) {
+			float sum = 0, sumError = 0;
+			for (int col = 0; col < 4; ++col) {
+				float product, productError, partial, partialError;
+				if (useFma) {
+					twoProductFma(hi(row, col), v(col), product, productError);
+				} else {
+					twoProduct(hi(row, col), v(col), product, productError);
+				}
+				twoSum(sum, product, partial, partialError);
+				sum = partial;
+				sumError = partialError + sumError + productError + lo(row, col) * v(col);
+			}
+			result(row) = sum + sumError;
+		}
+		return result;
+	}
+
+	Eigen::Vector4f singleTransform(const Eigen::Matrix4f& modelView, const Eigen::Vector4f& v) {
+		Eigen::Vector4f result;
+		for (int row = 0; row < 4; ++row) {
+			float sum = 0;
+			for (int col = 0; col < 4; ++col) {
+				sum += modelView(row, col) * v(col);
+			}
+			result(row) = sum;
+		}
+		return result;
+	}
+}
+
+void runDoubleFloatTransformBenchmarks() {
+	printf("Double-float model-view transform, mirrored on the CPU (time per vertex, %zu vertices)\n", vertexCount);
+	printf("  Vertices are within 1 unit of the camera, and the model's origin is at the given distance\n");
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+	for (double distance : {1.0, 5.0, 10.0, 15.0}) {
+		// The model-view places the model's origin far away in a random direction
+		Vector3d direction = Vector3d(distribution(random), distribution(random), distribution(random)).normalized();
+		Matrix4d modelView = VectorMath::hyperbolicDisplacement(Vector4d(direction.x(), direction.y(), direction.z(), 0) * distance)
+			* VectorMath::rotation(Vector3d(0, 0, 1), distribution(random) * M_TAU);
+		Matrix4d inverse = VectorMath::hyperbolicTranspose(modelView);
+
+		Eigen::Matrix4f modelViewHi = modelView.cast<float>();
+		Eigen::Matrix4f modelViewLo = (modelView - modelViewHi.cast<double>()).cast<float>();
+
+		// Vertices near the camera, stored in model coordinates as a mesh would store them
+		std::vector<Eigen::Vector4f> vertices;
+		for (std::size_t i = 0; i < vertexCount; ++i) {
+			Vector4d nearCamera = VectorMath::hyperbolicDisplacement(Vector4d(distribution(random), distribution(random), distribution(random), 0)).col(3);
+			vertices.push_back((inverse * nearCamera).cast<float>());
+		}
+
+		// The reference is the exact transform of the float vertices, so only error from the transform itself counts
+		double singleError = 0, preciseError = 0, fmaError = 0;
+		for (const Eigen::Vector4f& vertex : vertices) {
+			Vector4d exact = modelView * vertex.cast<double>();
+			singleError = std::max(singleError, (singleTransform(modelViewHi, vertex).cast<double>() - exact).cwiseAbs().maxCoeff());
+			preciseError = std::max(preciseError, (preciseTransform<false>(modelViewHi, modelViewLo, vertex).cast<double>() - exact).cwiseAbs().maxCoeff());
+			fmaError = std::max(fmaError, (preciseTransform<true>(modelViewHi, modelViewLo, vertex).cast<double>() - exact).cwiseAbs().maxCoeff());
+		}
+		printf("  Distance %g: largest error %g with single precision, %g with double-float, %g with double-float using fma\n",
+			distance, singleError, preciseError, fmaError);
+	}
+
+	Eigen::Matrix4f modelViewHi = Eigen::Matrix4f::Random(), modelViewLo = Eigen::Matrix4f::Random() * 1e-7f;
+	std::vector<Eigen::Vector4f> vertices(vertexCount, Eigen::Vector4f(0.5f, -0.25f, 0.125f, 1.0f)), results(vertexCount);
+	Benchmark::run("single precision", vertexCount, [&]() {
+		for (std::size_t i = 0; i < vertexCount; ++i) {
+			results[i] = singleTransform(modelViewHi, vertices[i]);
+		}
+	});
+	Benchmark::run("double-float", vertexCount, [&]() {
+		for (std::size_t i = 0; i < vertexCount; ++i) {
+			results[i] = preciseTransform<false>(modelViewHi, modelViewLo, vertices[i]);
+		}
+	});
+}
@@ -0,0 +1,78 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../InputBindings.h"
+#include "../InputCode.h"
+#include "../InputRecording.h"
+#include "../InputState.h"
+#include "../UserInput.h"
+
+namespace {
+	const std::size_t queryCount = 10000;
+
+	RecordedInputStep makeStep(std::vector<int> keysDown, std::vector<int> keysPressed) {
+		RecordedInputStep step;
+		step.dt = 1.0 / 60.0;
+		step.keysDown = keysDown;
+		step.keysPressed = keysPressed;
+		return step;
+	}
+
+	// Every action's default binding, written out as a binding file
+	std::string writeDefaults() {
+		InputBindings defaults;
+		std::string text = "# The default bindings\n";
+		for (int action = 0; action < InputBindings::actionCount; ++action) {
+			text += std::string(InputBindings::getActionName(static_cast<InputAction>(action))) + " =";
+			for (int bit : defaults.getBits(static_cast<InputAction>(action))) {
+				if (bit != InputState::nullBit) {
+					text += " " + InputBindings::getInputName(bit) + ",";
+				}
+			}
+			text.back() = '\n';
+		}
+		return text;
+	}
+}
+
+void runInputBenchmarks() {
+	printf("UserInput (time per query)\n");
+
+	// Every action, with some of them held
+	InputBindings bindings;
+	InputState state;
+	makeStep({InputCode::KEY_A, InputCode::KEY_W}, {InputCode::KEY_W}).applyTo(state);
+	UserInput userInput(state, bindings, Vector2d::Zero());
+
+	std::size_t held = 0;
+	Benchmark::run("isPressed and pressedThisStep", queryCount * 2, [&]() {
+		for (std::size_t i = 0; i < queryCount; ++i) {
+			InputAction action = static_cast<InputAction>(i % InputBindings::actionCount);
+			held += userInput.isPressed(action) + userInput.pressedThisStep(action);
+		}
+	});
+	printf("  %zu queries reported held input\n", held);
+
+	RecordedInputStep step = makeStep({InputCode::KEY_A, InputCode::KEY_W, InputCode::KEY_LEFT_SHIFT}, {InputCode::KEY_LEFT_SHIFT});
+	Benchmark::run("RecordedInputStep::applyTo", 1, [&]() { step.applyTo(state); });
+
+	std::string defaultText = writeDefaults();
+	Benchmark::run("InputBindings::parse, every action", 1, [&]() { InputBindings::parse(defaultText, "defaults"); });
+}
@@ -0,0 +1,78 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../JobSystem.h"
+
+namespace {
+	const std::size_t jobCount = 10000;
+	const int forkDepth = 13; // 8192 leaves
+
+	// Each job forks two more until the depth runs out, as the tree builder does
+	void fork(JobSystem& jobs, JobSystem::JobGroup& group, std::atomic<std::size_t>& leaves, int depth) {
+		if (depth == 0) {
+			leaves.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		for (int i = 0; i < 2; ++i) {
+			jobs.run(group, [&jobs, &group, &leaves, depth]() { fork(jobs, group, leaves, depth - 1); });
+		}
+	}
+}
+
+// Scheduling overhead, measured with jobs that do nothing, so every number is time per job
+void runJobSystemBenchmarks() {
+	for (unsigned threadCount : {1u, 4u}) {
+		JobSystem jobs(threadCount);
+		std::string suffix = ", " + std::to_string(threadCount) + " thread" + (threadCount == 1 ? "" : "s");
+		printf("JobSystem%s (time per job)\n", suffix.c_str());
+
+		std::atomic<std::size_t> count(0);
+		Benchmark::run("run and wait, independent jobs" + suffix, jobCount, [&]() {
+			JobSystem::JobGroup group;
+			for (std::size_t i = 0; i < jobCount; ++i) {
+				jobs.run(group, [&count]() { count.fetch_add(1, std::memory_order_relaxed); });
+			}
+			jobs.wait(group);
+		});
+
+		Benchmark::run("parallelFor, grain size 1" + suffix, jobCount, [&]() {
+			jobs.parallelFor(0, jobCount, 1, [&count](std::size_t) { count.fetch_add(1, std::memory_order_relaxed); });
+		});
+
+		std::atomic<std::size_t> leaves(0);
+		Benchmark::run("recursive fork" + suffix, (std::size_t(2) << forkDepth) - 1, [&]() {
+			leaves = 0;
+			JobSystem::JobGroup group;
+			jobs.run(group, [&]() { fork(jobs, group, leaves, forkDepth); });
+			jobs.wait(group);
+		});
+
+		// Each stage is a continuation of the one before it, so only one job is ever queued at a time
+		Benchmark::run("continuation chain" + suffix, jobCount, [&]() {
+			std::vector<JobSystem::JobGroup> stages(jobCount);
+			jobs.run(stages[0], []() {});
+			for (std::size_t i = 1; i < jobCount; ++i) {
+				jobs.runAfter(stages[i - 1], stages[i], []() {});
+			}
+			jobs.wait(stages[jobCount - 1]);
+		});
+	}
+}
@@ -0,0 +1,68 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <memory>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../MeshGenerators.h"
+#include "../Tessellation.h"
+
+// Only the CPU side of each model is built, so no GL context is needed
+void runMeshBenchmarks() {
+	printf("Meshes (time per mesh)\n");
+
+	Mesh mesh;
+	Benchmark::run("makeDodecahedron", 1, [&]() { mesh = makeDodecahedron(); });
+	Benchmark::run("makeSphericalTetrahedron", 1, [&]() { mesh = makeSphericalTetrahedron(); });
+	Benchmark::run("makeHorosphere", 1, [&]() { mesh = makeHorosphere(); });
+	Benchmark::run("makePlane", 1, [&]() { mesh = makePlane(); });
+	Benchmark::run("makePrism", 1, [&]() { mesh = makePrism(); });
+	Benchmark::run("makeTree", 1, [&]() { mesh = makeTree(); });
+
+	// At least one worker thread is started even on a single core
+	JobSystem jobs(std::max(std::thread::hardware_concurrency(), 2u));
+	Benchmark::run("makeHorosphere, " + std::to_string(jobs.getThreadCount()) + " threads", 1, [&]() { mesh = makeHorosphere(jobs); });
+	Benchmark::run("makeTree, " + std::to_string(jobs.getThreadCount()) + " threads", 1, [&]() { mesh = makeTree(jobs); });
+
+	// The tree is the largest mesh without back faces
+	ModelBuilder treeBuilder;
+	TreeBuilder().buildTree(treeBuilder, SpinIsometry(), 7);
+	ModelBuilder builder;
+	Benchmark::run("ModelBuilder::addBackFaces, tree", 1, [&]() { builder = treeBuilder; }, [&]() { builder.addBackFaces(); });
+
+	// Each round is timed separately, starting from a tessellation grown to the previous round
+	const unsigned rounds = 18;
+	std::unique_ptr<Tessellation> tessellation;
+	for (unsigned round = 1; round <= rounds; ++round) {
+		std::size_t facesBefore = 0, facesAfter = 0;
+		auto setup = [&]() {
+			tessellation = std::make_unique<Tessellation>();
+			tessellation->createSeedFaces();
+			for (unsigned i = 1; i < round; ++i) {
+				tessellation->grow();
+			}
+			facesBefore = tessellation->getNumFaces();
+		};
+		setup();
+		tessellation->grow();
+		facesAfter = tessellation->getNumFaces();
+
+		// Time per face added
+		Benchmark::run("Tessellation::grow, round " + std::to_string(round), std::max<std::size_t>(facesAfter - facesBefore, 1), setup, [&]() { tessellation->grow(); });
+	}
+}
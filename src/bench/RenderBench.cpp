@@ -0,0 +1,327 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "../EglContextWrapper.h"
+#include "../OffscreenFramebuffer.h"
+#include "../VectorMath.h"
+#include "../ShaderProgramBank.h"
+#include "../JobSystem.h"
+#include "../ModelBank.h"
+#include "../TextureBank.h"
+#include "../TextureLoader.h"
+#include "../RenderContext.h"
+#include "../Scene.h"
+#include "../GhostCamera.h"
+#include "../SimpleSpawner.h"
+#include "../InputRecording.h"
+#include "../CameraPath.h"
+#include "../SimulationThread.h"
+
+// Renders a fixed scene along a sampled camera path into an offscreen framebuffer, timing every frame. Like the game,
+// it must be run from the directory containing shaders and textures.
+namespace {
+	class RenderBenchOptions {
+	public:
+		RenderBenchOptions(int argc, char* argv[]) {
+			for (int i = 1; i < argc; ++i) {
+				std::string argument = argv[i];
+				if (argument == "--simulation-thread") {
+					simulationThread = true;
+					continue;
+				}
+				if (argument == "--uncompressed-textures") {
+					compressTextures = false;
+					continue;
+				}
+				if (argument == "--double-float-transforms") {
+					doubleFloatTransforms = true;
+					continue;
+				}
+				if (i + 1 >= argc) {
+					throw std::runtime_error("Missing value for command-line argument: " + argument);
+				}
+				if (argument == "--frames") {
+					frames = std::stoi(argv[++i]);
+				} else if (argument == "--width") {
+					width = std::stoi(argv[++i]);
+				} else if (argument == "--height") {
+					height = std::stoi(argv[++i]);
+				} else if (argument == "--dump") {
+					dumpDirectory = argv[++i];
+				} else if (argument == "--dump-every") {
+					dumpEvery = std::stoi(argv[++i]);
+				} else if (argument == "--nodes") {
+					nodes = std::stoi(argv[++i]);
+				} else if (argument == "--replay") {
+					replayPath = argv[++i];
+				} else if (argument == "--json") {
+					jsonPath = argv[++i];
+				} else {
+					throw std::runtime_error("Unknown command-line argument: " + argument);
+				}
+			}
+		}
+
+		int frames = 300;
+		int width = 800;
+		int height = 600;
+		std::string dumpDirectory; // Frames are only written if this is set, as frame_0000.png and so on
+		int dumpEvery = 1;
+		std::string jsonPath;
+		std::string replayPath; // If set, recorded input drives the game's camera and spawner instead of the orbiting camera
+		bool simulationThread = false; // Replays on a simulation thread and draws interpolated snapshots, as the game does
+		int nodes = 0; // Moving dodecahedra added around the fixed scene
+		bool compressTextures = true; // Uploads BC1 textures if the driver supports them, as the game does
+		bool doubleFloatTransforms = false; // As the game's option of the same name
+	};
+
+	const double frameInterval = 1.0 / 60.0;
+
+	// Circles the scene's origin once every ten seconds while looking toward it, so the visible geometry changes from
+	// frame to frame
+	CameraPath makeOrbit() {
+		std::vector<SpinIsometry> keyframes;
+		for (int i = 0; i <= 10; ++i) {
+			keyframes.push_back(SpinIsometry::rotation(Vector3d(0, 0, 1), i * M_TAU / 10)
+				* SpinIsometry::displacement(Vector4d(0, -1.5, 0.3, 0))
+				* SpinIsometry::rotation(Vector3d(1, 0, 0), M_TAU / 5.0));
+		}
+		return CameraPath(keyframes, 1.0);
+	}
+
+	// One of each model, placed around the origin
+	void populateScene(Scene<HyperbolicGeometry>& scene) {
+		const Anchor& root = scene.getAnchors().getRoot();
+		RenderNodeStore& nodes = scene.getRenderNodes();
+		nodes.add(root, VectorMath::hyperbolicDisplacement(Vector4d(0, 0, -0.5, 0)), ModelHandle::PLANE, TextureHandle::PERLIN);
+		nodes.add(root, VectorMath::hyperbolicDisplacement(Vector4d(0, 0, -1.5, 0)), ModelHandle::HOROSPHERE, TextureHandle::TILE);
+		nodes.add(root, Matrix4d::Identity(), ModelHandle::TREE, TextureHandle::BLANK);
+		nodes.add(root, VectorMath::hyperbolicDisplacement(Vector4d(0, 0, 1.5, 0)), ModelHandle::PRISM, TextureHandle::BLANK);
+		for (int i = 0; i < 4; ++i) {
+			Matrix4d transform = VectorMath::rotation(Vector3d(0, 0, 1), i * M_TAU / 4) * VectorMath::hyperbolicDisplacement(Vector4d(3, 0, 0.5, 0));
+			nodes.add(root, transform, ModelHandle::DODECAHEDRON, TextureHandle::PERLIN);
+		}
+	}
+
+	// Scatters spinning, drifting dodecahedra around the origin, at the same positions every run
+	void addMovingNodes(Scene<HyperbolicGeometry>& scene, int count) {
+		const Anchor& root = scene.getAnchors().getRoot();
+		RenderNodeStore& nodes = scene.getRenderNodes();
+		nodes.reserve(nodes.getSize() + count);
+		std::mt19937 random(1);
+		std::normal_distribution<double> direction;
+		std::uniform_real_distribution<double> distance(2.0, 8.0);
+		for (int i = 0; i < count; ++i) {
+			Vector3d offset = Vector3d(direction(random), direction(random), direction(random)).normalized() * distance(random);
+			SlotHandle node = nodes.add(root, VectorMath::hyperbolicDisplacement(Vector4d(offset.x(), offset.y(), offset.z(), 0)),
+				ModelHandle::DODECAHEDRON, TextureHandle::PERLIN);
+			Motion motion;
+			motion.velocity = Vector3d(direction(random), direction(random), direction(random)) * 0.1;
+			motion.angularVelocity = Vector3d(direction(random), direction(random), direction(random));
+			nodes.setMotion(node, motion);
+		}
+	}
+
+	void run(const RenderBenchOptions& options) {
+		using Clock = std::chrono::steady_clock;
+		Clock::time_point startupStart = Clock::now();
+
+		EglContextWrapper eglContext;
+		printf("Renderer: %s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+		OffscreenFramebuffer framebuffer(options.width, options.height);
+		Scene<HyperbolicGeometry> scene;
+		SampledCameraPath orbit(makeOrbit(), frameInterval);
+		PathCamera<SampledCameraPath> orbitCamera(scene.getAnchors().getRoot(), orbit);
+		GhostCamera<HyperbolicGeometry> ghostCamera(scene.getAnchors());
+		SimpleSpawner simpleSpawner(scene, ghostCamera);
+		JobSystem jobs;
+		ModelBank modelBank(jobs);
+		TextureBank textureBank(jobs, options.compressTextures);
+		ShaderProgramBank shaderProgramBank;
+		RenderContext context(shaderProgramBank, modelBank, textureBank);
+		populateScene(scene);
+		addMovingNodes(scene, options.nodes);
+		if (options.doubleFloatTransforms) {
+			modelBank.setExtendedModelsTransformPrecision(TransformPrecision::DOUBLE_FLOAT);
+		}
+
+		context.setGeometry<HyperbolicGeometry>();
+		context.setDimensions(options.width, options.height);
+
+		InputRecording replay;
+		InputState replayInput;
+		InputBindings bindings; // The defaults, so replays do not depend on the bindings file
+		int frames = options.frames;
+		if (options.replayPath.empty()) {
+			scene.setCamera(orbitCamera);
+		} else {
+			replay = InputRecording::load(options.replayPath);
+			scene.setCamera(ghostCamera);
+			scene.addEntity(ghostCamera);
+			scene.addEntity(simpleSpawner);
+		}
+
+		// The simulation thread ticks in real time, so frames are not tied to recorded steps and the loop ends with
+		// the replay instead
+		std::unique_ptr<SimulationThread<HyperbolicGeometry>> simulation;
+		SnapshotInterpolator<HyperbolicGeometry> snapshots;
+		if (options.simulationThread) {
+			if (options.replayPath.empty()) {
+				throw std::runtime_error("--simulation-thread needs --replay");
+			}
+			simulation = std::make_unique<SimulationThread<HyperbolicGeometry>>(scene, bindings, frameInterval);
+			simulation->replay(replay);
+		} else if (!options.replayPath.empty()) {
+			frames = std::min<int>(frames, replay.getSteps().size());
+		}
+
+		framebuffer.bind();
+		glEnable(GL_DEPTH_TEST);
+		glEnable(GL_FRAMEBUFFER_SRGB);
+		glEnable(GL_CULL_FACE);
+
+		double startupMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - startupStart).count();
+
+		// The first frame compiles shaders, so it is reported separately
+		Benchmark::Result submitTimes("frame CPU step and submit", 1);
+		Benchmark::Result frameTimes("frame wall time", 1);
+		double firstFrameMilliseconds = 0;
+		FrameStatistics statistics;
+		std::size_t allocations = 0;
+
+		if (simulation) {
+			simulation->start();
+		}
+
+		Clock::time_point loopStart = Clock::now();
+		for (int frame = 0; frame < frames; ++frame) {
+			std::size_t allocationsBefore = AllocationCounter::getAllocations();
+			Clock::time_point frameStart = Clock::now();
+
+			if (simulation) {
+				if (simulation->isFinished()) {
+					frames = frame;
+					break;
+				}
+				if (simulation->getSnapshots().update()) {
+					snapshots.add(simulation->getSnapshots().getFront());
+				}
+				context.renderSnapshot<HyperbolicGeometry>(snapshots.interpolate(simulation->getTime() - frameInterval));
+			} else if (options.replayPath.empty()) {
+				orbitCamera.setTime(frame * frameInterval);
+				scene.getRenderNodes().integrate<HyperbolicGeometry>(frameInterval);
+			} else {
+				// Stepping is part of the frame's CPU time here, unlike with --simulation-thread
+				const RecordedInputStep& step = replay.getSteps()[frame];
+				step.applyTo(replayInput);
+				scene.step(step.dt, UserInput(replayInput, bindings, step.mouseLook));
+			}
+
+			if (!simulation) {
+				context.renderScene(scene);
+			}
+			Clock::time_point submitted = Clock::now();
+			glFinish();
+			Clock::time_point finished = Clock::now();
+
+			if (frame == 0) {
+				firstFrameMilliseconds = std::chrono::duration<double, std::milli>(finished - frameStart).count();
+			} else {
+				submitTimes.callNanoseconds.push_back(std::chrono::duration<double, std::nano>(submitted - frameStart).count());
+				frameTimes.callNanoseconds.push_back(std::chrono::duration<double, std::nano>(finished - frameStart).count());
+				allocations += AllocationCounter::getAllocations() - allocationsBefore;
+			}
+			statistics = context.getFrameStatistics();
+
+			if (!options.dumpDirectory.empty() && frame % options.dumpEvery == 0) {
+				char fileName[32];
+				snprintf(fileName, sizeof(fileName), "/frame_%04d.png", frame);
+				TextureLoader::saveTexture(options.dumpDirectory + fileName, framebuffer.readPixels());
+			}
+		}
+		double loopMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - loopStart).count();
+
+		printf("%d frames at %dx%d, %zu draw calls and %zu triangles per frame, %zu render nodes culled\n",
+			frames, options.width, options.height, statistics.drawCalls, statistics.triangles, statistics.culledNodes);
+		printf("Startup %.1f ms, first frame %.1f ms, all frames %.1f ms\n", startupMilliseconds, firstFrameMilliseconds, loopMilliseconds);
+		for (const TextureLoadStatistics& texture : textureBank.getLoadStatistics()) {
+			const char* formatNames[] = {"RGB8", "RGBA8", "BC1"};
+			printf("  %s %dx%d %s, %zu levels, %.1f KiB: %s in %.2f ms, uploaded in %.2f ms\n", texture.name.c_str(),
+				texture.width, texture.height, formatNames[static_cast<int>(texture.format)], texture.levels,
+				texture.bytes / 1024.0, texture.converted ? "converted" : "read from cache", texture.loadMilliseconds,
+				texture.uploadMilliseconds);
+		}
+		if (simulation) {
+			const TimestepStatistics& timestep = snapshots.getLatest().timestep;
+			printf("Simulated %llu ticks (%.2f per frame), up to %d ticks per update, %.1f ms dropped\n",
+				static_cast<unsigned long long>(timestep.ticks), static_cast<double>(timestep.ticks) / std::max(frames, 1),
+				timestep.maxTicksPerUpdate, timestep.droppedSeconds * 1000.0);
+		}
+
+		if (frameTimes.callNanoseconds.empty()) {
+			return;
+		}
+		for (Benchmark::Result* result : {&submitTimes, &frameTimes}) {
+			result->allocationsPerCall = static_cast<double>(allocations) / result->callNanoseconds.size();
+			result->counters = {
+				{"drawCalls", static_cast<double>(statistics.drawCalls)},
+				{"triangles", static_cast<double>(statistics.triangles)},
+				{"culledNodes", static_cast<double>(statistics.culledNodes)}
+			};
+			if (simulation) {
+				const TimestepStatistics& timestep = snapshots.getLatest().timestep;
+				result->counters.emplace_back("ticksPerFrame", static_cast<double>(timestep.ticks) / frames);
+				result->counters.emplace_back("maxTicksPerUpdate", timestep.maxTicksPerUpdate);
+				result->counters.emplace_back("droppedMilliseconds", timestep.droppedSeconds * 1000.0);
+			}
+			Benchmark::addResult(std::move(*result));
+			const Benchmark::Result& added = Benchmark::getResults().back();
+			printf("%-28s min %8.3f ms  median %8.3f ms  p90 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n", added.name.c_str(),
+				added.getPercentile(0) * 1e-6, added.getPercentile(50) * 1e-6, added.getPercentile(90) * 1e-6,
+				added.getPercentile(99) * 1e-6, added.getPercentile(100) * 1e-6);
+		}
+
+		if (!options.jsonPath.empty()) {
+			std::FILE* file = std::fopen(options.jsonPath.c_str(), "w");
+			if (!file) {
+				throw std::runtime_error("Could not open " + options.jsonPath);
+			}
+			Benchmark::writeJson(file);
+			std::fclose(file);
+		}
+	}
+}
+
+// Usage: hyperworld_render_bench [--frames N] [--width W] [--height H] [--dump <directory>] [--dump-every N] [--json <file>]
+//     [--nodes N] [--replay <file> [--simulation-thread]] [--uncompressed-textures] [--double-float-transforms]
+int main(int argc, char* argv[]) {
+	try {
+		run(RenderBenchOptions(argc, argv));
+		return EXIT_SUCCESS;
+	} catch (const std::exception& e) {
+		fprintf(stderr, "Fatal error: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,108 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../VectorMath.h"
+
+namespace {
+	const std::size_t batchSize = 10000;
+	const std::size_t chainLength = 100000;
+
+	// Isometries with noise of the given size, which becomes drift of a few times that size
+	std::vector<Matrix4d> makeDrifted(std::mt19937& random, double noiseSize) {
+		std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+		std::normal_distribution<double> noise(0.0, noiseSize);
+		std::vector<Matrix4d> result;
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			Vector3d axis(distribution(random), distribution(random), distribution(random));
+			Vector4d displacement(distribution(random), distribution(random), distribution(random), 0);
+			Matrix4d isometry = VectorMath::hyperbolicDisplacement(displacement) * VectorMath::rotation(axis.normalized(), distribution(random) * M_TAU);
+			result.push_back(isometry + Matrix4d::NullaryExpr([&]() { return noise(random); }));
+		}
+		return result;
+	}
+
+	void compare(const std::string& name, const std::vector<Matrix4d>& inputs) {
+		std::vector<Matrix4d> results(inputs.size());
+		double maxDrift = 0;
+		for (const Matrix4d& input : inputs) {
+			maxDrift = std::max(maxDrift, HyperbolicGeometry::drift(input));
+		}
+		printf("  %s: drift up to %g\n", name.c_str(), maxDrift);
+
+		Benchmark::run("  qrUnitary", inputs.size(), [&]() {
+			for (std::size_t i = 0; i < inputs.size(); ++i) {
+				results[i] = HyperbolicGeometry::qrUnitary(inputs[i]);
+			}
+		});
+		Benchmark::run("  correctDrift", inputs.size(), [&]() {
+			for (std::size_t i = 0; i < inputs.size(); ++i) {
+				results[i] = HyperbolicGeometry::correctDrift(inputs[i]);
+			}
+		});
+
+		maxDrift = 0;
+		for (const Matrix4d& result : results) {
+			maxDrift = std::max(maxDrift, HyperbolicGeometry::drift(result));
+		}
+		printf("    Drift after correctDrift: %g\n", maxDrift);
+	}
+}
+
+void runRenormalizationBenchmarks() {
+	printf("Drift correction (time per matrix, %zu per batch)\n", batchSize);
+
+	std::mt19937 random(1);
+	compare("Rounding-level drift, as after one camera step", makeDrifted(random, 1e-16));
+	compare("Small drift", makeDrifted(random, 1e-10));
+	compare("Large drift", makeDrifted(random, 1e-4));
+
+	// A long chain of compositions, like a camera moving for a long time, renormalized after every step. Each step
+	// is a small rotation about a random point, which keeps the chain from wandering off to where it overflows.
+	std::vector<Matrix4d> steps = makeDrifted(random, 0);
+	for (Matrix4d& step : steps) {
+		step = step * VectorMath::rotation(Vector3d(0, 1, 0), 0.01) * HyperbolicGeometry::transpose(step);
+	}
+
+	Matrix4d chain = Matrix4d::Identity();
+	Benchmark::run("Chain of compositions, qrUnitary after each", chainLength, [&]() {
+		chain = Matrix4d::Identity();
+		for (std::size_t i = 0; i < chainLength; ++i) {
+			chain = HyperbolicGeometry::qrUnitary(chain * steps[i % batchSize]);
+		}
+	});
+	printf("  Final drift: %g\n", HyperbolicGeometry::drift(chain));
+
+	Benchmark::run("Chain of compositions, correctDrift after each", chainLength, [&]() {
+		chain = Matrix4d::Identity();
+		for (std::size_t i = 0; i < chainLength; ++i) {
+			chain = HyperbolicGeometry::correctDrift(chain * steps[i % batchSize]);
+		}
+	});
+	printf("  Final drift: %g\n", HyperbolicGeometry::drift(chain));
+
+	Benchmark::run("Chain of compositions, never renormalized", chainLength, [&]() {
+		chain = Matrix4d::Identity();
+		for (std::size_t i = 0; i < chainLength; ++i) {
+			chain = chain * steps[i % batchSize];
+		}
+	});
+	printf("  Final drift: %g\n", HyperbolicGeometry::drift(chain));
+}
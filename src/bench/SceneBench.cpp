@@ -0,0 +1,151 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../Anchor.h"
+#include "../RenderNodeStore.h"
+#include "../DrawList.h"
+#include "../SpawnPatterns.h"
+#include "../RenderSnapshot.h"
+#include "../VectorMath.h"
+
+namespace {
+	const std::size_t nodeCount = 100000;
+}
+
+void runSceneBenchmarks() {
+	printf("RenderNodeStore and DrawList (time per node, %zu nodes)\n", nodeCount);
+
+	AnchorTree anchors;
+	const Anchor& root = anchors.getRoot();
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> distribution(-3.0, 3.0);
+	std::vector<Matrix4d> transforms;
+	for (std::size_t i = 0; i < nodeCount; ++i) {
+		transforms.push_back(VectorMath::hyperbolicDisplacement(Vector4d(distribution(random), distribution(random), distribution(random), 0)));
+	}
+
+	RenderNodeStore store;
+	std::vector<SlotHandle> handles;
+	Benchmark::run("add", nodeCount, [&]() {
+		store = RenderNodeStore();
+		handles.clear();
+		for (std::size_t i = 0; i < nodeCount; ++i) {
+			handles.push_back(store.add(root, transforms[i], ModelHandle::DODECAHEDRON, TextureHandle::PERLIN));
+		}
+	});
+
+	Benchmark::run("addAll, empty store", nodeCount, [&]() {
+		store = RenderNodeStore();
+		handles.clear();
+		store.addAll(root, transforms, ModelHandle::DODECAHEDRON, TextureHandle::PERLIN, handles);
+	});
+
+	// Despawning a batch and spawning it again reuses the despawned nodes' slots and space
+	Benchmark::run("removeAll and addAll", nodeCount, [&]() {
+		store.removeAll(handles);
+		handles.clear();
+		store.addAll(root, transforms, ModelHandle::DODECAHEDRON, TextureHandle::PERLIN, handles);
+	});
+
+	// Every node moves, as if the whole scene had been spawned with a velocity
+	for (std::size_t i = 0; i < nodeCount; ++i) {
+		Motion motion;
+		motion.velocity = Vector3d(distribution(random), distribution(random), distribution(random)) * 0.1;
+		motion.angularVelocity = Vector3d(distribution(random), distribution(random), distribution(random));
+		store.setMotion(handles[i], motion);
+	}
+	Benchmark::run("integrate", nodeCount, [&]() {
+		store.integrate<HyperbolicGeometry>(1.0 / 60.0);
+	});
+
+	RenderSnapshot snapshot;
+	snapshot.view = VectorMath::hyperbolicDisplacement(Vector4d(0, 0, 1, 0));
+	snapshot.hasCamera = true;
+	Benchmark::run("addToSnapshot", nodeCount, [&]() {
+		snapshot.nodes.clear();
+		snapshot.motions.clear();
+		store.addToSnapshot(snapshot);
+	});
+
+	// Drift is only corrected every few steps, so this shows how much builds up, measured as for the spawn patterns below
+	double integratedDrift = 0;
+	for (const RenderSnapshotNode& node : snapshot.nodes) {
+		double scale = node.transform.cwiseAbs().maxCoeff();
+		integratedDrift = std::max(integratedDrift, HyperbolicGeometry::drift(node.transform) / (scale * scale));
+	}
+	printf("  largest relative drift of an integrated node %g\n", integratedDrift);
+
+	// Every node moves between the two snapshots, which is the most a frame's interpolation can cost
+	RenderSnapshot nextSnapshot = snapshot;
+	store.integrate<HyperbolicGeometry>(1.0 / 60.0);
+	nextSnapshot.nodes.clear();
+	nextSnapshot.motions.clear();
+	store.addToSnapshot(nextSnapshot);
+	nextSnapshot.tick = snapshot.tick + 1;
+	nextSnapshot.time = snapshot.time + 1.0 / 60.0;
+
+	// Adding the earlier snapshot again goes back in time, which is not interpolated, so each call prepares one
+	// interpolation
+	SnapshotInterpolator<HyperbolicGeometry> interpolator;
+	Benchmark::run("SnapshotInterpolator::add", nodeCount, [&]() {
+		interpolator.add(snapshot);
+		interpolator.add(nextSnapshot);
+	});
+	Benchmark::run("SnapshotInterpolator::interpolate", nodeCount, [&]() {
+		interpolator.interpolate(snapshot.time + 0.5 / 60.0);
+	});
+
+	DrawList drawList;
+	Benchmark::run("DrawList::build", nodeCount, [&]() {
+		drawList.build<HyperbolicGeometry>(snapshot, 4.0 / 3.0, 1.0);
+	});
+	printf("  %zu of %zu nodes culled\n", drawList.getCulledCount(), nodeCount);
+
+	// Removes every other node and adds it back, so half of the adds reuse a free slot. This also removes the motion of
+	// every other node.
+	Benchmark::run("remove and add", nodeCount, [&]() {
+		for (std::size_t i = 0; i < nodeCount; i += 2) {
+			store.remove(handles[i]);
+		}
+		for (std::size_t i = 0; i < nodeCount; i += 2) {
+			handles[i] = store.add(root, transforms[i], ModelHandle::PRISM, TextureHandle::BLANK);
+		}
+	});
+
+	printf("SpawnPatterns (time per transform)\n");
+	std::vector<Matrix4d> pattern;
+	Benchmark::run("randomBall, 10000, radius 5", 10000, [&]() { pattern = SpawnPatterns::randomBall(10000, 5.0, random); });
+	Benchmark::run("geodesicGrid, 20 per axis", 8000, [&]() { pattern = SpawnPatterns::geodesicGrid(20, 0.25); });
+	pattern = SpawnPatterns::tessellation(18);
+	std::size_t pentagons = pattern.size();
+	Benchmark::run("tessellation, 18 rounds", pentagons, [&]() { pattern = SpawnPatterns::tessellation(18); });
+
+	// How far the patterns are from isometries. The entries of a distant transform are large, so its drift is measured
+	// relative to the square of its largest entry, which is the most rounding could explain.
+	double drift = 0;
+	for (const auto& transforms : {SpawnPatterns::randomBall(1000, 5.0, random), SpawnPatterns::geodesicGrid(5, 2.5), pattern}) {
+		for (const Matrix4d& transform : transforms) {
+			double scale = transform.cwiseAbs().maxCoeff();
+			drift = std::max(drift, HyperbolicGeometry::drift(transform) / (scale * scale));
+		}
+	}
+	printf("  %zu pentagons, largest relative drift from an isometry %g\n", pentagons, drift);
+}
@@ -0,0 +1,117 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../VectorMath.h"
+#include "../SpinIsometry.h"
+
+namespace {
+	const std::size_t batchSize = 10000;
+	const std::size_t driftSteps = 1000000;
+
+	double isometryError(const Matrix4d& matrix) {
+		return (VectorMath::hyperbolicTranspose(matrix) * matrix - Matrix4d::Identity()).cwiseAbs().maxCoeff();
+	}
+
+	// Small steps like the ones a moving camera takes each frame
+	void makeSteps(std::mt19937& random, std::size_t count, std::vector<Matrix4d>& matrices, std::vector<SpinIsometry>& spins) {
+		std::uniform_real_distribution<double> distribution(-0.02, 0.02);
+		for (std::size_t i = 0; i < count; ++i) {
+			Vector4d displacement(distribution(random), distribution(random), distribution(random), 0);
+			Vector3d axis = Vector3d(distribution(random), distribution(random), distribution(random)).normalized();
+			double angle = distribution(random);
+			matrices.push_back(VectorMath::hyperbolicDisplacement(displacement) * VectorMath::rotation(axis, angle));
+			spins.push_back(SpinIsometry::displacement(displacement) * SpinIsometry::rotation(axis, angle));
+		}
+	}
+}
+
+void runSpinIsometryBenchmarks() {
+	printf("SpinIsometry (%zu bytes) compared to Matrix4d (%zu bytes), time per operation, %zu per batch\n",
+		sizeof(SpinIsometry), sizeof(Matrix4d), batchSize);
+
+	std::mt19937 random(1);
+	std::vector<Matrix4d> matrices, matrixResults(batchSize);
+	std::vector<SpinIsometry> spins, spinResults(batchSize);
+	makeSteps(random, batchSize, matrices, spins);
+
+	Benchmark::run("independent compositions, Matrix4d", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			matrixResults[i] = matrices[i] * matrices[batchSize - 1 - i];
+		}
+	});
+	Benchmark::run("independent compositions, SpinIsometry", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			spinResults[i] = spins[i] * spins[batchSize - 1 - i];
+		}
+	});
+
+	// Each step depends on the previous one, as in a transform hierarchy
+	Benchmark::run("chained compositions, Matrix4d", batchSize, [&]() {
+		Matrix4d chain = Matrix4d::Identity();
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			chain *= matrices[i];
+		}
+		matrixResults[0] = chain;
+	});
+	Benchmark::run("chained compositions, SpinIsometry", batchSize, [&]() {
+		SpinIsometry chain;
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			chain *= spins[i];
+		}
+		spinResults[0] = chain;
+	});
+
+	Benchmark::run("renormalize, Matrix4d hyperbolicQrUnitary", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			matrixResults[i] = VectorMath::hyperbolicQrUnitary(matrices[i]);
+		}
+	});
+	Benchmark::run("renormalize, SpinIsometry", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			spinResults[i] = spins[i].renormalized();
+		}
+	});
+	Benchmark::run("convert to Matrix4d for upload, SpinIsometry", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			matrixResults[i] = spins[i].toMatrix4d();
+		}
+	});
+
+	// Drift: compose a closed loop of steps many times without renormalizing. Each step is a rotation about a point
+	// away from the origin, so the exact product of every loop is the identity, and any error is accumulated rounding.
+	const std::size_t loopLength = 1000;
+	Vector4d center(0.5, -0.3, 0.2, 0);
+	Vector3d axis = Vector3d(1, 2, 3).normalized();
+	Matrix4d matrixStep = VectorMath::hyperbolicDisplacement(center) * VectorMath::rotation(axis, M_TAU / loopLength) * VectorMath::hyperbolicDisplacement(-center);
+	SpinIsometry spinStep = SpinIsometry::displacement(center) * SpinIsometry::rotation(axis, M_TAU / loopLength) * SpinIsometry::displacement(-center);
+
+	Matrix4d matrixChain = Matrix4d::Identity();
+	SpinIsometry spinChain;
+	for (std::size_t i = 0; i < driftSteps; ++i) {
+		matrixChain *= matrixStep;
+		spinChain *= spinStep;
+	}
+	printf("  After %zu compositions without renormalizing, distance from the exact result:\n", driftSteps);
+	printf("    Matrix4d %g (isometry error %g)\n", (matrixChain - Matrix4d::Identity()).cwiseAbs().maxCoeff(), isometryError(matrixChain));
+	Matrix4d spinMatrix = spinChain.toMatrix4d();
+	printf("    SpinIsometry %g (isometry error %g)\n", (spinMatrix - Matrix4d::Identity()).cwiseAbs().maxCoeff(), isometryError(spinMatrix));
+	spinMatrix = spinChain.renormalized().toMatrix4d();
+	printf("    SpinIsometry, renormalized once at the end %g (isometry error %g)\n", (spinMatrix - Matrix4d::Identity()).cwiseAbs().maxCoeff(), isometryError(spinMatrix));
+}
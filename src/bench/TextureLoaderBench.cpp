@@ -0,0 +1,141 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../JobSystem.h"
+#include "../TextureCache.h"
+#include "../TextureConversion.h"
+#include "../TextureLoader.h"
+
+namespace {
+	bool copyFile(const std::string& from, const std::string& to) {
+		std::FILE* in = std::fopen(from.c_str(), "rb");
+		std::FILE* out = std::fopen(to.c_str(), "wb");
+		bool copied = in && out;
+		char buffer[4096];
+		std::size_t count;
+		while (copied && (count = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+			copied = std::fwrite(buffer, 1, count, out) == count;
+		}
+		if (in) {
+			std::fclose(in);
+		}
+		if (out) {
+			copied = std::fclose(out) == 0 && copied;
+		}
+		return copied;
+	}
+
+	// The average difference of each channel, out of 255
+	double getMeanError(const TextureData& expected, const TextureData& actual) {
+		double sum = 0;
+		for (std::size_t i = 0; i < expected.data.size(); ++i) {
+			sum += std::abs(expected.data[i] - actual.data[i]);
+		}
+		return sum / expected.data.size();
+	}
+
+	// Converts perlin.png and then reads it from the cache. A copy is used so the game's own cache is left alone.
+	void runTextureCacheBenchmarks() {
+		const std::string name = "bench_cache_test.png";
+		if (!copyFile("textures/perlin.png", "textures/" + name)) {
+			printf("  Skipping TextureCache: could not copy perlin.png\n");
+			return;
+		}
+
+		for (TextureFormat format : {TextureFormat::RGB8, TextureFormat::BC1}) {
+			std::string suffix = format == TextureFormat::BC1 ? ", BC1" : ", RGB8";
+			std::string cachePath = TextureCache::getCachePath(name, format);
+			std::remove(cachePath.c_str());
+			CachedTexture texture = TextureCache::load(name, format);
+			std::size_t pixels = static_cast<std::size_t>(texture.levels[0].width) * texture.levels[0].height;
+
+			Benchmark::run("TextureCache::load, convert" + suffix, pixels, [&]() {
+				std::remove(cachePath.c_str());
+				texture = TextureCache::load(name, format);
+			});
+			Benchmark::run("TextureCache::load, from cache" + suffix, pixels, [&]() {
+				texture = TextureCache::load(name, format);
+			});
+			std::remove(cachePath.c_str());
+		}
+		std::remove(("textures/" + name).c_str());
+	}
+}
+
+// Textures are loaded from the textures directory relative to the working directory, as in the game
+void runTextureLoaderBenchmarks() {
+	printf("TextureLoader (time per pixel)\n");
+
+	std::vector<std::string> names;
+	std::size_t totalPixels = 0;
+	for (const char* name : {"tile.png", "perlin.png", "circle.png"}) {
+		TextureData texture(0, 0);
+		try {
+			texture = TextureLoader::loadTexture(name);
+		} catch (const std::runtime_error& e) {
+			printf("  Skipping %s: %s\n", name, e.what());
+			continue;
+		}
+		names.push_back(name);
+		std::size_t pixels = static_cast<std::size_t>(texture.width) * texture.height;
+		totalPixels += pixels;
+
+		Benchmark::run(std::string("loadTexture, RGB8, ") + name, pixels, [&]() {
+			texture = TextureLoader::loadTexture(name);
+		});
+
+		TextureData withAlpha(0, 0);
+		Benchmark::run(std::string("loadTexture, RGBA8, ") + name, pixels, [&]() {
+			withAlpha = TextureLoader::loadTexture(name, 4);
+		});
+	}
+
+	// Decoding every texture at once, as TextureBank does
+	for (unsigned threadCount : {1u, 4u}) {
+		JobSystem jobs(threadCount);
+		std::vector<TextureData> textures(names.size(), TextureData(0, 0));
+		Benchmark::run("every texture, " + std::to_string(threadCount) + (threadCount == 1 ? " thread" : " threads"),
+				totalPixels, [&]() {
+			JobSystem::JobGroup group;
+			for (std::size_t i = 0; i < names.size(); ++i) {
+				jobs.run(group, [&names, &textures, i]() { textures[i] = TextureLoader::loadTexture(names[i]); });
+			}
+			jobs.wait(group);
+		});
+	}
+
+	// Everything TextureCache does to convert a texture, one step at a time
+	try {
+		TextureData perlin = TextureLoader::loadTexture("perlin.png");
+		std::size_t pixels = static_cast<std::size_t>(perlin.width) * perlin.height;
+		std::vector<TextureData> mipChain;
+		Benchmark::run("buildMipChain, perlin.png", pixels, [&]() { mipChain = TextureConversion::buildMipChain(perlin); });
+		std::vector<unsigned char> blocks;
+		Benchmark::run("encodeBc1, perlin.png", pixels, [&]() { blocks = TextureConversion::encodeBc1(perlin); });
+
+		double error = getMeanError(perlin, TextureConversion::decodeBc1(blocks, perlin.width, perlin.height));
+		printf("  BC1 mean error %.3f of 255\n", error);
+		runTextureCacheBenchmarks();
+	} catch (const std::runtime_error& e) {
+		printf("  Skipping conversion: %s\n", e.what());
+	}
+}
@@ -0,0 +1,122 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../VectorMath.h"
+#include "../VectorMathBatch.h"
+
+namespace {
+	const std::size_t batchSize = 10000;
+
+	Matrix4d randomIsometry(std::mt19937& random) {
+		std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+		Vector3d axis(distribution(random), distribution(random), distribution(random));
+		Vector4d displacement(distribution(random), distribution(random), distribution(random), 0);
+		return VectorMath::hyperbolicDisplacement(displacement) * VectorMath::rotation(axis.normalized(), distribution(random) * M_TAU);
+	}
+
+	template<typename F>
+	void runForEachInstructionSet(const std::string& name, F&& function) {
+		VectorMathBatch::InstructionSet best = VectorMathBatch::getInstructionSet();
+		for (auto instructionSet : {VectorMathBatch::InstructionSet::SCALAR, VectorMathBatch::InstructionSet::AVX2, VectorMathBatch::InstructionSet::AVX512}) {
+			if (VectorMathBatch::setInstructionSet(instructionSet) == instructionSet) {
+				Benchmark::run(name + ", " + VectorMathBatch::getName(instructionSet), batchSize, function);
+			}
+		}
+		VectorMathBatch::setInstructionSet(best);
+	}
+
+	template<typename T, int Rows, int Cols>
+	void printDifference(const std::vector<T>& expected, const MatrixBatch<Rows, Cols>& actual) {
+		double maxDifference = 0;
+		for (std::size_t i = 0; i < expected.size(); ++i) {
+			maxDifference = std::max(maxDifference, (expected[i] - actual.get(i)).cwiseAbs().maxCoeff());
+		}
+		printf("  Largest difference from the per-matrix result: %g\n", maxDifference);
+	}
+}
+
+void runVectorMathBatchBenchmarks() {
+	printf("VectorMathBatch (time per matrix or point, %zu per batch)\n", batchSize);
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+	std::vector<Matrix4d> lefts, rights, matrices(batchSize);
+	std::vector<Vector4d> displacements, points(batchSize);
+	std::vector<Vector2d> offsets;
+	Matrix4dBatch leftBatch(batchSize), rightBatch(batchSize), matrixBatch(batchSize);
+	Vector4dBatch displacementBatch(batchSize), pointBatch(batchSize);
+	Vector2dBatch offsetBatch(batchSize);
+
+	for (std::size_t i = 0; i < batchSize; ++i) {
+		lefts.push_back(randomIsometry(random));
+		rights.push_back(randomIsometry(random));
+		displacements.emplace_back(distribution(random), distribution(random), distribution(random), 0);
+		offsets.emplace_back(distribution(random) * 10, distribution(random) * 10);
+		leftBatch.set(i, lefts[i]);
+		rightBatch.set(i, rights[i]);
+		displacementBatch.set(i, displacements[i]);
+		offsetBatch.set(i, offsets[i]);
+	}
+	Matrix4d camera = randomIsometry(random);
+	Vector4d origin(0, 0, 0, 1);
+
+	Benchmark::run("multiply, per matrix", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			matrices[i] = lefts[i] * rights[i];
+		}
+	});
+	runForEachInstructionSet("multiply, batched", [&]() { VectorMathBatch::multiply(leftBatch, rightBatch, matrixBatch); });
+	printDifference(matrices, matrixBatch);
+
+	Benchmark::run("multiply by one matrix, per matrix", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			matrices[i] = camera * rights[i];
+		}
+	});
+	runForEachInstructionSet("multiply by one matrix, batched", [&]() { VectorMathBatch::multiply(camera, rightBatch, matrixBatch); });
+	printDifference(matrices, matrixBatch);
+
+	Benchmark::run("transform one point, per matrix", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			points[i] = lefts[i] * origin;
+		}
+	});
+	runForEachInstructionSet("transform one point, batched", [&]() { VectorMathBatch::transform(leftBatch, origin, pointBatch); });
+	printDifference(points, pointBatch);
+
+	Benchmark::run("hyperbolicDisplacement, per matrix", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			matrices[i] = VectorMath::hyperbolicDisplacement(displacements[i]);
+		}
+	});
+	runForEachInstructionSet("hyperbolicDisplacement, batched", [&]() { VectorMathBatch::hyperbolicDisplacement(displacementBatch, matrixBatch); });
+	printDifference(matrices, matrixBatch);
+
+	Benchmark::run("horoRotation, per matrix", batchSize, [&]() {
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			matrices[i] = VectorMath::horoRotation(offsets[i](0), offsets[i](1));
+		}
+	});
+	runForEachInstructionSet("horoRotation, batched", [&]() { VectorMathBatch::horoRotation(offsetBatch, matrixBatch); });
+	printDifference(matrices, matrixBatch);
+}
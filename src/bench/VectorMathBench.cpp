@@ -0,0 +1,73 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../VectorMath.h"
+
+namespace {
+	const std::size_t batchSize = 10000;
+
+	// Applies the function to every input, keeping the results so the calls cannot be optimized away
+	template<typename Input, typename Output, typename F>
+	void runEach(const std::string& name, const std::vector<Input>& inputs, std::vector<Output>& outputs, F&& function) {
+		outputs.resize(inputs.size());
+		Benchmark::run(name, inputs.size(), [&]() {
+			for (std::size_t i = 0; i < inputs.size(); ++i) {
+				outputs[i] = function(inputs[i]);
+			}
+		});
+	}
+}
+
+void runVectorMathBenchmarks() {
+	printf("VectorMath (time per call, %zu per batch)\n", batchSize);
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+	std::vector<Vector4d> displacements, points, normals;
+	std::vector<Vector3d> axes;
+	std::vector<Matrix4d> isometries, perturbed;
+	for (std::size_t i = 0; i < batchSize; ++i) {
+		displacements.emplace_back(distribution(random), distribution(random), distribution(random), 0);
+		axes.push_back(Vector3d(distribution(random), distribution(random), distribution(random)).normalized());
+		points.push_back(VectorMath::hyperbolicDisplacement(displacements.back()).col(3));
+		Vector4d normal(distribution(random), distribution(random), distribution(random), distribution(random) * 0.5);
+		normals.push_back(normal / sqrt(VectorMath::hyperbolicSqrNorm(normal)));
+		isometries.push_back(VectorMath::hyperbolicDisplacement(displacements.back()) * VectorMath::rotation(axes.back(), distribution(random) * M_TAU));
+		perturbed.push_back(isometries.back() + Matrix4d::Random() * 1e-4);
+	}
+
+	std::vector<Matrix4d> matrices;
+	std::vector<Vector4d> vectors;
+	std::vector<double> scalars;
+
+	runEach("hyperbolicDisplacement", displacements, matrices, [](const Vector4d& v) { return VectorMath::hyperbolicDisplacement(v); });
+	runEach("hyperbolicTranslation", points, matrices, [](const Vector4d& v) { return VectorMath::hyperbolicTranslation(v); });
+	runEach("rotation", axes, matrices, [](const Vector3d& axis) { return VectorMath::rotation(axis, 0.5); });
+	runEach("hyperbolicReflection", normals, matrices, [](const Vector4d& v) { return VectorMath::hyperbolicReflection(v); });
+	runEach("hyperbolicTranspose", isometries, matrices, [](const Matrix4d& m) { return VectorMath::hyperbolicTranspose(m); });
+	runEach("hyperbolicSqrNorm", points, scalars, [](const Vector4d& v) { return VectorMath::hyperbolicSqrNorm(v); });
+	runEach("hyperbolicNormal", points, vectors, [&](const Vector4d& v) { return VectorMath::hyperbolicNormal(v, points[0], points[1]); });
+	runEach("hyperbolicQrUnitary", perturbed, matrices, [](const Matrix4d& m) { return VectorMath::hyperbolicQrUnitary(m); });
+	runEach("HyperbolicGeometry::drift", perturbed, scalars, [](const Matrix4d& m) { return HyperbolicGeometry::drift(m); });
+	runEach("HyperbolicGeometry::correctDrift", perturbed, matrices, [](const Matrix4d& m) { return HyperbolicGeometry::correctDrift(m); });
+	runEach("Matrix4d product", isometries, matrices, [&](const Matrix4d& m) { return Matrix4d(m * isometries[0]); });
+	runEach("Matrix4d transform of a point", isometries, vectors, [&](const Matrix4d& m) { return Vector4d(m * points[0]); });
+}
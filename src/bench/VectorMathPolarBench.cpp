@@ -0,0 +1,98 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <unsupported/Eigen/MatrixFunctions>
+#include <Eigen/SVD>
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "../VectorMath.h"
+
+namespace {
+	const std::size_t batchSize = 1000;
+
+	// The implementations svdUnitary replaced, kept as the reference for accuracy
+	Matrix4d referenceHyperbolicSvdUnitary(const Matrix4d& matrix) {
+		return matrix * (VectorMath::hyperbolicTranspose(matrix) * matrix).sqrt().inverse();
+	}
+
+	Matrix4d referenceSphericalSvdUnitary(const Matrix4d& matrix) {
+		Eigen::JacobiSVD<Matrix4d> svd(matrix, Eigen::ComputeFullU | Eigen::ComputeFullV);
+		return svd.matrixU() * svd.matrixV().adjoint();
+	}
+
+	template<typename Space>
+	Matrix4d randomIsometry(std::mt19937& random) {
+		std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+		Vector3d axis(distribution(random), distribution(random), distribution(random));
+		Vector4d displacement(distribution(random), distribution(random), distribution(random), 0);
+		return Space::displacement(displacement) * VectorMath::rotation(axis.normalized(), distribution(random) * M_TAU);
+	}
+
+	// Also prints how far the results are from the reference and from being isometries
+	template<typename Space, typename F>
+	void compare(const std::string& name, const std::vector<Matrix4d>& inputs, F&& reference) {
+		std::vector<Matrix4d> results(inputs.size());
+
+		Benchmark::run(name + ", reference", inputs.size(), [&]() {
+			for (std::size_t i = 0; i < inputs.size(); ++i) {
+				results[i] = reference(inputs[i]);
+			}
+		});
+		std::vector<Matrix4d> expected = results;
+
+		Benchmark::run(name + ", svdUnitary", inputs.size(), [&]() {
+			for (std::size_t i = 0; i < inputs.size(); ++i) {
+				results[i] = Space::svdUnitary(inputs[i]);
+			}
+		});
+
+		double maxDifference = 0, maxIsometryError = 0;
+		for (std::size_t i = 0; i < inputs.size(); ++i) {
+			maxDifference = std::max(maxDifference, (results[i] - expected[i]).cwiseAbs().maxCoeff());
+			maxIsometryError = std::max(maxIsometryError, (Space::transpose(results[i]) * results[i] - Matrix4d::Identity()).cwiseAbs().maxCoeff());
+		}
+
+		printf("  Largest difference from the reference: %g, largest isometry error: %g\n", maxDifference, maxIsometryError);
+	}
+
+	template<typename Space, typename F>
+	void runForGeometry(const std::string& geometryName, F&& reference) {
+		std::mt19937 random(1);
+		std::normal_distribution<double> noise(0.0, 1e-3);
+		std::vector<Matrix4d> drifted, goingHome;
+
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			// Accumulated rounding error, as renormalization sees it
+			drifted.push_back(randomIsometry<Space>(random) + Matrix4d::NullaryExpr([&]() { return noise(random); }));
+
+			// GhostCamera's go-home step at 60 frames per second
+			goingHome.push_back(randomIsometry<Space>(random) + Matrix4d::Identity() / 60.0);
+		}
+
+		compare<Space>(geometryName + " drifted isometry", drifted, reference);
+		compare<Space>(geometryName + " go-home step", goingHome, reference);
+	}
+}
+
+void runVectorMathPolarBenchmarks() {
+	printf("VectorMath polar decomposition (time per matrix, %zu matrices)\n", batchSize);
+
+	runForGeometry<HyperbolicGeometry>("hyperbolic", referenceHyperbolicSvdUnitary);
+	runForGeometry<SphericalGeometry>("spherical", referenceSphericalSvdUnitary);
+}
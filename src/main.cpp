@@ -21,16 +21,17 @@
 
 #include "ContextWrapper.h"
 #include "WindowWrapper.h"
+#include "LaunchOptions.h"
 
-void entry(void) {
+void entry(const LaunchOptions& options) {
 	ContextWrapper outer;
-	WindowWrapper windowWrapper(outer);
+	WindowWrapper windowWrapper(outer, options);
 	windowWrapper.renderLoop();
 }
 
-int main(void) {
+int main(int argc, char* argv[]) {
 	try {
-		entry();
+		entry(LaunchOptions(argc, argv));
 		return EXIT_SUCCESS;
 	} catch (const std::runtime_error &e) {
 		fprintf(stderr, "Fatal error: %s\n", e.what());
@@ -0,0 +1,63 @@
+#version 150
+
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+// Variants of this shader are built by ShaderProgramKey, which inserts its defines directly after the version directive.
+
+uniform sampler2D texture_sampler;
+in vec4 pos;
+in vec4 normal;
+in vec2 texCoord;
+in vec4 pos_global;
+flat in vec4 light;
+out vec4 fragColor;
+
+#if defined(GEOMETRY_SPHERICAL)
+const float curvature = 1.0;
+#else
+const float curvature = -1.0;
+#endif
+
+// Inner product of the ambient space, whose sign on the w component is determined by the curvature
+float geomdot(vec4 v1, vec4 v2)
+{
+	return dot(v1.xyz, v2.xyz) + curvature * v1.w * v2.w;
+}
+
+void main()
+{
+	float dot_pos_pos = geomdot(pos, pos);
+
+#if defined(LIGHTING_POINT)
+	float dot_pos_light = geomdot(pos, light);
+	float dot_pos_normal = geomdot(pos, normal);
+	float numerator = geomdot(light, normal) * dot_pos_pos - dot_pos_light * dot_pos_normal;
+	float denominator_light = geomdot(light, light) * dot_pos_pos - dot_pos_light * dot_pos_light;
+	float denominator_normal = geomdot(normal, normal) * dot_pos_pos - dot_pos_normal * dot_pos_normal;
+
+	float directness = max(0.0, curvature * (gl_FrontFacing ? 1.0 : -1.0) * numerator / sqrt(denominator_light * denominator_normal));
+#else
+	float directness = 1.0;
+#endif
+
+#if defined(GEOMETRY_HYPERBOLIC)
+	float depth_factor = 1.0 / sqrt(max(1e-3, -dot_pos_pos));
+	gl_FragDepth = -pos_global.z / ((pos_global.w * depth_factor) + 1.0) * depth_factor;
+#endif
+
+	fragColor = vec4(texture(texture_sampler, texCoord).rgb * directness, 1.0);
+}
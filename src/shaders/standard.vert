@@ -0,0 +1,144 @@
+#version 150
+
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+// Variants of this shader are built by ShaderProgramKey, which inserts its defines directly after the version directive.
+
+#if defined(TRANSFORM_DOUBLE_FLOAT)
+// For fma and the precise qualifier, which the double-float transform needs to be exact
+#extension GL_ARB_gpu_shader5 : enable
+#endif
+
+layout(std140) uniform FrameData {
+	mat4 projection;
+};
+
+#if defined(TRANSFORM_STREAMED)
+layout(std140) uniform DrawData {
+	mat4 modelViews[DRAWS_PER_BLOCK];
+};
+uniform int drawIndex;
+#else
+uniform mat4 modelView;
+#endif
+
+#if defined(TRANSFORM_DOUBLE_FLOAT)
+// The rounding error of modelView, so that their sum is the model-view matrix to about twice float precision
+uniform mat4 modelViewLo;
+
+// Error-free transformations: Each returns a result rounded to float along with the exact rounding error. This only
+// holds if every operation is rounded exactly as written: Reassociating them or contracting a multiply and an add into a
+// fused multiply-add would break Dekker's split and the error terms.
+#if defined(GL_ARB_gpu_shader5)
+// Available on all GL 4 hardware. precise forbids both reassociation and contraction, and fma gives a product's exact
+// rounding error directly, so no split is needed.
+vec2 twoSum(float a, float b)
+{
+	precise float sum = a + b;
+	precise float bRounded = sum - a;
+	precise float error = (a - (sum - bRounded)) + (b - bRounded);
+	return vec2(sum, error);
+}
+
+vec2 twoProduct(float a, float b)
+{
+	precise float product = a * b;
+	precise float error = fma(a, b, -product);
+	return vec2(product, error);
+}
+#else
+// Without precise, this relies on the driver neither reassociating nor contracting float arithmetic. The splitter is
+// 4097 and comes from a uniform so that it cannot be constant-folded into the arithmetic around it. Nothing here stops
+// contraction, but the hardware with fused multiply-adds that drivers contract into supports GL_ARB_gpu_shader5.
+uniform float splitter;
+
+vec2 twoSum(float a, float b)
+{
+	float sum = a + b;
+	float bRounded = sum - a;
+	return vec2(sum, (a - (sum - bRounded)) + (b - bRounded));
+}
+
+// Dekker's split of a float into two halves whose products with each other are exact
+vec2 split(float a)
+{
+	float scaled = splitter * a;
+	float hi = scaled - (scaled - a);
+	return vec2(hi, a - hi);
+}
+
+vec2 twoProduct(float a, float b)
+{
+	float product = a * b;
+	vec2 aSplit = split(a);
+	vec2 bSplit = split(b);
+	return vec2(product, ((aSplit.x * bSplit.x - product) + aSplit.x * bSplit.y + aSplit.y * bSplit.x) + aSplit.y * bSplit.y);
+}
+#endif
+
+// (hi + lo) * v, keeping the cancellation between large entries of hi from costing any precision
+vec4 preciseTransform(mat4 hi, mat4 lo, vec4 v)
+{
+	vec4 result;
+	for (int row = 0; row < 4; ++row) {
+		vec2 sum = vec2(0.0);
+		for (int col = 0; col < 4; ++col) {
+			vec2 product = twoProduct(hi[col][row], v[col]);
+			vec2 partial = twoSum(sum.x, product.x);
+			sum = vec2(partial.x, partial.y + sum.y + product.y + lo[col][row] * v[col]);
+		}
+		result[row] = sum.x + sum.y;
+	}
+	return result;
+}
+#endif
+
+in vec4 vPos;
+in vec4 vNormal;
+in vec2 vTexCoord;
+out vec4 pos;
+out vec4 normal;
+out vec2 texCoord;
+out vec4 pos_global;
+flat out vec4 light;
+
+#if defined(GEOMETRY_SPHERICAL)
+const float curvature = 1.0;
+#else
+const float curvature = -1.0;
+#endif
+
+void main()
+{
+#if defined(TRANSFORM_STREAMED)
+	mat4 modelView = modelViews[drawIndex];
+#endif
+
+#if defined(TRANSFORM_DOUBLE_FLOAT)
+	pos_global = preciseTransform(modelView, modelViewLo, vPos);
+#else
+	pos_global = modelView * vPos;
+#endif
+	gl_Position = projection * pos_global;
+	pos = vPos;
+	normal = vNormal;
+	texCoord = vTexCoord;
+
+	// The light is at the camera, so in model coordinates, it is at the inverse of the model-view applied to the origin.
+	// As the model-view is an isometry, that is its bottom row with the metric applied.
+	light = vec4(curvature * vec3(modelView[0][3], modelView[1][3], modelView[2][3]), modelView[3][3]);
+}
@@ -0,0 +1,134 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Tests.h"
+#include "../InputBindings.h"
+#include "../InputCode.h"
+#include "../InputRecording.h"
+#include "../InputState.h"
+#include "../UserInput.h"
+
+namespace {
+	RecordedInputStep makeStep(std::vector<int> keysDown, std::vector<int> keysPressed) {
+		RecordedInputStep step;
+		step.dt = 1.0 / 60.0;
+		step.keysDown = keysDown;
+		step.keysPressed = keysPressed;
+		return step;
+	}
+
+	bool parseFails(const std::string& text) {
+		try {
+			InputBindings::parse(text, "test");
+			return false;
+		} catch (const std::runtime_error&) {
+			return true;
+		}
+	}
+
+	// Every action's default binding, written out as a binding file
+	std::string writeDefaults() {
+		InputBindings defaults;
+		std::string text = "# The default bindings\n";
+		for (int action = 0; action < InputBindings::actionCount; ++action) {
+			text += std::string(InputBindings::getActionName(static_cast<InputAction>(action))) + " =";
+			for (int bit : defaults.getBits(static_cast<InputAction>(action))) {
+				if (bit != InputState::nullBit) {
+					text += " " + InputBindings::getInputName(bit) + ",";
+				}
+			}
+			text.back() = '\n';
+		}
+		return text;
+	}
+}
+
+bool runInputTests() {
+	bool passed = true;
+
+	// Some of the default bindings are held
+	InputBindings bindings;
+	InputState state;
+	makeStep({InputCode::KEY_A, InputCode::KEY_W}, {InputCode::KEY_W}).applyTo(state);
+	UserInput userInput(state, bindings, Vector2d::Zero());
+	std::size_t held = 0;
+	for (int action = 0; action < InputBindings::actionCount; ++action) {
+		held += userInput.isPressed(static_cast<InputAction>(action)) + userInput.pressedThisStep(static_cast<InputAction>(action));
+	}
+	if (held == 0) {
+		printf("  FAILED: no held input was reported\n");
+		passed = false;
+	}
+
+	// Moving up is bound to both W and the up arrow. Holding W across three steps, with the up arrow held for the last
+	// two, and letting go of both at once, with an unbound action that must never report anything.
+	InputBindings custom = InputBindings::parse("move_up = KEY_W, KEY_UP  # Either one\ngo_home =\n", "custom");
+	InputState replayed;
+	UserInput replayedInput(replayed, custom, Vector2d::Zero());
+	std::vector<RecordedInputStep> steps {
+		makeStep({InputCode::KEY_W}, {InputCode::KEY_W}),
+		makeStep({InputCode::KEY_W, InputCode::KEY_UP}, {InputCode::KEY_UP}),
+		makeStep({InputCode::KEY_UP}, {}),
+		makeStep({}, {}),
+	};
+	const bool expected[4][3] = {{true, true, false}, {true, true, false}, {true, false, false}, {false, false, true}};
+	for (std::size_t i = 0; i < steps.size(); ++i) {
+		steps[i].applyTo(replayed);
+		InputAction up = InputAction::MOVE_UP;
+		bool actual[3] = {replayedInput.isPressed(up), replayedInput.pressedThisStep(up), replayedInput.releasedThisStep(up)};
+		if (actual[0] != expected[i][0] || actual[1] != expected[i][1] || actual[2] != expected[i][2]
+				|| replayedInput.isPressed(InputAction::GO_HOME) || replayedInput.pressedThisStep(InputAction::GO_HOME)) {
+			printf("  FAILED: step %zu reported the wrong state\n", i);
+			passed = false;
+		}
+
+		// Recording the state must give back the step it came from
+		RecordedInputStep recorded = RecordedInputStep::fromState(steps[i].dt, steps[i].mouseLook, replayed);
+		if (recorded.keysDown != steps[i].keysDown || recorded.keysPressed != steps[i].keysPressed) {
+			printf("  FAILED: step %zu was not recorded as it was replayed\n", i);
+			passed = false;
+		}
+	}
+
+	// The defaults survive being written out and parsed again, and have no conflicts of their own
+	InputBindings reparsed = InputBindings::parse(writeDefaults(), "defaults");
+	for (int action = 0; action < InputBindings::actionCount; ++action) {
+		if (reparsed.getBits(static_cast<InputAction>(action)) != bindings.getBits(static_cast<InputAction>(action))) {
+			printf("  FAILED: %s did not survive parsing\n", InputBindings::getActionName(static_cast<InputAction>(action)));
+			passed = false;
+		}
+	}
+	if (!bindings.findConflicts().empty()) {
+		printf("  FAILED: the default bindings conflict\n");
+		passed = false;
+	}
+
+	// W is already bound to moving up, and the rest are malformed
+	const char* badTexts[] = {"spawn_tree = KEY_W", "jump = KEY_SPACE", "move_up = KEY_NOPE", "move_up KEY_W",
+		"move_up = KEY_W\nmove_up = KEY_UP", "move_up = KEY_UP, KEY_I, KEY_J, KEY_K, KEY_L"};
+	for (const char* badText : badTexts) {
+		if (!parseFails(badText)) {
+			printf("  FAILED: \"%s\" was accepted\n", badText);
+			passed = false;
+		}
+	}
+	return passed;
+}
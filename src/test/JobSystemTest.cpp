@@ -0,0 +1,83 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include "Tests.h"
+#include "../JobSystem.h"
+
+namespace {
+	const int forkDepth = 13; // 8192 leaves
+
+	// Each job forks two more until the depth runs out, as the tree builder does
+	void fork(JobSystem& jobs, JobSystem::JobGroup& group, std::atomic<std::size_t>& leaves, int depth) {
+		if (depth == 0) {
+			leaves.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		for (int i = 0; i < 2; ++i) {
+			jobs.run(group, [&jobs, &group, &leaves, depth]() { fork(jobs, group, leaves, depth - 1); });
+		}
+	}
+
+	bool throwsRuntimeError(JobSystem& jobs, JobSystem::JobGroup& group) {
+		try {
+			jobs.wait(group);
+			return false;
+		} catch (const std::runtime_error&) {
+			return true;
+		}
+	}
+}
+
+bool runJobSystemTests() {
+	bool passed = true;
+	for (unsigned threadCount : {1u, 4u}) {
+		JobSystem jobs(threadCount);
+
+		std::atomic<std::size_t> leaves(0);
+		JobSystem::JobGroup forked;
+		jobs.run(forked, [&]() { fork(jobs, forked, leaves, forkDepth); });
+		jobs.wait(forked);
+		if (leaves != (std::size_t(1) << forkDepth)) {
+			printf("  FAILED: %zu of %zu leaves ran on %u threads\n", leaves.load(), std::size_t(1) << forkDepth, threadCount);
+			passed = false;
+		}
+
+		// An exception thrown in a job is rethrown by wait, and the jobs that depend on it do not run but rethrow it too,
+		// whether they were added before or after it was thrown
+		JobSystem::JobGroup failed, dependent, lateDependent;
+		bool dependentsRan = false;
+		jobs.run(failed, []() { throw std::runtime_error("Thrown in a job"); });
+		jobs.runAfter(failed, dependent, [&dependentsRan]() { dependentsRan = true; });
+		if (!throwsRuntimeError(jobs, dependent)) {
+			printf("  FAILED: a continuation of a job that threw did not rethrow on %u threads\n", threadCount);
+			passed = false;
+		}
+		jobs.runAfter(failed, lateDependent, [&dependentsRan]() { dependentsRan = true; });
+		if (!throwsRuntimeError(jobs, lateDependent) || !throwsRuntimeError(jobs, failed)) {
+			printf("  FAILED: exception was not rethrown by wait on %u threads\n", threadCount);
+			passed = false;
+		}
+		if (dependentsRan) {
+			printf("  FAILED: a continuation of a job that threw ran on %u threads\n", threadCount);
+			passed = false;
+		}
+	}
+	return passed;
+}
@@ -0,0 +1,46 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include "Tests.h"
+#include "../MeshGenerators.h"
+
+namespace {
+	bool isIdentical(const Mesh& mesh, const Mesh& expected) {
+		return mesh.vertices.size() == expected.vertices.size() && mesh.elements == expected.elements
+			&& std::memcmp(mesh.vertices.data(), expected.vertices.data(), mesh.vertices.size() * sizeof(Vertex)) == 0;
+	}
+}
+
+bool runMeshTests() {
+	bool passed = true;
+
+	// At least one worker thread is started even on a single core, so that the check covers jobs running out of order
+	JobSystem jobs(std::max(std::thread::hardware_concurrency(), 2u));
+	if (!isIdentical(makeHorosphere(jobs), makeHorosphere())) {
+		printf("  FAILED: differs from the serial makeHorosphere\n");
+		passed = false;
+	}
+	if (!isIdentical(makeTree(jobs), makeTree())) {
+		printf("  FAILED: differs from the serial makeTree\n");
+		passed = false;
+	}
+	return passed;
+}
@@ -0,0 +1,219 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "Tests.h"
+#include "../bench/AllocationCounter.h"
+#include "../Anchor.h"
+#include "../RenderNodeStore.h"
+#include "../DrawList.h"
+#include "../SpawnPatterns.h"
+#include "../RenderSnapshot.h"
+#include "../VectorMath.h"
+
+namespace {
+	const std::size_t nodeCount = 10000;
+	const double tickInterval = 1.0 / 60.0;
+
+	// The entries of a distant transform are large, so its drift is measured relative to the square of its largest
+	// entry, which is the most rounding could explain
+	template<typename Space>
+	double getRelativeDrift(const Matrix4d& transform) {
+		double scale = transform.cwiseAbs().maxCoeff();
+		return Space::drift(transform) / (scale * scale);
+	}
+
+	void makeSnapshot(const RenderNodeStore& store, std::uint64_t tick, const Matrix4d& view, RenderSnapshot& snapshot) {
+		snapshot.nodes.clear();
+		snapshot.motions.clear();
+		snapshot.tick = tick;
+		snapshot.time = tick * tickInterval;
+		snapshot.view = view;
+		snapshot.hasCamera = true;
+		store.addToSnapshot(snapshot);
+	}
+
+	// Snapshots three ticks apart, interpolated at the tick in between, must match the snapshot taken at that tick,
+	// for both moving nodes and the view
+	template<typename Space>
+	bool interpolatesExactly(const char* geometryName) {
+		AnchorTree anchors;
+		RenderNodeStore store;
+		std::mt19937 random(1);
+		std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+		for (std::size_t i = 0; i < 100; ++i) {
+			Vector4d position(distribution(random), distribution(random), distribution(random), 0);
+			SlotHandle handle = store.add(anchors.getRoot(), Space::displacement(position), ModelHandle::PRISM, TextureHandle::BLANK);
+			Motion motion;
+			motion.velocity = Vector3d(distribution(random), distribution(random), distribution(random));
+			motion.angularVelocity = Vector3d(distribution(random), distribution(random), distribution(random)) * 3.0;
+			store.setMotion(handle, motion);
+		}
+
+		Matrix4d fromView = Space::displacement(Vector4d(0.1, 0.2, 0.3, 0)) * VectorMath::rotation(Vector3d(0, 0, 1), 0.4);
+		Matrix4d toView = Space::displacement(Vector4d(-0.2, 0.5, 0.1, 0)) * VectorMath::rotation(Vector3d(1, 0, 0), 0.3);
+		RenderSnapshot from, between, to;
+		store.integrate<Space>(tickInterval);
+		makeSnapshot(store, 1, fromView, from);
+		store.integrate<Space>(tickInterval);
+		makeSnapshot(store, 2, fromView, between);
+		store.integrate<Space>(tickInterval);
+		store.integrate<Space>(tickInterval);
+		makeSnapshot(store, 4, toView, to);
+
+		SnapshotInterpolator<Space> interpolator;
+		interpolator.add(from);
+		interpolator.add(to);
+		double nodeError = 0;
+		const RenderSnapshot& interpolated = interpolator.interpolate(between.time);
+		for (std::size_t i = 0; i < between.nodes.size(); ++i) {
+			nodeError = std::max(nodeError, (interpolated.nodes[i].transform - between.nodes[i].transform).cwiseAbs().maxCoeff());
+		}
+		double viewError = (interpolator.interpolate(to.time).view - toView).cwiseAbs().maxCoeff();
+		double viewDrift = Space::drift(interpolator.interpolate((between.time + to.time) / 2).view);
+
+		if (nodeError > 1e-12 || viewError > 1e-12 || viewDrift > 1e-12) {
+			printf("  FAILED: %s interpolation is %g from a moving node, %g from the view, and %g from an isometry\n",
+				geometryName, nodeError, viewError, viewDrift);
+			return false;
+		}
+		return true;
+	}
+}
+
+bool runSceneTests() {
+	bool passed = true;
+
+	AnchorTree anchors;
+	const Anchor& root = anchors.getRoot();
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> distribution(-3.0, 3.0);
+	std::vector<Matrix4d> transforms;
+	for (std::size_t i = 0; i < nodeCount; ++i) {
+		transforms.push_back(VectorMath::hyperbolicDisplacement(Vector4d(distribution(random), distribution(random), distribution(random), 0)));
+	}
+
+	// Despawning a batch and spawning it again reuses the despawned nodes' slots and space
+	RenderNodeStore store;
+	std::vector<SlotHandle> handles;
+	store.addAll(root, transforms, ModelHandle::DODECAHEDRON, TextureHandle::PERLIN, handles);
+	store.removeAll(handles);
+	handles.clear();
+	std::size_t allocationsBefore = AllocationCounter::getAllocations();
+	store.addAll(root, transforms, ModelHandle::DODECAHEDRON, TextureHandle::PERLIN, handles);
+	if (AllocationCounter::getAllocations() != allocationsBefore) {
+		printf("  FAILED: spawning a despawned batch again allocated\n");
+		passed = false;
+	}
+
+	// Drift is only corrected every few steps, so it must still stay within what rounding explains
+	for (std::size_t i = 0; i < nodeCount; ++i) {
+		Motion motion;
+		motion.velocity = Vector3d(distribution(random), distribution(random), distribution(random)) * 0.1;
+		motion.angularVelocity = Vector3d(distribution(random), distribution(random), distribution(random));
+		store.setMotion(handles[i], motion);
+	}
+	for (int tick = 0; tick < 100; ++tick) {
+		store.integrate<HyperbolicGeometry>(tickInterval);
+	}
+	RenderSnapshot snapshot;
+	makeSnapshot(store, 100, VectorMath::hyperbolicDisplacement(Vector4d(0, 0, 1, 0)), snapshot);
+	double integratedDrift = 0;
+	for (const RenderSnapshotNode& node : snapshot.nodes) {
+		integratedDrift = std::max(integratedDrift, getRelativeDrift<HyperbolicGeometry>(node.transform));
+	}
+	if (integratedDrift > 1e-12) {
+		printf("  FAILED: integrated nodes drifted %g from isometries\n", integratedDrift);
+		passed = false;
+	}
+
+	// No node whose center is in view may be culled. Every node has the same model and texture, so the draw list keeps
+	// the snapshot's order.
+	DrawList drawList;
+	drawList.build<HyperbolicGeometry>(snapshot, 4.0 / 3.0, 1.0);
+	std::size_t wronglyCulled = 0;
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < snapshot.nodes.size(); ++i) {
+		Vector4d center = snapshot.view * snapshot.nodes[i].transform.col(3);
+		bool inside = center.z() < 0 && std::abs(center.x()) <= -center.z() * 2.0 / 3.0 && std::abs(center.y()) <= -center.z() / 2.0;
+		bool culled = kept >= drawList.getIndices().size() || drawList.getIndices()[kept] != i;
+		if (!culled) {
+			++kept;
+		}
+		if (inside && culled) {
+			++wronglyCulled;
+		}
+	}
+	if (wronglyCulled != 0) {
+		printf("  FAILED: %zu nodes in view were culled\n", wronglyCulled);
+		passed = false;
+	}
+
+	// Removes every other node and adds it back, so half of the adds reuse a free slot. A removed node's handle must not
+	// refer to the node that reuses its slot, and every live handle must still find its own node after the others have
+	// been moved around.
+	for (std::size_t i = 0; i < nodeCount; i += 2) {
+		store.remove(handles[i]);
+	}
+	for (std::size_t i = 0; i < nodeCount; i += 2) {
+		handles[i] = store.add(root, transforms[i], ModelHandle::PRISM, TextureHandle::BLANK);
+	}
+	SlotHandle removed = handles[0];
+	store.remove(removed);
+	handles[0] = store.add(root, transforms[0], ModelHandle::TREE, TextureHandle::BLANK);
+	if (store.contains(removed) || !store.contains(handles[0]) || removed.index != handles[0].index) {
+		printf("  FAILED: a removed handle still refers to a node\n");
+		passed = false;
+	}
+	makeSnapshot(store, 100, Matrix4d::Identity(), snapshot);
+	std::unordered_map<std::uint64_t, const RenderSnapshotNode*> nodesById;
+	for (const RenderSnapshotNode& node : snapshot.nodes) {
+		nodesById[node.id] = &node;
+	}
+	std::size_t misplaced = 0;
+	for (std::size_t i = 0; i < nodeCount; i += 2) {
+		auto it = nodesById.find(handles[i].getId());
+		if (it == nodesById.end() || it->second->transform != transforms[i]) {
+			++misplaced;
+		}
+	}
+	if (store.getSize() != nodeCount || misplaced != 0) {
+		printf("  FAILED: %zu of %zu re-added nodes were lost or moved\n", misplaced, nodeCount / 2);
+		passed = false;
+	}
+
+	// Every pattern must be made of isometries, or the instances would be distorted
+	double drift = 0;
+	for (const auto& pattern : {SpawnPatterns::randomBall(1000, 5.0, random), SpawnPatterns::geodesicGrid(5, 2.5), SpawnPatterns::tessellation(18)}) {
+		for (const Matrix4d& transform : pattern) {
+			drift = std::max(drift, getRelativeDrift<HyperbolicGeometry>(transform));
+		}
+	}
+	if (drift > 1e-12) {
+		printf("  FAILED: a spawn pattern drifted %g from isometries\n", drift);
+		passed = false;
+	}
+
+	passed = interpolatesExactly<HyperbolicGeometry>("hyperbolic") && passed;
+	passed = interpolatesExactly<SphericalGeometry>("spherical") && passed;
+	return passed;
+}
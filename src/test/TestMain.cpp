@@ -0,0 +1,72 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Tests.h"
+
+namespace {
+	class TestGroup {
+	public:
+		const char* name;
+		bool (*run)();
+	};
+
+	const TestGroup groups[] = {
+		{"vector_math_polar", runVectorMathPolarTests},
+		{"input", runInputTests},
+		{"scene", runSceneTests},
+		{"job_system", runJobSystemTests},
+		{"mesh", runMeshTests},
+		{"texture_loader", runTextureLoaderTests},
+	};
+
+	const TestGroup* findGroup(const char* name) {
+		for (const TestGroup& group : groups) {
+			if (std::strcmp(group.name, name) == 0) {
+				return &group;
+			}
+		}
+		return nullptr;
+	}
+}
+
+// Usage: hyperworld_test [group...]
+// Runs the named groups, or every group if none are named, and exits with failure if any check failed. CTest runs each
+// group as its own test.
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		if (!findGroup(argv[i])) {
+			std::fprintf(stderr, "Unknown test group %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	bool passed = true;
+	for (const TestGroup& group : groups) {
+		bool selected = argc == 1;
+		for (int i = 1; i < argc; ++i) {
+			selected = selected || findGroup(argv[i]) == &group;
+		}
+		if (selected) {
+			std::printf("%s\n", group.name);
+			passed = group.run() && passed;
+		}
+	}
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
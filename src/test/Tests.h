@@ -0,0 +1,44 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+
+#pragma once
+
+// Each test group runs without a window or GL context, prints a line starting with FAILED for every check that does not
+// hold, and returns whether all of them held
+
+// Replayed steps report the right held, pressed and released state and are recorded as they were, the default
+// bindings have no conflicts and survive being written out and parsed, and malformed binding files are rejected
+bool runInputTests();
+
+// Render node handles keep referring to their own nodes, respawning a despawned batch allocates nothing, integrated
+// nodes and spawn patterns stay isometries, no node in view is culled, and snapshots interpolate onto the simulation's
+// transforms
+bool runSceneTests();
+
+// Every job runs, exceptions are passed on to wait, and continuations of a group that threw are cancelled
+bool runJobSystemTests();
+
+// The meshes built with the job system match the serial ones
+bool runMeshTests();
+
+// Needs the textures directory in the working directory, and skips any texture it cannot find. A texture decodes to the
+// same colors as RGB8 and RGBA8, a missing texture throws, BC1 stays close to the original, and the texture cache is
+// used when it should be and not after its PNG changes.
+bool runTextureLoaderTests();
+
+// svdUnitary agrees with the implementations it replaced
+bool runVectorMathPolarTests();
@@ -0,0 +1,150 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Tests.h"
+#include "../TextureCache.h"
+#include "../TextureConversion.h"
+#include "../TextureLoader.h"
+
+namespace {
+	bool copyFile(const std::string& from, const std::string& to) {
+		std::FILE* in = std::fopen(from.c_str(), "rb");
+		std::FILE* out = std::fopen(to.c_str(), "wb");
+		bool copied = in && out;
+		char buffer[4096];
+		std::size_t count;
+		while (copied && (count = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+			copied = std::fwrite(buffer, 1, count, out) == count;
+		}
+		if (in) {
+			std::fclose(in);
+		}
+		if (out) {
+			copied = std::fclose(out) == 0 && copied;
+		}
+		return copied;
+	}
+
+	// The average difference of each channel, out of 255
+	double getMeanError(const TextureData& expected, const TextureData& actual) {
+		double sum = 0;
+		for (std::size_t i = 0; i < expected.data.size(); ++i) {
+			sum += std::abs(expected.data[i] - actual.data[i]);
+		}
+		return sum / expected.data.size();
+	}
+
+	// Converts perlin.png, reads it back from the cache, and checks that replacing the PNG invalidates the cache. A copy
+	// is used so the game's own cache is left alone.
+	bool runTextureCacheTests() {
+		bool passed = true;
+		const std::string name = "test_cache_test.png";
+		if (!copyFile("textures/perlin.png", "textures/" + name)) {
+			printf("  Skipping TextureCache: could not copy perlin.png\n");
+			return true;
+		}
+
+		for (TextureFormat format : {TextureFormat::RGB8, TextureFormat::BC1}) {
+			std::string suffix = format == TextureFormat::BC1 ? ", BC1" : ", RGB8";
+			std::string cachePath = TextureCache::getCachePath(name, format);
+			std::remove(cachePath.c_str());
+			CachedTexture texture = TextureCache::load(name, format);
+			if (!texture.converted || texture.levels.size() != 11) {
+				printf("  FAILED: the first load%s was not converted into 11 levels\n", suffix.c_str());
+				passed = false;
+			}
+
+			texture = TextureCache::load(name, format);
+			if (texture.converted) {
+				printf("  FAILED: the cache%s was not used\n", suffix.c_str());
+				passed = false;
+			}
+			texture = CachedTexture();
+
+			// Another image under the same name must not be served from the old cache
+			copyFile("textures/tile.png", "textures/" + name);
+			texture = TextureCache::load(name, format);
+			if (!texture.converted || texture.levels[0].width != 64) {
+				printf("  FAILED: the cache%s was used after the PNG changed\n", suffix.c_str());
+				passed = false;
+			}
+			texture = CachedTexture();
+			copyFile("textures/perlin.png", "textures/" + name);
+			std::remove(cachePath.c_str());
+		}
+		std::remove(("textures/" + name).c_str());
+		return passed;
+	}
+}
+
+// Textures are loaded from the textures directory relative to the working directory, as in the game
+bool runTextureLoaderTests() {
+	bool passed = true;
+
+	for (const char* name : {"tile.png", "perlin.png", "circle.png"}) {
+		TextureData texture(0, 0);
+		try {
+			texture = TextureLoader::loadTexture(name);
+		} catch (const std::runtime_error& e) {
+			printf("  Skipping %s: %s\n", name, e.what());
+			continue;
+		}
+
+		// Both layouts are tightly packed and hold the same colors
+		TextureData withAlpha = TextureLoader::loadTexture(name, 4);
+		std::size_t pixels = static_cast<std::size_t>(texture.width) * texture.height;
+		bool sameColors = texture.data.size() == texture.getRowSize() * texture.height
+			&& withAlpha.data.size() == withAlpha.getRowSize() * withAlpha.height && withAlpha.width == texture.width;
+		for (std::size_t i = 0; sameColors && i < pixels; ++i) {
+			for (int channel = 0; channel < 3; ++channel) {
+				sameColors = sameColors && texture.data[i * 3 + channel] == withAlpha.data[i * 4 + channel];
+			}
+		}
+		if (!sameColors) {
+			printf("  FAILED: the RGB8 and RGBA8 decodes of %s differ\n", name);
+			passed = false;
+		}
+	}
+
+	try {
+		TextureData perlin = TextureLoader::loadTexture("perlin.png");
+		std::vector<TextureData> mipChain = TextureConversion::buildMipChain(perlin);
+		std::vector<unsigned char> blocks = TextureConversion::encodeBc1(perlin);
+		double error = getMeanError(perlin, TextureConversion::decodeBc1(blocks, perlin.width, perlin.height));
+		if (error > 2.0 || mipChain.back().width != 1 || mipChain.back().height != 1) {
+			printf("  FAILED: perlin.png was not converted faithfully, with a BC1 mean error of %.3f of 255\n", error);
+			passed = false;
+		}
+		passed = runTextureCacheTests() && passed;
+	} catch (const std::runtime_error& e) {
+		printf("  Skipping conversion: %s\n", e.what());
+	}
+
+	// A missing file is reported as an exception
+	try {
+		TextureLoader::loadTexture("missing.png");
+		printf("  FAILED: loading a missing texture did not throw\n");
+		passed = false;
+	} catch (const std::runtime_error&) {
+	}
+	return passed;
+}
@@ -0,0 +1,79 @@
+/*
+	Copyright 2021 Patrick Owen
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unsupported/Eigen/MatrixFunctions>
+#include <Eigen/SVD>
+#include "Tests.h"
+#include "../VectorMath.h"
+
+namespace {
+	const std::size_t batchSize = 1000;
+	const double tolerance = 1e-10;
+
+	// The implementations svdUnitary replaced, kept as the reference for accuracy
+	Matrix4d referenceHyperbolicSvdUnitary(const Matrix4d& matrix) {
+		return matrix * (VectorMath::hyperbolicTranspose(matrix) * matrix).sqrt().inverse();
+	}
+
+	Matrix4d referenceSphericalSvdUnitary(const Matrix4d& matrix) {
+		Eigen::JacobiSVD<Matrix4d> svd(matrix, Eigen::ComputeFullU | Eigen::ComputeFullV);
+		return svd.matrixU() * svd.matrixV().adjoint();
+	}
+
+	template<typename Space>
+	Matrix4d randomIsometry(std::mt19937& random) {
+		std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+		Vector3d axis(distribution(random), distribution(random), distribution(random));
+		Vector4d displacement(distribution(random), distribution(random), distribution(random), 0);
+		return Space::displacement(displacement) * VectorMath::rotation(axis.normalized(), distribution(random) * M_TAU);
+	}
+
+	// Whether svdUnitary is within tolerance of the reference and of being an isometry, for matrices with accumulated
+	// rounding error, as renormalization sees them, and for GhostCamera's go-home step at 60 frames per second
+	template<typename Space, typename F>
+	bool runForGeometry(const std::string& geometryName, F&& reference) {
+		std::mt19937 random(1);
+		std::normal_distribution<double> noise(0.0, 1e-3);
+		double maxDifference = 0, maxIsometryError = 0;
+		for (std::size_t i = 0; i < batchSize; ++i) {
+			Matrix4d drifted = randomIsometry<Space>(random) + Matrix4d::NullaryExpr([&]() { return noise(random); });
+			Matrix4d goingHome = randomIsometry<Space>(random) + Matrix4d::Identity() / 60.0;
+			for (const Matrix4d& input : {drifted, goingHome}) {
+				Matrix4d result = Space::svdUnitary(input);
+				maxDifference = std::max(maxDifference, (result - reference(input)).cwiseAbs().maxCoeff());
+				maxIsometryError = std::max(maxIsometryError, (Space::transpose(result) * result - Matrix4d::Identity()).cwiseAbs().maxCoeff());
+			}
+		}
+
+		if (maxDifference > tolerance || maxIsometryError > tolerance) {
+			printf("  FAILED: %s svdUnitary is %g from the reference and %g from an isometry\n", geometryName.c_str(),
+				maxDifference, maxIsometryError);
+			return false;
+		}
+		return true;
+	}
+}
+
+bool runVectorMathPolarTests() {
+	bool passed = runForGeometry<HyperbolicGeometry>("hyperbolic", referenceHyperbolicSvdUnitary);
+	passed = runForGeometry<SphericalGeometry>("spherical", referenceSphericalSvdUnitary) && passed;
+	return passed;
+}